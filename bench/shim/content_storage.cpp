@@ -0,0 +1,99 @@
+#include "nx/ncm.hpp"
+#include <stdio.h>
+#include <filesystem>
+#include "util/error.hpp"
+
+namespace nx::ncm
+{
+	namespace
+	{
+		const char hexDigits[] = "0123456789abcdef";
+	}
+
+	ContentStorage::ContentStorage(NcmStorageId storageId) : m_directory("ncm/" + std::to_string(storageId))
+	{
+		std::filesystem::create_directories(m_directory);
+	}
+
+	std::string ContentStorage::path(const NcmPlaceHolderId& placeholderId) const
+	{
+		std::string name;
+		for (u8 byte : placeholderId.uuid)
+		{
+			name += hexDigits[byte >> 4];
+			name += hexDigits[byte & 0xF];
+		}
+		return m_directory + "/" + name;
+	}
+
+	void ContentStorage::CreatePlaceholder(const NcmContentId& placeholderId, const NcmPlaceHolderId& registeredId, size_t size)
+	{
+		// NcaWriter passes the content id as both ids, name it after the one WritePlaceholder gets
+		std::string file = path(registeredId);
+		if (std::filesystem::exists(file))
+			THROW_FORMAT("Placeholder %s already exists\n", file.c_str());
+
+		FILE* created = fopen(file.c_str(), "wb");
+		if (created == NULL)
+			THROW_FORMAT("Failed to create placeholder %s\n", file.c_str());
+		fclose(created);
+		std::filesystem::resize_file(file, size);
+	}
+
+	void ContentStorage::DeletePlaceholder(const NcmPlaceHolderId& placeholderId)
+	{
+		if (!std::filesystem::remove(path(placeholderId)))
+			THROW_FORMAT("Placeholder %s doesn't exist\n", path(placeholderId).c_str());
+	}
+
+	void ContentStorage::WritePlaceholder(const NcmPlaceHolderId& placeholderId, u64 offset, void* buffer, size_t bufSize)
+	{
+		std::string file = path(placeholderId);
+		if (offset + bufSize > (u64)GetPlaceholderSize(placeholderId))
+			THROW_FORMAT("Write past the end of placeholder %s\n", file.c_str());
+
+		FILE* placeholder = fopen(file.c_str(), "r+b");
+		bool written = placeholder && fseek(placeholder, offset, SEEK_SET) == 0 && fwrite(buffer, 1, bufSize, placeholder) == bufSize;
+		if (placeholder)
+			written = fclose(placeholder) == 0 && written;
+		if (!written)
+			THROW_FORMAT("Failed to write placeholder %s\n", file.c_str());
+	}
+
+	void ContentStorage::ReadPlaceholder(const NcmPlaceHolderId& placeholderId, u64 offset, void* buffer, size_t bufSize)
+	{
+		std::string file = path(placeholderId);
+		FILE* placeholder = fopen(file.c_str(), "rb");
+		bool read = placeholder && fseek(placeholder, offset, SEEK_SET) == 0 && fread(buffer, 1, bufSize, placeholder) == bufSize;
+		if (placeholder)
+			fclose(placeholder);
+		if (!read)
+			THROW_FORMAT("Failed to read placeholder %s\n", file.c_str());
+	}
+
+	std::vector<NcmPlaceHolderId> ContentStorage::ListPlaceholders()
+	{
+		std::vector<NcmPlaceHolderId> placeholders;
+		for (auto& entry : std::filesystem::directory_iterator(m_directory))
+		{
+			std::string name = entry.path().filename().string();
+			if (name.size() != sizeof(NcmPlaceHolderId) * 2)
+				continue;
+
+			NcmPlaceHolderId placeholderId;
+			for (size_t i = 0; i < sizeof(placeholderId.uuid); i++)
+				placeholderId.uuid[i] = (u8)std::stoul(name.substr(i * 2, 2), nullptr, 16);
+			placeholders.push_back(placeholderId);
+		}
+		return placeholders;
+	}
+
+	s64 ContentStorage::GetPlaceholderSize(const NcmPlaceHolderId& placeholderId)
+	{
+		std::error_code ec;
+		u64 size = std::filesystem::file_size(path(placeholderId), ec);
+		if (ec)
+			THROW_FORMAT("Placeholder %s doesn't exist\n", path(placeholderId).c_str());
+		return (s64)size;
+	}
+}
@@ -0,0 +1,214 @@
+#include <switch.h>
+#include <string.h>
+#include <time.h>
+#include <memory>
+#include <string>
+#include <openssl/evp.h>
+#include <openssl/sha.h>
+#include "util/title_util.hpp"
+
+namespace
+{
+	// Stands in for the console's master key, the spl calls derive everything from it
+	const u8 benchMasterKey[0x10] = { 0x62, 0x65, 0x6E, 0x63, 0x68, 0x2D, 0x6D, 0x61, 0x73, 0x74, 0x65, 0x72, 0x2D, 0x6B, 0x65, 0x79 };
+
+	// One cipher context per thread, set up again with the key of every call so the libnx contexts
+	// can stay plain structs that never need freeing
+	EVP_CIPHER_CTX* cipherContext()
+	{
+		thread_local std::unique_ptr<EVP_CIPHER_CTX, decltype(&EVP_CIPHER_CTX_free)> ctx(EVP_CIPHER_CTX_new(), EVP_CIPHER_CTX_free);
+		return ctx.get();
+	}
+
+	void crypt(const EVP_CIPHER* cipher, bool encrypt, const u8* key, const u8* iv, void* dst, const void* src, size_t size)
+	{
+		EVP_CIPHER_CTX* ctx = cipherContext();
+		int outSize = 0;
+		EVP_CipherInit_ex(ctx, cipher, NULL, key, iv, encrypt);
+		EVP_CIPHER_CTX_set_padding(ctx, 0);
+		EVP_CipherUpdate(ctx, (u8*)dst, &outSize, (const u8*)src, (int)size);
+	}
+
+	void aesEcbEncrypt(const u8* key, const void* src, void* dst)
+	{
+		crypt(EVP_aes_128_ecb(), true, key, NULL, dst, src, 0x10);
+	}
+
+	// The counter is a 128-bit big-endian number
+	void addCounter(u8* ctr, u64 blocks)
+	{
+		for (int i = 0xF; i >= 0 && blocks; i--)
+		{
+			u64 sum = ctr[i] + (blocks & 0xFF);
+			ctr[i] = (u8)sum;
+			blocks = (blocks >> 8) + (sum >> 8);
+		}
+	}
+}
+
+u64 armGetSystemTick(void)
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return armNsToTicks((u64)now.tv_sec * 1000000000ULL + now.tv_nsec);
+}
+
+u64 armTicksToNs(u64 tick)
+{
+	return (tick * 625) / 12;
+}
+
+u64 armNsToTicks(u64 ns)
+{
+	return (ns * 12) / 625;
+}
+
+Result svcGetInfo(u64* out, u32 id0, Handle handle, u64 id1)
+{
+	switch (id0)
+	{
+		case InfoType_CoreMask:
+			*out = 0b111;
+			return 0;
+		case InfoType_PriorityMask:
+			*out = 0xFFFFFFFF00000000ULL;
+			return 0;
+		default:
+			return MAKERESULT(1, 14);
+	}
+}
+
+Result svcSetThreadCoreMask(Handle handle, s32 preferred_core, u32 affinity_mask)
+{
+	return 0;
+}
+
+Result svcSetThreadPriority(Handle handle, u32 priority)
+{
+	return 0;
+}
+
+Result fsdevCommitDevice(const char* name)
+{
+	return 0;
+}
+
+Result ncmInitialize(void)
+{
+	return 0;
+}
+
+void ncmExit(void)
+{
+}
+
+u32 hosversionGet(void)
+{
+	return 0;
+}
+
+Result splCryptoGenerateAesKek(const void* wrapped_kek, u32 key_generation, u32 option, void* out_sealed_kek)
+{
+	u8 generationKey[0x10];
+	memcpy(generationKey, benchMasterKey, sizeof(generationKey));
+	generationKey[0xF] ^= (u8)key_generation;
+	aesEcbEncrypt(generationKey, wrapped_kek, out_sealed_kek);
+	return 0;
+}
+
+Result splCryptoGenerateAesKey(const void* sealed_kek, const void* wrapped_key, void* out_key)
+{
+	aesEcbEncrypt((const u8*)sealed_kek, wrapped_key, out_key);
+	return 0;
+}
+
+void aes128CtrContextCreate(Aes128CtrContext* out, const void* key, const void* ctr)
+{
+	memcpy(out->key, key, sizeof(out->key));
+	aes128CtrContextResetCtr(out, ctr);
+}
+
+void aes128CtrContextResetCtr(Aes128CtrContext* ctx, const void* ctr)
+{
+	memcpy(ctx->ctr, ctr, sizeof(ctx->ctr));
+	ctx->bufferOffset = sizeof(ctx->encCtrBuffer);
+}
+
+void aes128CtrCrypt(Aes128CtrContext* ctx, void* dst, const void* src, size_t size)
+{
+	u8* out = (u8*)dst;
+	const u8* in = (const u8*)src;
+
+	// Finish the block an earlier call stopped in
+	while (size && ctx->bufferOffset < sizeof(ctx->encCtrBuffer))
+	{
+		*out++ = *in++ ^ ctx->encCtrBuffer[ctx->bufferOffset++];
+		size--;
+	}
+
+	size_t blocks = size / 0x10;
+	if (blocks)
+	{
+		crypt(EVP_aes_128_ctr(), true, ctx->key, ctx->ctr, out, in, blocks * 0x10);
+		addCounter(ctx->ctr, blocks);
+		out += blocks * 0x10;
+		in += blocks * 0x10;
+		size -= blocks * 0x10;
+	}
+
+	if (size)
+	{
+		aesEcbEncrypt(ctx->key, ctx->ctr, ctx->encCtrBuffer);
+		addCounter(ctx->ctr, 1);
+		ctx->bufferOffset = 0;
+
+		while (size--)
+			*out++ = *in++ ^ ctx->encCtrBuffer[ctx->bufferOffset++];
+	}
+}
+
+void aes128XtsContextCreate(Aes128XtsContext* out, const void* key0, const void* key1, bool is_encryptor)
+{
+	memcpy(out->keys, key0, 0x10);
+	memcpy(out->keys + 0x10, key1, 0x10);
+	memset(out->tweak, 0, sizeof(out->tweak));
+	out->isEncryptor = is_encryptor;
+}
+
+void aes128XtsContextResetSector(Aes128XtsContext* ctx, u64 sector, bool is_nintendo)
+{
+	memset(ctx->tweak, 0, sizeof(ctx->tweak));
+
+	// Nintendo's tweak is the sector number in big-endian, standard XTS has it little-endian
+	for (int i = 0; i < 8; i++)
+		ctx->tweak[is_nintendo ? 0xF - i : i] = (u8)(sector >> (i * 8));
+}
+
+size_t aes128XtsEncrypt(Aes128XtsContext* ctx, void* dst, const void* src, size_t size)
+{
+	crypt(EVP_aes_128_xts(), true, ctx->keys, ctx->tweak, dst, src, size);
+	return size;
+}
+
+size_t aes128XtsDecrypt(Aes128XtsContext* ctx, void* dst, const void* src, size_t size)
+{
+	crypt(EVP_aes_128_xts(), false, ctx->keys, ctx->tweak, dst, src, size);
+	return size;
+}
+
+void sha256CalculateHash(void* dst, const void* src, size_t size)
+{
+	SHA256((const u8*)src, size, (u8*)dst);
+}
+
+namespace tin::util
+{
+	std::string GetNcaIdString(const NcmContentId& ncaId)
+	{
+		char ncaIdStr[FS_MAX_PATH] = { 0 };
+		u64 ncaIdLower = __builtin_bswap64(*(u64*)ncaId.c);
+		u64 ncaIdUpper = __builtin_bswap64(*(u64*)(ncaId.c + 0x8));
+		snprintf(ncaIdStr, FS_MAX_PATH, "%016lx%016lx", ncaIdLower, ncaIdUpper);
+		return std::string(ncaIdStr);
+	}
+}
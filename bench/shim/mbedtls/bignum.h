@@ -0,0 +1,43 @@
+#pragma once
+
+// The handful of mbedtls bignum calls Crypto::rsa2048PssVerify makes, on top of OpenSSL's BIGNUM
+#include <openssl/bn.h>
+
+typedef struct {
+	BIGNUM* bn;
+} mbedtls_mpi;
+
+static inline void mbedtls_mpi_init(mbedtls_mpi* x)
+{
+	x->bn = BN_new();
+}
+
+static inline void mbedtls_mpi_free(mbedtls_mpi* x)
+{
+	BN_free(x->bn);
+	x->bn = NULL;
+}
+
+static inline int mbedtls_mpi_lset(mbedtls_mpi* x, long z)
+{
+	// Only ever called with sizes
+	return BN_set_word(x->bn, (BN_ULONG)z) ? 0 : -1;
+}
+
+static inline int mbedtls_mpi_read_binary(mbedtls_mpi* x, const unsigned char* buf, size_t buflen)
+{
+	return BN_bin2bn(buf, (int)buflen, x->bn) ? 0 : -1;
+}
+
+static inline int mbedtls_mpi_write_binary(const mbedtls_mpi* x, unsigned char* buf, size_t buflen)
+{
+	return BN_bn2binpad(x->bn, buf, (int)buflen) == (int)buflen ? 0 : -1;
+}
+
+static inline int mbedtls_mpi_exp_mod(mbedtls_mpi* x, const mbedtls_mpi* a, const mbedtls_mpi* e, const mbedtls_mpi* n, mbedtls_mpi* _rr)
+{
+	BN_CTX* ctx = BN_CTX_new();
+	int ok = ctx && BN_mod_exp(x->bn, a->bn, e->bn, n->bn, ctx);
+	BN_CTX_free(ctx);
+	return ok ? 0 : -1;
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+// Stands in for the NCM wrapper. The benchmarks install into the sinks that don't need NCM, ContentStorage
+// is only here for the placeholder collector and the checks around it.
+#include <string>
+#include <vector>
+#include "nx/content_sink.hpp"
+
+namespace nx::ncm
+{
+	// Placeholders are files in ncm/<storage id>/ under the working directory, so like on the console
+	// they outlive the process that created them
+	class ContentStorage final : public ContentSink
+	{
+	private:
+		std::string m_directory;
+
+		std::string path(const NcmPlaceHolderId& placeholderId) const;
+
+	public:
+		ContentStorage(NcmStorageId storageId);
+
+		void CreatePlaceholder(const NcmContentId& placeholderId, const NcmPlaceHolderId& registeredId, size_t size) override;
+		void DeletePlaceholder(const NcmPlaceHolderId& placeholderId) override;
+		void WritePlaceholder(const NcmPlaceHolderId& placeholderId, u64 offset, void* buffer, size_t bufSize) override;
+		void ReadPlaceholder(const NcmPlaceHolderId& placeholderId, u64 offset, void* buffer, size_t bufSize) override;
+		bool IsPersistent() const override { return true; }
+		std::vector<NcmPlaceHolderId> ListPlaceholders();
+		s64 GetPlaceholderSize(const NcmPlaceHolderId& placeholderId);
+	};
+}
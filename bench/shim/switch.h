@@ -0,0 +1,113 @@
+#pragma once
+
+// The parts of libnx the NCA writer, the buffered placeholder writer and the PFS0/HFS0 parsers use,
+// reimplemented for Linux. Crypto goes through OpenSSL, the system key derivation is replaced by
+// fixed bench keys, so everything these produce is only meaningful to the bench itself.
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef uint8_t u8;
+typedef uint16_t u16;
+typedef uint32_t u32;
+typedef uint64_t u64;
+typedef int8_t s8;
+typedef int16_t s16;
+typedef int32_t s32;
+typedef int64_t s64;
+typedef u32 Result;
+typedef u32 Handle;
+
+#define PACKED __attribute__((packed))
+#define NX_PACKED __attribute__((packed))
+#define NX_INLINE __attribute__((always_inline)) static inline
+#define BIT(n) (1U<<(n))
+
+#define R_SUCCEEDED(res) ((res)==0)
+#define R_FAILED(res) ((res)!=0)
+#define MAKERESULT(module,description) ((((module)&0x1FF)) | ((description)&0x1FFF)<<9)
+
+#define FS_MAX_PATH 0x301
+
+#define CUR_PROCESS_HANDLE 0xFFFF8001
+#define CUR_THREAD_HANDLE 0xFFFF8000
+
+typedef enum {
+	InfoType_CoreMask = 0,
+	InfoType_PriorityMask = 1,
+} InfoType;
+
+typedef struct {
+	u8 c[0x10];
+} NcmContentId;
+
+typedef struct {
+	u8 uuid[0x10];
+} NcmPlaceHolderId;
+
+typedef enum {
+	NcmStorageId_None = 0,
+	NcmStorageId_Host = 1,
+	NcmStorageId_GameCard = 2,
+	NcmStorageId_BuiltInSystem = 3,
+	NcmStorageId_BuiltInUser = 4,
+	NcmStorageId_SdCard = 5,
+	NcmStorageId_Any = 6,
+} NcmStorageId;
+
+// Ticks run at the console's 19.2MHz so telemetry arithmetic matches the real thing
+u64 armGetSystemTick(void);
+u64 armTicksToNs(u64 tick);
+u64 armNsToTicks(u64 ns);
+
+// Every core and priority is allowed, but the host threads are left where they are
+Result svcGetInfo(u64* out, u32 id0, Handle handle, u64 id1);
+Result svcSetThreadCoreMask(Handle handle, s32 preferred_core, u32 affinity_mask);
+Result svcSetThreadPriority(Handle handle, u32 priority);
+
+Result fsdevCommitDevice(const char* name);
+
+// NCM needs no session, the shim's ContentStorage works on files
+Result ncmInitialize(void);
+void ncmExit(void);
+
+#define HOSVER_MAJOR(_version) (((_version) >> 16) & 0xFF)
+#define HOSVER_MINOR(_version) (((_version) >> 8) & 0xFF)
+#define HOSVER_MICRO(_version) ((_version) & 0xFF)
+u32 hosversionGet(void);
+
+Result splCryptoGenerateAesKek(const void* wrapped_kek, u32 key_generation, u32 option, void* out_sealed_kek);
+Result splCryptoGenerateAesKey(const void* sealed_kek, const void* wrapped_key, void* out_key);
+
+typedef struct {
+	u8 key[0x10];
+	u8 ctr[0x10];
+	u8 encCtrBuffer[0x10];
+	size_t bufferOffset;
+} Aes128CtrContext;
+
+void aes128CtrContextCreate(Aes128CtrContext* out, const void* key, const void* ctr);
+void aes128CtrContextResetCtr(Aes128CtrContext* ctx, const void* ctr);
+void aes128CtrCrypt(Aes128CtrContext* ctx, void* dst, const void* src, size_t size);
+
+typedef struct {
+	u8 keys[0x20];
+	u8 tweak[0x10];
+	bool isEncryptor;
+} Aes128XtsContext;
+
+void aes128XtsContextCreate(Aes128XtsContext* out, const void* key0, const void* key1, bool is_encryptor);
+void aes128XtsContextResetSector(Aes128XtsContext* ctx, u64 sector, bool is_nintendo);
+size_t aes128XtsEncrypt(Aes128XtsContext* ctx, void* dst, const void* src, size_t size);
+size_t aes128XtsDecrypt(Aes128XtsContext* ctx, void* dst, const void* src, size_t size);
+
+void sha256CalculateHash(void* dst, const void* src, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,10 @@
+#pragma once
+
+// Stands in for the title helpers, the parsers and the NCA writer only need the NCA id strings
+#include <switch/types.h>
+#include <string>
+
+namespace tin::util
+{
+	std::string GetNcaIdString(const NcmContentId& ncaId);
+}
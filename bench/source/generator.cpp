@@ -0,0 +1,209 @@
+#include "generator.hpp"
+
+#include <string.h>
+#include <zstd.h>
+#include <stdexcept>
+#include "install/hfs0.hpp"
+#include "install/nca.hpp"
+#include "install/pfs0.hpp"
+#include "util/crypto.hpp"
+
+namespace bench
+{
+	namespace
+	{
+		const u64 NCZ_MAGIC = 0x4E544345535A434E; // NCZSECTN
+		const u32 MAGIC_PFS0 = 0x30534650;
+
+		// Same layout as the sections NczBodyWriter reads
+		struct NczSection
+		{
+			u64 offset;
+			u64 size;
+			u8 cryptoType;
+			u8 padding1[7];
+			u64 padding2;
+			u8 cryptoKey[0x10];
+			u8 cryptoCounter[0x10];
+		} PACKED;
+
+		class Random
+		{
+		public:
+			Random(u32 seed) : m_state(0x9E3779B97F4A7C15ULL ^ seed) {}
+
+			u64 next()
+			{
+				m_state ^= m_state << 13;
+				m_state ^= m_state >> 7;
+				m_state ^= m_state << 17;
+				return m_state;
+			}
+
+			void fill(u8* data, u64 size)
+			{
+				for (u64 i = 0; i < size; i += 8)
+				{
+					u64 value = next();
+					memcpy(data + i, &value, std::min<u64>(8, size - i));
+				}
+			}
+
+		private:
+			u64 m_state;
+		};
+
+		void append(std::vector<u8>& buffer, const void* ptr, u64 size)
+		{
+			u64 offset = buffer.size();
+			buffer.resize(offset + size);
+			memcpy(buffer.data() + offset, ptr, size);
+		}
+
+		void encryptHeader(u8* dst, tin::install::NcaHeader header, u8 distribution)
+		{
+			header.distribution = distribution;
+			Crypto::HeaderXtsLease encryptor(true);
+			encryptor->encrypt(dst, &header, sizeof(header), 0, 0x200);
+		}
+
+		// Both partition formats are a base header, an entry per file and a string table, padded so the
+		// file data starts aligned
+		template<class Entry>
+		std::vector<u8> buildPartition(u32 magic, const std::vector<PackedFile>& files, u64 alignment)
+		{
+			std::vector<Entry> entries(files.size());
+			std::string strings;
+			u64 dataOffset = 0;
+
+			for (size_t i = 0; i < files.size(); i++)
+			{
+				memset(&entries[i], 0, sizeof(Entry));
+				entries[i].dataOffset = dataOffset;
+				entries[i].fileSize = files[i].size;
+				entries[i].stringTableOffset = strings.size();
+				strings += files[i].name;
+				strings.push_back('\0');
+				dataOffset += files[i].size;
+			}
+
+			u64 headerSize = sizeof(tin::install::PFS0BaseHeader) + entries.size() * sizeof(Entry) + strings.size();
+			strings.resize(strings.size() + (alignment - headerSize % alignment) % alignment, '\0');
+
+			tin::install::PFS0BaseHeader header = { magic, (u32)files.size(), (u32)strings.size(), 0 };
+			std::vector<u8> partition;
+			partition.reserve(headerSize + dataOffset + alignment);
+			append(partition, &header, sizeof(header));
+			append(partition, entries.data(), entries.size() * sizeof(Entry));
+			append(partition, strings.data(), strings.size());
+
+			for (auto& file : files)
+				append(partition, file.data, file.size);
+
+			return partition;
+		}
+	}
+
+	SyntheticNca GenerateNca(u64 size, u32 seed)
+	{
+		Random random(seed);
+		size = std::max<u64>((size + 0x1FF) & ~0x1FFULL, NCA_HEADER_SIZE + 0x200);
+
+		SyntheticNca nca;
+		random.fill(nca.id.c, sizeof(nca.id.c));
+
+		NczSection section;
+		memset(&section, 0, sizeof(section));
+		section.offset = NCA_HEADER_SIZE;
+		section.size = size - NCA_HEADER_SIZE;
+		section.cryptoType = 3;
+		random.fill(section.cryptoKey, sizeof(section.cryptoKey));
+		random.fill(section.cryptoCounter, 8);
+
+		tin::install::NcaHeader header;
+		memset(&header, 0, sizeof(header));
+		header.magic = MAGIC_NCA3;
+		header.nca_size = size;
+		header.m_titleId = 0x0100000000010000ULL | (seed & 0xFFFF) << 16;
+		header.section_entries[0].media_start_offset = section.offset / 0x200;
+		header.section_entries[0].media_end_offset = size / 0x200;
+		header.fs_headers[0].crypt_type = section.cryptoType;
+		memcpy(&header.fs_headers[0].section_ctr, section.cryptoCounter, 8);
+
+		// Half of every page is noise and half a repeated pattern, which zstd packs to about 50%
+		std::vector<u8> body(section.size);
+		for (u64 page = 0; page < body.size(); page += 0x1000)
+		{
+			u64 pageSize = std::min<u64>(0x1000, body.size() - page);
+			u64 noise = std::min<u64>(0x800, pageSize);
+			random.fill(body.data() + page, noise);
+			memset(body.data() + page + noise, (u8)(page >> 12), pageSize - noise);
+		}
+
+		nca.ncz.resize(NCA_HEADER_SIZE);
+		encryptHeader(nca.ncz.data(), header, 1);
+		u64 nczHeader[2] = { NCZ_MAGIC, 1 };
+		append(nca.ncz, nczHeader, sizeof(nczHeader));
+		append(nca.ncz, &section, sizeof(section));
+
+		u64 compressedOffset = nca.ncz.size();
+		nca.ncz.resize(compressedOffset + ZSTD_compressBound(body.size()));
+		size_t compressedSize = ZSTD_compress(nca.ncz.data() + compressedOffset, nca.ncz.size() - compressedOffset, body.data(), body.size(), 3);
+		if (ZSTD_isError(compressedSize))
+			throw std::runtime_error(ZSTD_getErrorName(compressedSize));
+		nca.ncz.resize(compressedOffset + compressedSize);
+		nca.ncz.shrink_to_fit();
+
+		Crypto::Aes128Ctr crypto(section.cryptoKey, Crypto::AesCtr(Crypto::swapEndian(((u64*)section.cryptoCounter)[0])));
+		crypto.seek(section.offset);
+		crypto.encrypt(body.data(), body.data(), body.size());
+
+		nca.nca.resize(NCA_HEADER_SIZE);
+		memcpy(nca.nca.data(), nca.ncz.data(), NCA_HEADER_SIZE);
+		append(nca.nca, body.data(), body.size());
+		body = std::vector<u8>();
+
+		nca.installed = nca.nca;
+		encryptHeader(nca.installed.data(), header, 0);
+		return nca;
+	}
+
+	std::vector<u8> BuildNsp(const std::vector<PackedFile>& files)
+	{
+		return buildPartition<tin::install::PFS0FileEntry>(MAGIC_PFS0, files, 0x20);
+	}
+
+	std::vector<u8> BuildXci(const std::vector<PackedFile>& files)
+	{
+		std::vector<u8> secure = buildPartition<tin::install::HFS0FileEntry>(MAGIC_HFS0, files, 0x200);
+		std::vector<u8> empty = buildPartition<tin::install::HFS0FileEntry>(MAGIC_HFS0, {}, 0x200);
+		std::vector<u8> root = buildPartition<tin::install::HFS0FileEntry>(MAGIC_HFS0, {
+			{ "update", empty.data(), empty.size() },
+			{ "normal", empty.data(), empty.size() },
+			{ "secure", secure.data(), secure.size() },
+		}, 0x200);
+
+		// The card header and certificate area the parser skips over
+		std::vector<u8> xci(0xF000, 0);
+		memcpy(xci.data() + 0x100, "HEAD", 4);
+		append(xci, root.data(), root.size());
+		return xci;
+	}
+
+	std::vector<std::pair<std::string, std::vector<u8>>> GenerateFiller(u32 count, u32 seed)
+	{
+		Random random(seed);
+		std::vector<std::pair<std::string, std::vector<u8>>> files;
+
+		for (u32 i = 0; i < count; i++)
+		{
+			char name[0x40];
+			snprintf(name, sizeof(name), "%016lx%016lx.nca", random.next(), random.next());
+			std::vector<u8> data(0x200 + random.next() % 0x200);
+			random.fill(data.data(), data.size());
+			files.emplace_back(name, std::move(data));
+		}
+
+		return files;
+	}
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <switch.h>
+
+// Synthetic content for the host benchmarks. Headers are encrypted with the bench keys the libnx shim
+// derives, so NcaWriter accepts them, but nothing here would install on a console.
+namespace bench
+{
+	struct SyntheticNca
+	{
+		NcmContentId id;
+		// As stored in an NSP, the header still says it's from a gamecard
+		std::vector<u8> nca;
+		// The same NCA compressed the way nsz does it
+		std::vector<u8> ncz;
+		// What a correct install leaves in the placeholder
+		std::vector<u8> installed;
+	};
+
+	// A content NCA of size bytes, rounded up to a whole sector, with one AES-CTR section after the
+	// header. The body compresses to about half, like typical game data.
+	SyntheticNca GenerateNca(u64 size, u32 seed);
+
+	struct PackedFile
+	{
+		std::string name;
+		const u8* data;
+		u64 size;
+	};
+
+	// PFS0 as found in an NSP/NSZ
+	std::vector<u8> BuildNsp(const std::vector<PackedFile>& files);
+	// XCI/XCZ with empty update and normal partitions and the files in the secure partition
+	std::vector<u8> BuildXci(const std::vector<PackedFile>& files);
+
+	// Small files with names but no meaning, so header parsing has something to chew on
+	std::vector<std::pair<std::string, std::vector<u8>>> GenerateFiller(u32 count, u32 seed);
+}
@@ -0,0 +1,893 @@
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <string.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+#include "generator.hpp"
+#include "data/buffered_placeholder_writer.hpp"
+#include "install/nsp.hpp"
+#include "install/xci.hpp"
+#include "nx/content_sink.hpp"
+#include "nx/nca_writer.h"
+#include "util/config.hpp"
+#include "util/crypto.hpp"
+#include "util/error.hpp"
+#include "util/journal.hpp"
+#include "util/placeholder_gc.hpp"
+#include "util/threads.hpp"
+#include "util/title_util.hpp"
+
+// Host benchmarks and checks for the NCA install path: NcaWriter, NczBodyWriter, the threads around
+// BufferedPlaceholderWriter and the PFS0/HFS0 parsers, fed with synthetic NSP/NSZ/XCI content.
+
+namespace
+{
+	// Everything that goes through operator new, zstd and the segment buffers' malloc aren't counted
+	std::atomic<u64> g_allocations = 0;
+	std::atomic<u64> g_allocatedBytes = 0;
+}
+
+// The replacements pair malloc and free themselves, GCC can't see that
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+
+void* operator new(size_t size)
+{
+	g_allocations.fetch_add(1, std::memory_order_relaxed);
+	g_allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+	if (void* ptr = malloc(size ? size : 1))
+		return ptr;
+	throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept
+{
+	free(ptr);
+}
+
+void operator delete(void* ptr, size_t size) noexcept
+{
+	free(ptr);
+}
+
+namespace
+{
+	const u64 MB = 0x100000;
+
+	struct Options
+	{
+		u64 size = 0; // 256MB for benchmarks, 16MB for checks
+		int segments = 4;
+		u64 receiveSize = MB;
+	};
+
+	struct Measurement
+	{
+		double amount;
+		const char* unit;
+		double seconds;
+	};
+
+	// Stands in for the SD card source: the whole container is in memory and NCAs are streamed out of
+	// it in the 8MB pieces SDMCNSP uses
+	const u64 SOURCE_CHUNK_SIZE = 0x800000;
+
+	void streamNca(const u8* data, u64 size, const std::shared_ptr<nx::ncm::ContentSink>& sink, NcmContentId id, u64 chunkSize = SOURCE_CHUNK_SIZE)
+	{
+		NcaWriter writer(id, sink);
+
+		for (u64 offset = 0; offset < size; offset += chunkSize)
+			writer.write(data + offset, std::min(chunkSize, size - offset));
+
+		writer.close();
+	}
+
+	class MemoryNSP : public tin::install::nsp::NSP
+	{
+	private:
+		const std::vector<u8>& m_data;
+
+	public:
+		MemoryNSP(const std::vector<u8>& data) : m_data(data) {}
+
+		void StreamToPlaceholder(const std::shared_ptr<nx::ncm::ContentSink>& contentStorage, NcmContentId placeholderId) override
+		{
+			const tin::install::PFS0FileEntry* fileEntry = this->GetFileEntryByNcaId(placeholderId);
+			if (fileEntry == nullptr)
+				THROW_FORMAT("NCA not in the NSP\n");
+			streamNca(m_data.data() + this->GetDataOffset() + fileEntry->dataOffset, fileEntry->fileSize, contentStorage, placeholderId);
+		}
+
+		void BufferData(void* buf, off_t offset, size_t size) override
+		{
+			if ((u64)offset + size > m_data.size())
+				THROW_FORMAT("Read past the end of the NSP\n");
+			memcpy(buf, m_data.data() + offset, size);
+		}
+	};
+
+	class MemoryXCI : public tin::install::xci::XCI
+	{
+	private:
+		const std::vector<u8>& m_data;
+
+	public:
+		MemoryXCI(const std::vector<u8>& data) : m_data(data) {}
+
+		void StreamToPlaceholder(const std::shared_ptr<nx::ncm::ContentSink>& contentStorage, NcmContentId placeholderId) override
+		{
+			const tin::install::HFS0FileEntry* fileEntry = this->GetFileEntryByNcaId(placeholderId);
+			if (fileEntry == nullptr)
+				THROW_FORMAT("NCA not in the XCI\n");
+			streamNca(m_data.data() + this->GetDataOffset() + fileEntry->dataOffset, fileEntry->fileSize, contentStorage, placeholderId);
+		}
+
+		void BufferData(void* buf, off_t offset, size_t size) override
+		{
+			if ((u64)offset + size > m_data.size())
+				THROW_FORMAT("Read past the end of the XCI\n");
+			memcpy(buf, m_data.data() + offset, size);
+		}
+	};
+
+	// The receive and write threads of a USB or HTTP install, the receive side handing over receiveSize
+	// bytes at a time. With abortAt set the receive side gives up there, like a dropped connection.
+	void streamBuffered(const std::vector<u8>& source, const std::shared_ptr<nx::ncm::ContentSink>& sink, NcmContentId id, u64 receiveSize, u64 abortAt = 0)
+	{
+		tin::data::BufferedPlaceholderWriter writer(sink, id, source.size());
+		std::exception_ptr receiveError;
+		std::exception_ptr writeError;
+
+		std::thread receiveThread([&] {
+			inst::threads::Enter("bench-receive", inst::threads::Role::Receive);
+			try
+			{
+				for (u64 offset = 0; offset < source.size(); offset += receiveSize)
+				{
+					if (abortAt && offset >= abortAt)
+					{
+						writer.Abort();
+						return;
+					}
+
+					u64 chunk = std::min(receiveSize, source.size() - offset);
+					if (!writer.WaitToAppendData(chunk))
+						return;
+					writer.AppendData((void*)(source.data() + offset), chunk);
+				}
+			}
+			catch (...)
+			{
+				receiveError = std::current_exception();
+				writer.Abort();
+			}
+		});
+
+		std::thread writeThread([&] {
+			inst::threads::Enter("bench-write", inst::threads::Role::Write);
+			try
+			{
+				while (writer.WaitToWriteSegment())
+					writer.WriteSegmentToPlaceholder();
+			}
+			catch (...)
+			{
+				writeError = std::current_exception();
+				writer.Abort();
+			}
+		});
+
+		receiveThread.join();
+		writeThread.join();
+
+		if (receiveError)
+			std::rethrow_exception(receiveError);
+		if (writeError)
+			std::rethrow_exception(writeError);
+		if (!abortAt && !writer.IsPlaceholderComplete())
+			THROW_FORMAT("Buffered writer stopped at 0x%lx of 0x%lx\n", writer.GetSizeWrittenToPlaceholder(), source.size());
+	}
+
+	double secondsSince(std::chrono::steady_clock::time_point start)
+	{
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	// The content NCAs followed by the filler files
+	std::vector<bench::PackedFile> packFiles(const std::vector<std::pair<std::string, std::vector<u8>>>& filler, const std::vector<bench::PackedFile>& content)
+	{
+		std::vector<bench::PackedFile> files = content;
+		for (auto& [name, data] : filler)
+			files.push_back({ name, data.data(), data.size() });
+		return files;
+	}
+
+	struct Benchmark
+	{
+		const char* name;
+		const char* description;
+		// Builds the input, then returns what is timed
+		std::function<std::function<Measurement()>(const Options&)> prepare;
+	};
+
+	std::function<Measurement()> prepareWriter(const Options& options, bool compressed)
+	{
+		auto nca = std::make_shared<bench::SyntheticNca>(bench::GenerateNca(options.size, 1));
+		return [nca, compressed] {
+			auto sink = std::make_shared<nx::ncm::MemorySink>();
+			const std::vector<u8>& source = compressed ? nca->ncz : nca->nca;
+			auto start = std::chrono::steady_clock::now();
+			streamNca(source.data(), source.size(), sink, nca->id);
+			return Measurement{ nca->installed.size() / (double)MB, "MB", secondsSince(start) };
+		};
+	}
+
+	std::function<Measurement()> preparePipeline(const Options& options, bool compressed)
+	{
+		auto nca = std::make_shared<bench::SyntheticNca>(bench::GenerateNca(options.size, 1));
+		tin::data::NUM_BUFFER_SEGMENTS = options.segments;
+		u64 receiveSize = options.receiveSize;
+		return [nca, compressed, receiveSize] {
+			auto sink = std::make_shared<nx::ncm::MemorySink>();
+			auto start = std::chrono::steady_clock::now();
+			streamBuffered(compressed ? nca->ncz : nca->nca, sink, nca->id, receiveSize);
+			return Measurement{ nca->installed.size() / (double)MB, "MB", secondsSince(start) };
+		};
+	}
+
+	// Opening a container and finding each of its NCAs by id, the way an install looks them up
+	template<class Container>
+	u64 lookUpAll(const std::vector<u8>& data, const std::vector<NcmContentId>& ids)
+	{
+		Container container(data);
+		container.RetrieveHeader();
+
+		u64 found = 0;
+		for (auto& id : ids)
+			found += container.GetFileEntryByNcaId(id) != nullptr;
+		return found;
+	}
+
+	std::function<Measurement()> prepareParser(bool xci)
+	{
+		auto filler = std::make_shared<std::vector<std::pair<std::string, std::vector<u8>>>>(bench::GenerateFiller(1000, 2));
+		auto container = std::make_shared<std::vector<u8>>();
+		*container = xci ? bench::BuildXci(packFiles(*filler, {})) : bench::BuildNsp(packFiles(*filler, {}));
+
+		std::vector<NcmContentId> ids;
+		for (auto& file : *filler)
+		{
+			NcmContentId id;
+			for (size_t i = 0; i < sizeof(id.c); i++)
+				id.c[i] = (u8)std::stoul(file.first.substr(i * 2, 2), nullptr, 16);
+			ids.push_back(id);
+		}
+
+		return [filler, container, ids, xci] {
+			auto start = std::chrono::steady_clock::now();
+			u64 found = xci ? lookUpAll<MemoryXCI>(*container, ids) : lookUpAll<MemoryNSP>(*container, ids);
+
+			if (found != ids.size())
+				THROW_FORMAT("Only found %lu of %lu NCAs\n", found, ids.size());
+			return Measurement{ (double)found, "lookups", secondsSince(start) };
+		};
+	}
+
+	// Four sections after the header with a sector of gap behind each, the way an NCA lays them out.
+	// The third one isn't encrypted, so encrypt has to step over it.
+	std::vector<NczHeader::Section> ctrSections(u64 size, u32 seed)
+	{
+		std::vector<NczHeader::Section> sections;
+		u64 span = ((size - NCA_HEADER_SIZE) / 4) & ~0x1FFULL;
+
+		for (u64 i = 0; i < 4; i++)
+		{
+			NczHeader::Section section;
+			memset(&section, 0, sizeof(section));
+			section.offset = NCA_HEADER_SIZE + i * span;
+			section.size = span - 0x200;
+			section.cryptoType = i == 2 ? 1 : 3;
+			for (size_t j = 0; j < sizeof(section.cryptoKey); j++)
+				section.cryptoKey[j] = (u8)(seed * 0x9D + i * 0x3B + j);
+			for (size_t j = 0; j < 8; j++)
+				section.cryptoCounter[j] = (u8)(seed + i * 8 + j + 1);
+			sections.push_back(section);
+		}
+
+		return sections;
+	}
+
+	// An NczBodyWriter with nowhere to write, only its sections set up as if it had read the header
+	std::unique_ptr<NczBodyWriter> sectionWriter(const std::vector<NczHeader::Section>& sections)
+	{
+		auto writer = std::make_unique<NczBodyWriter>(NcmContentId{}, 0, nullptr);
+		for (auto& section : sections)
+			writer->sections.push_back(new NczHeader::SectionContext(section));
+		return writer;
+	}
+
+	// Section lookup and the running keystream, in 16MB slabs like processChunk hands them over
+	std::function<Measurement()> prepareCtr(const Options& options)
+	{
+		auto slab = std::make_shared<std::vector<u8>>(options.size, 0x5A);
+		auto sections = ctrSections(options.size, 6);
+		return [slab, sections] {
+			auto writer = sectionWriter(sections);
+			const u64 slabSize = 0x1000000;
+			auto start = std::chrono::steady_clock::now();
+			for (u64 offset = 0; offset < slab->size(); offset += slabSize)
+				writer->encrypt(slab->data() + offset, std::min(slabSize, slab->size() - offset), offset);
+			return Measurement{ slab->size() / (double)(1024 * MB), "GB", secondsSince(start) };
+		};
+	}
+
+	const std::vector<Benchmark> benchmarks = {
+		{ "nca", "NcaWriter, plain NCA in 8MB writes", [](const Options& o) { return prepareWriter(o, false); } },
+		{ "ncz", "NcaWriter, NCZ decompressed and re-encrypted", [](const Options& o) { return prepareWriter(o, true); } },
+		{ "ctr", "NczBodyWriter::encrypt over four sections in 16MB slabs", prepareCtr },
+		{ "pipeline-nca", "BufferedPlaceholderWriter threads, plain NCA", [](const Options& o) { return preparePipeline(o, false); } },
+		{ "pipeline-ncz", "BufferedPlaceholderWriter threads, NCZ", [](const Options& o) { return preparePipeline(o, true); } },
+		{ "nsp-parse", "PFS0 header of 1000 files, each looked up by id", [](const Options& o) { return prepareParser(false); } },
+		{ "xci-parse", "HFS0 headers of 1000 files, each looked up by id", [](const Options& o) { return prepareParser(true); } },
+	};
+
+	u64 readStatusKb(const char* field)
+	{
+		std::ifstream status("/proc/self/status");
+		std::string line;
+		while (std::getline(status, line))
+		{
+			if (line.rfind(field, 0) == 0)
+				return std::stoull(line.substr(strlen(field)));
+		}
+		return 0;
+	}
+
+	// Resets the kernel's peak RSS to the current RSS, so the peak measured afterwards leaves out the
+	// generated input. Returns the RSS it was reset to in kB.
+	u64 resetPeakRss()
+	{
+		std::ofstream clearRefs("/proc/self/clear_refs");
+		clearRefs << "5";
+		clearRefs.close();
+		return readStatusKb("VmRSS:");
+	}
+
+	int runBenchmark(const Benchmark& benchmark, const Options& options)
+	{
+		try
+		{
+			auto run = benchmark.prepare(options);
+			u64 baselineKb = resetPeakRss();
+			g_allocations = 0;
+			g_allocatedBytes = 0;
+
+			Measurement measurement = run();
+			u64 allocations = g_allocations;
+			u64 allocatedBytes = g_allocatedBytes;
+			u64 peakKb = readStatusKb("VmHWM:");
+
+			printf("%-14s %10.1f %-9s %10lu %10.1f %12.1f", benchmark.name, measurement.amount / measurement.seconds, (std::string(measurement.unit) + "/s").c_str(),
+				allocations, allocatedBytes / (double)MB, peakKb > baselineKb ? (peakKb - baselineKb) / 1024.0 : 0.0);
+			fflush(stdout);
+			return 0;
+		}
+		catch (std::exception& e)
+		{
+			fprintf(stderr, "%s failed: %s\n", benchmark.name, e.what());
+			return 1;
+		}
+	}
+
+	int runBenchmarks(const std::vector<const Benchmark*>& selected, const Options& options)
+	{
+		printf("%-14s %20s %10s %10s %12s %12s\n", "benchmark", "throughput", "allocs", "alloc MB", "RSS +MB", "peak RSS MB");
+		int failed = 0;
+
+		for (const Benchmark* benchmark : selected)
+		{
+			// Each benchmark gets a fresh process, so allocator state and peak RSS don't carry over
+			fflush(stdout);
+			pid_t pid = fork();
+			if (pid == 0)
+				_exit(runBenchmark(*benchmark, options));
+
+			int status = 0;
+			struct rusage usage;
+			if (pid < 0 || wait4(pid, &status, 0, &usage) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+			{
+				failed++;
+				continue;
+			}
+			printf(" %12.1f\n", usage.ru_maxrss / 1024.0);
+			fflush(stdout);
+		}
+
+		return failed ? 1 : 0;
+	}
+
+	// Checks that the fast paths produce exactly what the install is supposed to write
+
+	int g_failures = 0;
+
+	void check(const char* name, const std::function<void()>& test)
+	{
+		try
+		{
+			test();
+			printf("ok   %s\n", name);
+		}
+		catch (std::exception& e)
+		{
+			printf("FAIL %s: %s\n", name, e.what());
+			g_failures++;
+		}
+	}
+
+	// Hands writes on to a MemorySink with the write block size of the storage under test and keeps
+	// track of where they went. With failAt set the write after that many fails, like a full SD card.
+	class RecordingSink final : public nx::ncm::ContentSink
+	{
+	private:
+		nx::ncm::MemorySink m_memory;
+		u64 m_blockSize;
+		u64 m_failAt;
+
+	public:
+		std::vector<std::pair<u64, u64>> writes;
+		bool failed = false;
+		u64 writesAfterFailure = 0;
+
+		RecordingSink(u64 window, u64 blockSize, u64 failAt = 0) : m_memory(window), m_blockSize(blockSize), m_failAt(failAt) {}
+
+		void CreatePlaceholder(const NcmContentId& placeholderId, const NcmPlaceHolderId& registeredId, size_t size) override
+		{
+			m_memory.CreatePlaceholder(placeholderId, registeredId, size);
+		}
+
+		void DeletePlaceholder(const NcmPlaceHolderId& placeholderId) override
+		{
+			m_memory.DeletePlaceholder(placeholderId);
+		}
+
+		void WritePlaceholder(const NcmPlaceHolderId& placeholderId, u64 offset, void* buffer, size_t bufSize) override
+		{
+			if (failed)
+			{
+				writesAfterFailure++;
+				return;
+			}
+
+			if (m_failAt && writes.size() == m_failAt)
+			{
+				failed = true;
+				THROW_FORMAT("Simulated write failure\n");
+			}
+
+			writes.emplace_back(offset, bufSize);
+			m_memory.WritePlaceholder(placeholderId, offset, buffer, bufSize);
+		}
+
+		void ReadPlaceholder(const NcmPlaceHolderId& placeholderId, u64 offset, void* buffer, size_t bufSize) override
+		{
+			m_memory.ReadPlaceholder(placeholderId, offset, buffer, bufSize);
+		}
+
+		u64 GetWriteBlockSize() const override { return m_blockSize; }
+
+		const std::vector<u8>& GetPlaceholder(const NcmPlaceHolderId& placeholderId)
+		{
+			return m_memory.GetPlaceholder(placeholderId);
+		}
+	};
+
+	template<class Sink>
+	void expectPlaceholder(const std::shared_ptr<Sink>& sink, const bench::SyntheticNca& nca)
+	{
+		const std::vector<u8>& data = sink->GetPlaceholder(*(NcmPlaceHolderId*)&nca.id);
+		if (data.size() != nca.installed.size())
+			THROW_FORMAT("Placeholder is 0x%lx bytes instead of 0x%lx\n", data.size(), nca.installed.size());
+
+		auto mismatch = std::mismatch(data.begin(), data.end(), nca.installed.begin());
+		if (mismatch.first != data.end())
+			THROW_FORMAT("Placeholder differs at 0x%lx\n", (u64)(mismatch.first - data.begin()));
+	}
+
+	std::shared_ptr<nx::ncm::MemorySink> windowFor(const bench::SyntheticNca& nca)
+	{
+		return std::make_shared<nx::ncm::MemorySink>(nca.installed.size());
+	}
+
+	// Every section is encrypted on its own, seeking to the start of its part of the slab
+	void referenceEncrypt(const std::vector<NczHeader::Section>& sections, u8* data, u64 size)
+	{
+		for (auto& section : sections)
+		{
+			u64 start = section.offset;
+			u64 end = std::min(size, section.offset + section.size);
+			if ((section.cryptoType != 3 && section.cryptoType != 4) || start >= end)
+				continue;
+
+			Crypto::Aes128Ctr crypto(section.cryptoKey, Crypto::AesCtr(Crypto::swapEndian(((u64*)section.cryptoCounter)[0])));
+			crypto.seek(start);
+			crypto.encrypt(data + start, data + start, end - start);
+		}
+	}
+
+	// Encrypts the slab with one encrypt call per (offset, size) in calls, which have to cover it once
+	void expectCtr(const std::vector<NczHeader::Section>& sections, const std::vector<u8>& plain, const std::vector<std::pair<u64, u64>>& calls)
+	{
+		std::vector<u8> expected = plain;
+		referenceEncrypt(sections, expected.data(), expected.size());
+
+		std::vector<u8> actual = plain;
+		auto writer = sectionWriter(sections);
+		for (auto& [offset, size] : calls)
+			writer->encrypt(actual.data() + offset, size, offset);
+
+		auto mismatch = std::mismatch(actual.begin(), actual.end(), expected.begin());
+		if (mismatch.first != actual.end())
+			THROW_FORMAT("Encrypted slab differs at 0x%lx\n", (u64)(mismatch.first - actual.begin()));
+	}
+
+	std::vector<std::pair<u64, u64>> slabs(u64 size, u64 slabSize)
+	{
+		std::vector<std::pair<u64, u64>> calls;
+		for (u64 offset = 0; offset < size; offset += slabSize)
+			calls.emplace_back(offset, std::min(slabSize, size - offset));
+		return calls;
+	}
+
+	// Runs step in a process of its own, like a fresh launch of the app, so it starts without any of the
+	// journal's state in memory. Steps that end in _exit skip every destructor and flush, like a crash.
+	void inProcess(const std::function<void()>& step)
+	{
+		int error[2];
+		if (pipe(error) != 0)
+			THROW_FORMAT("Failed to create a pipe\n");
+
+		fflush(stdout);
+		pid_t pid = fork();
+		if (pid == 0)
+		{
+			close(error[0]);
+			try
+			{
+				step();
+			}
+			catch (std::exception& e)
+			{
+				if (write(error[1], e.what(), strlen(e.what())) < 0) {}
+				_exit(1);
+			}
+			_exit(0);
+		}
+		close(error[1]);
+
+		std::string message;
+		char buffer[0x100];
+		ssize_t size;
+		while ((size = read(error[0], buffer, sizeof(buffer))) > 0)
+			message.append(buffer, size);
+		close(error[0]);
+
+		int status = 0;
+		if (pid < 0 || waitpid(pid, &status, 0) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+			THROW_FORMAT("%s", message.empty() ? "Child process failed\n" : message.c_str());
+	}
+
+	// A working directory of its own for the journal and the placeholder files, removed afterwards
+	class ScratchDirectory
+	{
+	private:
+		std::filesystem::path m_previous;
+		std::filesystem::path m_path;
+
+	public:
+		ScratchDirectory()
+		{
+			char path[] = "/tmp/tinwoo-bench-XXXXXX";
+			if (mkdtemp(path) == NULL)
+				THROW_FORMAT("Failed to create a scratch directory\n");
+			m_path = path;
+			m_previous = std::filesystem::current_path();
+			std::filesystem::current_path(m_path);
+			std::filesystem::create_directories(inst::config::appDir);
+		}
+
+		~ScratchDirectory()
+		{
+			std::error_code ec;
+			std::filesystem::current_path(m_previous, ec);
+			std::filesystem::remove_all(m_path, ec);
+		}
+	};
+
+	int runChecks(const Options& options)
+	{
+		// Not a whole number of segments, blocks or zstd windows, so every tail gets exercised
+		bench::SyntheticNca nca = bench::GenerateNca(options.size + 0x1200, 3);
+		bench::SyntheticNca nczOnly = bench::GenerateNca(3 * MB + 0x600, 4);
+
+		for (u64 chunkSize : { SOURCE_CHUNK_SIZE, (u64)0x10001, (u64)0x4000 })
+		{
+			char suffix[0x40];
+			snprintf(suffix, sizeof(suffix), " in 0x%lx writes", chunkSize);
+
+			check((std::string("plain NCA") + suffix).c_str(), [&] {
+				auto sink = windowFor(nca);
+				streamNca(nca.nca.data(), nca.nca.size(), sink, nca.id, chunkSize);
+				expectPlaceholder(sink, nca);
+			});
+
+			check((std::string("NCZ") + suffix).c_str(), [&] {
+				auto sink = windowFor(nca);
+				streamNca(nca.ncz.data(), nca.ncz.size(), sink, nca.id, chunkSize);
+				expectPlaceholder(sink, nca);
+			});
+		}
+
+		// Every block size the SD and NAND settings allow has to give the same placeholder, written in
+		// whole aligned blocks except for the end of the NCA
+		for (u64 blockSize : { (u64)0x4000, (u64)0x10000, MB, 8 * MB })
+		{
+			for (bool compressed : { false, true })
+			{
+				char name[0x60];
+				snprintf(name, sizeof(name), "%s written in aligned 0x%lx blocks", compressed ? "NCZ" : "plain NCA", blockSize);
+
+				check(name, [&] {
+					auto sink = std::make_shared<RecordingSink>(nca.installed.size(), blockSize);
+					const std::vector<u8>& source = compressed ? nca.ncz : nca.nca;
+					streamNca(source.data(), source.size(), sink, nca.id, 0x10001);
+					expectPlaceholder(sink, nca);
+
+					for (auto& [offset, size] : sink->writes)
+					{
+						if (offset % blockSize || (size % blockSize && offset + size != nca.installed.size()))
+							THROW_FORMAT("Unaligned write of 0x%lx bytes at 0x%lx\n", size, offset);
+					}
+				});
+			}
+		}
+
+		// A failed write has to reach the caller, and nothing may be written while the writer unwinds
+		for (bool compressed : { false, true })
+		{
+			check(compressed ? "NCZ writer dropped after a failed write" : "plain NCA writer dropped after a failed write", [&] {
+				auto sink = std::make_shared<RecordingSink>(nca.installed.size(), 0x10000, 1);
+				const std::vector<u8>& source = compressed ? nca.ncz : nca.nca;
+
+				try
+				{
+					streamNca(source.data(), source.size(), sink, nca.id, 0x10001);
+				}
+				catch (std::exception&) {}
+
+				if (!sink->failed)
+					THROW_FORMAT("The write never failed\n");
+				if (sink->writesAfterFailure)
+					THROW_FORMAT("%lu writes after the failure\n", sink->writesAfterFailure);
+			});
+		}
+
+		check("buffered writer dropped after a failed write", [&] {
+			tin::data::NUM_BUFFER_SEGMENTS = 2;
+			auto sink = std::make_shared<RecordingSink>(nca.installed.size(), 0x10000, 1);
+
+			try
+			{
+				streamBuffered(nca.nca, sink, nca.id, 0x3001);
+			}
+			catch (std::exception&) {}
+
+			if (!sink->failed)
+				THROW_FORMAT("The write never failed\n");
+			if (sink->writesAfterFailure)
+				THROW_FORMAT("%lu writes after the failure\n", sink->writesAfterFailure);
+		});
+
+		for (int segments : { 2, 4 })
+		{
+			tin::data::NUM_BUFFER_SEGMENTS = segments;
+			std::string suffix = " through " + std::to_string(segments) + " buffer segments";
+
+			check(("buffered plain NCA" + suffix).c_str(), [&] {
+				auto sink = windowFor(nca);
+				streamBuffered(nca.nca, sink, nca.id, options.receiveSize);
+				expectPlaceholder(sink, nca);
+			});
+
+			check(("buffered NCZ" + suffix).c_str(), [&] {
+				auto sink = windowFor(nca);
+				streamBuffered(nca.ncz, sink, nca.id, 0x3001);
+				expectPlaceholder(sink, nca);
+			});
+
+			check(("buffered abort" + suffix).c_str(), [&] {
+				// Both threads have to come back on their own, a hang here fails the check by timeout
+				auto sink = windowFor(nca);
+				streamBuffered(nca.nca, sink, nca.id, options.receiveSize, nca.nca.size() / 2);
+			});
+		}
+
+		// The sections end before the slab does, so there is a tail past the last one as well
+		const u64 ctrSize = 4 * MB + 0x1200;
+		auto sections = ctrSections(ctrSize, 7);
+		std::vector<u8> plain(ctrSize);
+		for (u64 i = 0; i < plain.size(); i++)
+			plain[i] = (u8)(i * 0x1F + (i >> 9));
+
+		check("CTR over all sections in one call", [&] {
+			expectCtr(sections, plain, { { 0, plain.size() } });
+		});
+
+		check("CTR in 0x10001 slabs", [&] {
+			expectCtr(sections, plain, slabs(plain.size(), 0x10001));
+		});
+
+		check("CTR slabs starting and ending in gaps", [&] {
+			// From the middle of one gap to the middle of the next, then the tail on its own
+			std::vector<std::pair<u64, u64>> calls;
+			u64 offset = 0;
+			for (auto& section : sections)
+			{
+				u64 gapMiddle = section.offset + section.size + 0x100;
+				calls.emplace_back(offset, gapMiddle - offset);
+				offset = gapMiddle;
+			}
+			calls.emplace_back(offset, plain.size() - offset);
+			expectCtr(sections, plain, calls);
+		});
+
+		check("CTR in non-contiguous slabs", [&] {
+			// Back to front, so every call has to move the keystream, mostly to the middle of a block
+			auto calls = slabs(plain.size(), 0x10001);
+			std::reverse(calls.begin(), calls.end());
+			expectCtr(sections, plain, calls);
+		});
+
+		check("placeholder left by a crash collected as stale", [&] {
+			ScratchDirectory scratch;
+			NcmPlaceHolderId placeholderId = *(NcmPlaceHolderId*)&nca.id;
+
+			// Killed halfway through streaming the NCA, before anything else wrote the journal out
+			inProcess([&] {
+				auto storage = std::make_shared<nx::ncm::ContentStorage>(NcmStorageId_SdCard);
+				NcaWriter writer(nca.id, storage);
+				writer.write(nca.nca.data(), nca.nca.size() / 2);
+				_exit(0);
+			});
+
+			// The next launch has to recognise the placeholder as its own
+			inProcess([&] {
+				auto report = inst::placeholder_gc::Scan();
+				if (report.stale.count != 1 || report.foreign.count || report.resumable.count)
+					THROW_FORMAT("Found %u stale, %u resumable and %u foreign placeholders instead of one stale\n", report.stale.count, report.resumable.count, report.foreign.count);
+
+				u64 freed = inst::placeholder_gc::Collect();
+				if (freed != nca.installed.size())
+					THROW_FORMAT("Collected 0x%lx bytes instead of 0x%lx\n", freed, nca.installed.size());
+				if (!nx::ncm::ContentStorage(NcmStorageId_SdCard).ListPlaceholders().empty())
+					THROW_FORMAT("The placeholder is still there\n");
+				if (inst::journal::IsTracked(*(NcmContentId*)&placeholderId))
+					THROW_FORMAT("The journal still has the placeholder\n");
+			});
+		});
+
+		std::vector<bench::PackedFile> content = {
+			{ tin::util::GetNcaIdString(nca.id) + ".nca", nca.nca.data(), nca.nca.size() },
+			{ tin::util::GetNcaIdString(nczOnly.id) + ".ncz", nczOnly.ncz.data(), nczOnly.ncz.size() },
+		};
+		auto filler = bench::GenerateFiller(40, 5);
+
+		check("NSP parser", [&] {
+			std::vector<u8> data = bench::BuildNsp(packFiles(filler, content));
+			MemoryNSP nsp(data);
+			nsp.RetrieveHeader();
+
+			if (nsp.GetFileEntriesByExtension("nca").size() != filler.size() + 1)
+				THROW_FORMAT("Wrong number of .nca entries\n");
+			if (nsp.GetFileEntriesByExtension("ncz").size() != 1)
+				THROW_FORMAT("Wrong number of .ncz entries\n");
+
+			for (auto* synthetic : { &nca, &nczOnly })
+			{
+				auto sink = windowFor(*synthetic);
+				nsp.StreamToPlaceholder(sink, synthetic->id);
+				expectPlaceholder(sink, *synthetic);
+			}
+		});
+
+		check("XCI parser", [&] {
+			std::vector<u8> data = bench::BuildXci(packFiles(filler, content));
+			MemoryXCI xci(data);
+			xci.RetrieveHeader();
+
+			if (xci.GetFileEntriesByExtension("nca").size() != filler.size() + 1)
+				THROW_FORMAT("Wrong number of .nca entries\n");
+
+			for (auto* synthetic : { &nca, &nczOnly })
+			{
+				auto sink = windowFor(*synthetic);
+				xci.StreamToPlaceholder(sink, synthetic->id);
+				expectPlaceholder(sink, *synthetic);
+			}
+		});
+
+		printf("%s\n", g_failures ? "FAILED" : "all checks passed");
+		return g_failures ? 1 : 0;
+	}
+
+	void usage(const char* argv0)
+	{
+		printf("usage: %s [--check] [--size MB] [--segments N] [--receive KB] [benchmark...]\n\n", argv0);
+		for (auto& benchmark : benchmarks)
+			printf("  %-14s %s\n", benchmark.name, benchmark.description);
+	}
+}
+
+int main(int argc, char** argv)
+{
+	Options options;
+	bool checks = false;
+	std::vector<const Benchmark*> selected;
+
+	for (int i = 1; i < argc; i++)
+	{
+		std::string arg = argv[i];
+		bool hasValue = i + 1 < argc;
+
+		if (arg == "--check")
+			checks = true;
+		else if (arg == "--size" && hasValue)
+			options.size = std::stoull(argv[++i]) * MB;
+		else if (arg == "--segments" && hasValue)
+			options.segments = std::stoi(argv[++i]);
+		else if (arg == "--receive" && hasValue)
+			options.receiveSize = std::stoull(argv[++i]) * 0x400;
+		else
+		{
+			const Benchmark* found = nullptr;
+			for (auto& benchmark : benchmarks)
+			{
+				if (arg == benchmark.name)
+					found = &benchmark;
+			}
+
+			if (!found)
+			{
+				usage(argv[0]);
+				return arg == "--help" ? 0 : 2;
+			}
+			selected.push_back(found);
+		}
+	}
+
+	if (checks)
+	{
+		options.size = options.size ? options.size : 16 * MB;
+		return runChecks(options);
+	}
+
+	options.size = options.size ? options.size : 256 * MB;
+
+	if (selected.empty())
+	{
+		for (auto& benchmark : benchmarks)
+			selected.push_back(&benchmark);
+	}
+
+	return runBenchmarks(selected, options);
+}
@@ -13,8 +13,12 @@
 
 #pragma once
 #include <pu/ui/elm/elm_Element.hpp>
+#include <algorithm>
 #include <chrono>
 #include <functional>
+#include <list>
+#include <map>
+#include <unordered_map>
 
 namespace pu::ui::elm {
 
@@ -85,6 +89,28 @@ namespace pu::ui::elm {
             }
     };
 
+    // Least-recently-used set of textures owned by a Menu, so rows scrolled back into view aren't rendered or decoded again
+    class MenuTextureCache {
+        private:
+            using Entry = std::pair<std::string, sdl2::Texture>;
+
+            std::list<Entry> entries;
+            std::unordered_map<std::string, std::list<Entry>::iterator> entry_map;
+
+        public:
+            MenuTextureCache() {}
+            MenuTextureCache(const MenuTextureCache&) = delete;
+            MenuTextureCache &operator=(const MenuTextureCache&) = delete;
+            ~MenuTextureCache();
+
+            // Failed renders and loads are cached as nullptr too, so they aren't retried every frame
+            bool Find(const std::string &key, sdl2::Texture &out_texture);
+            // Replaces the entry of key if there is one, then evicts the oldest entries beyond capacity,
+            // which must cover the textures currently on screen
+            void Insert(const std::string &key, sdl2::Texture texture, const u32 capacity);
+            void Clear();
+    };
+
     class Menu : public Element {
         public:
             static constexpr Color DefaultScrollbarColor = { 110, 110, 110, 0xFF };
@@ -103,7 +129,11 @@ namespace pu::ui::elm {
             static constexpr u32 ShadowHeight = 5;
             static constexpr u8 ShadowBaseAlpha = 160;
 
+            static constexpr u32 MinTextureCacheSize = 64;
+
             using OnSelectionChangedCallback = std::function<void()>;
+            // Builds the item at an index on demand, for lists too long to keep a MenuItem per entry
+            using ItemSource = std::function<MenuItem::Ref(const u32)>;
 
         private:
             i32 x;
@@ -125,11 +155,22 @@ namespace pu::ui::elm {
             std::chrono::time_point<std::chrono::steady_clock> move_start_time;
             OnSelectionChangedCallback on_selection_changed_cb;
             std::vector<MenuItem::Ref> items;
+            ItemSource item_source;
+            u32 source_item_count;
+            std::map<u32, MenuItem::Ref> source_items;
             std::string font_name;
             std::vector<sdl2::Texture> loaded_name_texs;
             std::vector<sdl2::Texture> loaded_icon_texs;
+            MenuTextureCache name_tex_cache;
+            MenuTextureCache icon_tex_cache;
 
             void ReloadItemRenders();
+            sdl2::Texture GetNameTexture(MenuItem::Ref &item);
+            sdl2::Texture GetIconTexture(MenuItem::Ref &item);
+
+            inline u32 GetTextureCacheSize() {
+                return std::max(MinTextureCacheSize, this->items_to_show * 2);
+            }
 
             inline Color MakeItemsFocusColor(const u8 alpha) {
                 return { this->items_focus_clr.r, this->items_focus_clr.g, this->items_focus_clr.b, alpha };
@@ -159,7 +200,7 @@ namespace pu::ui::elm {
             }
 
             inline void RunSelectedItemCallback(const u64 keys) {
-                auto item = this->items.at(this->selected_item_idx);
+                auto item = this->GetItemAt(this->selected_item_idx);
                 const auto cb_count = item->GetOnKeyCallbackCount();
                 for(u32 i = 0; i < cb_count; i++) {
                     if(keys & item->GetOnKeyCallbackKey(i)) {
@@ -175,12 +216,13 @@ namespace pu::ui::elm {
             }
 
             inline u32 GetItemCount() {
+                const auto total_count = this->GetTotalItemCount();
                 auto item_count = this->items_to_show;
-                if(item_count > this->items.size()) {
-                    item_count = this->items.size();
+                if(item_count > total_count) {
+                    item_count = total_count;
                 }
-                if((item_count + this->advanced_item_count) > this->items.size()) {
-                    item_count = this->items.size() - this->advanced_item_count;
+                if((item_count + this->advanced_item_count) > total_count) {
+                    item_count = total_count - this->advanced_item_count;
                 }
                 return item_count;
             }
@@ -267,12 +309,26 @@ namespace pu::ui::elm {
 
             void ClearItems();
 
+            // Replaces the items with item_count entries built by source; only the visible ones are kept alive
+            void SetItemSource(const u32 item_count, ItemSource source);
+            // Rebuilds the visible items, after the data behind the source changed
+            void InvalidateItems();
+
+            inline u32 GetTotalItemCount() {
+                if(this->item_source) {
+                    return this->source_item_count;
+                }
+                return this->items.size();
+            }
+
+            MenuItem::Ref GetItemAt(const u32 idx);
+
             inline void SetCooldownEnabled(const bool enabled) {
                 this->cooldown_enabled = enabled;
             }
 
-            inline MenuItem::Ref &GetSelectedItem() {
-                return this->items.at(this->selected_item_idx);
+            inline MenuItem::Ref GetSelectedItem() {
+                return this->GetItemAt(this->selected_item_idx);
             }
 
             inline std::vector<MenuItem::Ref> &GetItems() {
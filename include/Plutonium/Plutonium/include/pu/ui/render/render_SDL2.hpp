@@ -24,4 +24,11 @@ namespace pu::ui::render {
     void SetAlphaValue(sdl2::Texture texture, const u8 alpha);
     void DeleteTexture(sdl2::Texture &texture);
 
+    // Reference counted by path, for images several layouts show (backgrounds).
+    // Decoding happens on a worker thread; GetSharedImage returns nullptr until the texture could be created.
+    void RequestSharedImage(const std::string &path);
+    sdl2::Texture GetSharedImage(const std::string &path);
+    void ReleaseSharedImage(const std::string &path);
+    void FinalizeImageDecoder();
+
 }
\ No newline at end of file
@@ -29,11 +29,12 @@ namespace pu::ui {
             Color over_bg_color;
             TouchPoint sim_touch_pos;
             sdl2::Texture over_bg_tex;
+            std::string over_bg_path;
             OnInputCallback on_ipt;
             std::vector<RenderCallback> render_cbs;
 
         public:
-            Layout() : Container(0, 0, render::ScreenWidth, render::ScreenHeight), has_image(false), over_bg_color(DefaultBackgroundColor), sim_touch_pos(), over_bg_tex(), on_ipt(), render_cbs() {}
+            Layout() : Container(0, 0, render::ScreenWidth, render::ScreenHeight), has_image(false), over_bg_color(DefaultBackgroundColor), sim_touch_pos(), over_bg_tex(), over_bg_path(), on_ipt(), render_cbs() {}
             PU_SMART_CTOR(Layout)
             ~Layout();
 
@@ -61,7 +62,11 @@ namespace pu::ui {
                 return this->has_image;
             }
             
+            // The background colour shows until the image finished decoding
             inline sdl2::Texture GetBackgroundImageTexture() {
+                if((this->over_bg_tex == nullptr) && this->has_image) {
+                    this->over_bg_tex = render::GetSharedImage(this->over_bg_path);
+                }
                 return this->over_bg_tex;
             }
 
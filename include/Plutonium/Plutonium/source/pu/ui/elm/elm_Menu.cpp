@@ -18,30 +18,130 @@ namespace pu::ui::elm {
         }
     }
 
-    void Menu::ReloadItemRenders() {
-        for(auto &name_tex : this->loaded_name_texs) {
-            render::DeleteTexture(name_tex);
+    MenuTextureCache::~MenuTextureCache() {
+        this->Clear();
+    }
+
+    bool MenuTextureCache::Find(const std::string &key, sdl2::Texture &out_texture) {
+        auto it = this->entry_map.find(key);
+        if(it == this->entry_map.end()) {
+            return false;
         }
-        this->loaded_name_texs.clear();
-        for(auto &icon_tex : this->loaded_icon_texs) {
-            render::DeleteTexture(icon_tex);
+        this->entries.splice(this->entries.begin(), this->entries, it->second);
+        out_texture = it->second->second;
+        return true;
+    }
+
+    void MenuTextureCache::Insert(const std::string &key, sdl2::Texture texture, const u32 capacity) {
+        auto it = this->entry_map.find(key);
+        if(it != this->entry_map.end()) {
+            render::DeleteTexture(it->second->second);
+            this->entries.erase(it->second);
+        }
+
+        this->entries.emplace_front(key, texture);
+        this->entry_map[key] = this->entries.begin();
+        while(this->entries.size() > capacity) {
+            auto &oldest = this->entries.back();
+            this->entry_map.erase(oldest.first);
+            render::DeleteTexture(oldest.second);
+            this->entries.pop_back();
+        }
+    }
+
+    void MenuTextureCache::Clear() {
+        for(auto &entry : this->entries) {
+            render::DeleteTexture(entry.second);
+        }
+        this->entries.clear();
+        this->entry_map.clear();
+    }
+
+    sdl2::Texture Menu::GetNameTexture(MenuItem::Ref &item) {
+        const auto clr = item->GetColor();
+        const auto name = item->GetName();
+        std::string key = this->font_name;
+        key += '\0';
+        key += static_cast<char>(clr.r);
+        key += static_cast<char>(clr.g);
+        key += static_cast<char>(clr.b);
+        key += static_cast<char>(clr.a);
+        key += name;
+
+        sdl2::Texture name_tex = nullptr;
+        if(!this->name_tex_cache.Find(key, name_tex)) {
+            name_tex = render::RenderText(this->font_name, name, clr);
+            this->name_tex_cache.Insert(key, name_tex, this->GetTextureCacheSize());
+        }
+        return name_tex;
+    }
+
+    sdl2::Texture Menu::GetIconTexture(MenuItem::Ref &item) {
+        const auto icon_path = item->GetIconPath();
+        sdl2::Texture icon_tex = nullptr;
+        if(!this->icon_tex_cache.Find(icon_path, icon_tex)) {
+            icon_tex = render::LoadImage(icon_path);
+            this->icon_tex_cache.Insert(icon_path, icon_tex, this->GetTextureCacheSize());
+        }
+        return icon_tex;
+    }
+
+    MenuItem::Ref Menu::GetItemAt(const u32 idx) {
+        if(!this->item_source) {
+            return this->items.at(idx);
         }
+
+        auto it = this->source_items.find(idx);
+        if(it != this->source_items.end()) {
+            return it->second;
+        }
+        auto item = (this->item_source)(idx);
+        this->source_items[idx] = item;
+        return item;
+    }
+
+    void Menu::SetItemSource(const u32 item_count, ItemSource source) {
+        this->ClearItems();
+        this->item_source = source;
+        this->source_item_count = item_count;
+    }
+
+    void Menu::InvalidateItems() {
+        this->source_items.clear();
+        this->loaded_name_texs.clear();
+        this->loaded_icon_texs.clear();
+    }
+
+    void Menu::ReloadItemRenders() {
+        // Textures are owned by the caches, these only hold the visible rows
+        this->loaded_name_texs.clear();
         this->loaded_icon_texs.clear();
     
         const auto item_count = this->GetItemCount();
         for(u32 i = this->advanced_item_count; i < (this->advanced_item_count + item_count); i++) {
-            auto &item = this->items.at(i);
-            auto name_tex = render::RenderText(this->font_name, item->GetName(), item->GetColor());
-            this->loaded_name_texs.push_back(name_tex);
+            auto item = this->GetItemAt(i);
+            this->loaded_name_texs.push_back(this->GetNameTexture(item));
 
             if(item->HasIcon()) {
-                auto icon_tex = render::LoadImage(item->GetIconPath());
-                this->loaded_icon_texs.push_back(icon_tex);
+                this->loaded_icon_texs.push_back(this->GetIconTexture(item));
             }
             else {
                 this->loaded_icon_texs.push_back(nullptr);
             }
         }
+
+        // Drop source items that scrolled out of view, besides the selected one
+        if(this->item_source) {
+            for(auto it = this->source_items.begin(); it != this->source_items.end();) {
+                const auto idx = it->first;
+                if(((idx < this->advanced_item_count) || (idx >= (this->advanced_item_count + item_count))) && (idx != this->selected_item_idx)) {
+                    it = this->source_items.erase(it);
+                }
+                else {
+                    it++;
+                }
+            }
+        }
     }
 
     Menu::Menu(const i32 x, const i32 y, const i32 width, const Color items_clr, const Color items_focus_clr, const i32 items_height, const u32 items_to_show) : Element::Element() {
@@ -63,17 +163,17 @@ namespace pu::ui::elm {
         this->items_focus_clr = items_focus_clr;
         this->move_mode = 0;
         this->font_name = GetDefaultFont(DefaultFontSize::MediumLarge);
+        this->item_source = {};
+        this->source_item_count = 0;
     }
 
     void Menu::ClearItems() {
         this->items.clear();
-        for(auto &name_tex : this->loaded_name_texs) {
-            render::DeleteTexture(name_tex);
-        }
+        this->item_source = {};
+        this->source_item_count = 0;
+        this->source_items.clear();
+        // Cached textures are kept, menus are usually refilled with mostly the same icons and names
         this->loaded_name_texs.clear();
-        for(auto &icon_tex : this->loaded_icon_texs) {
-            render::DeleteTexture(icon_tex);
-        }
         this->loaded_icon_texs.clear();
         this->selected_item_idx = 0;
         this->prev_selected_item_idx = 0;
@@ -81,11 +181,11 @@ namespace pu::ui::elm {
     }
 
     void Menu::SetSelectedIndex(const u32 idx) {
-        if(idx < this->items.size()) {
+        if(idx < this->GetTotalItemCount()) {
             this->selected_item_idx = idx;
             this->advanced_item_count = 0;
-            if(this->selected_item_idx >= (this->items.size() - this->items_to_show)) {
-                this->advanced_item_count = this->items.size() - this->items_to_show;
+            if(this->selected_item_idx >= (this->GetTotalItemCount() - this->items_to_show)) {
+                this->advanced_item_count = this->GetTotalItemCount() - this->items_to_show;
             }
             else if(this->selected_item_idx < this->items_to_show) {
                 this->advanced_item_count = 0;
@@ -101,7 +201,7 @@ namespace pu::ui::elm {
     }
 
     void Menu::OnRender(render::Renderer::Ref &drawer, const i32 x, const i32 y) {
-        if(!this->items.empty()) {
+        if(this->GetTotalItemCount() > 0) {
             const auto item_count = this->GetItemCount();
 
             if(this->loaded_name_texs.empty()) {
@@ -139,7 +239,7 @@ namespace pu::ui::elm {
                     drawer->RenderRectangleFill(this->items_clr, x, cur_item_y, this->w, this->items_h);
                 }
 
-                auto &item = this->items.at(i);
+                auto item = this->GetItemAt(i);
                 const auto name_height = render::GetTextureHeight(name_tex);
                 auto name_x = x + TextMargin;
                 const auto name_y = cur_item_y + ((this->items_h - name_height) / 2);
@@ -163,15 +263,15 @@ namespace pu::ui::elm {
                 cur_item_y += this->items_h;
             }
 
-            if(this->items_to_show < this->items.size()) {
+            if(this->items_to_show < this->GetTotalItemCount()) {
                 const auto scrollbar_x = x + (this->w - ScrollbarWidth);
                 const auto scrollbar_height = this->GetHeight();
                 drawer->RenderRectangleFill(this->scrollbar_clr, scrollbar_x, y, ScrollbarWidth, scrollbar_height);
 
                 const auto light_scrollbar_clr = this->MakeLighterScrollbarColor();
-                const auto scrollbar_factor = (double)this->items_to_show / (double)this->items.size();
+                const auto scrollbar_factor = (double)this->items_to_show / (double)this->GetTotalItemCount();
                 const auto scrollbar_front_height = (u32)(scrollbar_height * scrollbar_factor);
-                const auto scrollbar_front_y = y + (u32)(this->advanced_item_count * ((double)scrollbar_height / (double)this->items.size()));
+                const auto scrollbar_front_y = y + (u32)(this->advanced_item_count * ((double)scrollbar_height / (double)this->GetTotalItemCount()));
                 drawer->RenderRectangleFill(light_scrollbar_clr, scrollbar_x, scrollbar_front_y, ScrollbarWidth, scrollbar_front_height);
             }
             drawer->RenderShadowSimple(x, cur_item_y, this->w, ShadowHeight, ShadowBaseAlpha);
@@ -179,7 +279,7 @@ namespace pu::ui::elm {
     }
 
     void Menu::OnInput(const u64 keys_down, const u64 keys_up, const u64 keys_held, const TouchPoint touch_pos) {
-        if(this->items.empty()) {
+        if(this->GetTotalItemCount() == 0) {
             return;
         }
 
@@ -237,7 +337,7 @@ namespace pu::ui::elm {
                     }
                 }
                 if(move) {
-                    if(!this->items.empty() && (this->selected_item_idx < (this->items.size() - 1))) {
+                    if((this->GetTotalItemCount() > 0) && (this->selected_item_idx < (this->GetTotalItemCount() - 1))) {
                         if((this->selected_item_idx - this->advanced_item_count) == (this->items_to_show - 1)) {
                             this->advanced_item_count++;
                             this->selected_item_idx++;
@@ -256,7 +356,7 @@ namespace pu::ui::elm {
                     else {
                         this->selected_item_idx = 0;
                         this->advanced_item_count = 0;
-                        if(this->items.size() >= this->items_to_show) {
+                        if(this->GetTotalItemCount() >= this->items_to_show) {
                             this->ReloadItemRenders();
                         }
                     }
@@ -293,10 +393,10 @@ namespace pu::ui::elm {
                         }
                     }
                     else {
-                        this->selected_item_idx = this->items.size() - 1;
+                        this->selected_item_idx = this->GetTotalItemCount() - 1;
                         this->advanced_item_count = 0;
-                        if(this->items.size() >= this->items_to_show) {
-                            this->advanced_item_count = this->items.size() - this->items_to_show;
+                        if(this->GetTotalItemCount() >= this->items_to_show) {
+                            this->advanced_item_count = this->GetTotalItemCount() - this->items_to_show;
                             this->ReloadItemRenders();
                         }
                     }
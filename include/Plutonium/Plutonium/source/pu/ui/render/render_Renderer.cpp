@@ -95,6 +95,9 @@ namespace pu::ui::render {
 
     void Renderer::Finalize() {
         if(this->initialized) {
+            // Stop decoding before SDL_image goes away
+            FinalizeImageDecoder();
+
             // Close all the fonts before closing TTF
             g_FontTable.clear();
 
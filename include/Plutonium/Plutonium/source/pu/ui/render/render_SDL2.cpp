@@ -1,8 +1,65 @@
 #include <pu/ui/render/render_SDL2.hpp>
 #include <pu/ui/render/render_Renderer.hpp>
+#include <algorithm>
+#include <map>
+#include <set>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
 
 namespace pu::ui::render {
 
+    namespace {
+
+        struct SharedImage {
+            sdl2::Texture texture;
+            bool failed;
+            u32 refs;
+        };
+
+        // Only touched from the render thread
+        std::map<std::string, SharedImage> g_SharedImages;
+
+        std::mutex g_DecodeLock;
+        std::condition_variable g_DecodeCondition;
+        std::deque<std::string> g_DecodeQueue;
+        std::map<std::string, sdl2::Surface> g_DecodedSurfaces;
+        std::set<std::string> g_DroppedDecodes;
+        std::string g_DecodingPath;
+        std::thread g_DecodeThread;
+        bool g_DecodeExit = false;
+
+        void DecodeThreadFunc() {
+            std::unique_lock<std::mutex> lock(g_DecodeLock);
+            while(true) {
+                g_DecodeCondition.wait(lock, []() {
+                    return g_DecodeExit || !g_DecodeQueue.empty();
+                });
+                if(g_DecodeExit) {
+                    break;
+                }
+
+                g_DecodingPath = g_DecodeQueue.front();
+                g_DecodeQueue.pop_front();
+                lock.unlock();
+                auto surface = IMG_Load(g_DecodingPath.c_str());
+                lock.lock();
+
+                if(g_DroppedDecodes.erase(g_DecodingPath) > 0) {
+                    if(surface != nullptr) {
+                        SDL_FreeSurface(surface);
+                    }
+                }
+                else {
+                    g_DecodedSurfaces[g_DecodingPath] = surface;
+                }
+                g_DecodingPath.clear();
+            }
+        }
+
+    }
+
     sdl2::Texture ConvertToTexture(sdl2::Surface surface) {
         if(surface == nullptr) {
             return nullptr;
@@ -53,4 +110,103 @@ namespace pu::ui::render {
         }
     }
 
+    void RequestSharedImage(const std::string &path) {
+        auto it = g_SharedImages.find(path);
+        if(it != g_SharedImages.end()) {
+            it->second.refs++;
+            return;
+        }
+
+        g_SharedImages[path] = { nullptr, false, 1 };
+        std::scoped_lock lock(g_DecodeLock);
+        // Released and re-requested while still decoding: keep the in-flight result instead of decoding it twice
+        if(g_DroppedDecodes.erase(path) > 0) {
+            return;
+        }
+        g_DecodeQueue.push_back(path);
+        if(!g_DecodeThread.joinable()) {
+            g_DecodeExit = false;
+            g_DecodeThread = std::thread(DecodeThreadFunc);
+        }
+        g_DecodeCondition.notify_one();
+    }
+
+    sdl2::Texture GetSharedImage(const std::string &path) {
+        auto it = g_SharedImages.find(path);
+        if(it == g_SharedImages.end()) {
+            return nullptr;
+        }
+        auto &image = it->second;
+        if((image.texture != nullptr) || image.failed) {
+            return image.texture;
+        }
+
+        sdl2::Surface surface = nullptr;
+        {
+            std::scoped_lock lock(g_DecodeLock);
+            auto decoded = g_DecodedSurfaces.find(path);
+            if(decoded == g_DecodedSurfaces.end()) {
+                return nullptr;
+            }
+            surface = decoded->second;
+            g_DecodedSurfaces.erase(decoded);
+        }
+
+        // Textures can only be created on the render thread
+        image.texture = ConvertToTexture(surface);
+        image.failed = image.texture == nullptr;
+        return image.texture;
+    }
+
+    void ReleaseSharedImage(const std::string &path) {
+        auto it = g_SharedImages.find(path);
+        if(it == g_SharedImages.end()) {
+            return;
+        }
+        it->second.refs--;
+        if(it->second.refs > 0) {
+            return;
+        }
+
+        if((it->second.texture == nullptr) && !it->second.failed) {
+            std::scoped_lock lock(g_DecodeLock);
+            auto queued = std::find(g_DecodeQueue.begin(), g_DecodeQueue.end(), path);
+            auto decoded = g_DecodedSurfaces.find(path);
+            if(queued != g_DecodeQueue.end()) {
+                g_DecodeQueue.erase(queued);
+            }
+            else if(decoded != g_DecodedSurfaces.end()) {
+                if(decoded->second != nullptr) {
+                    SDL_FreeSurface(decoded->second);
+                }
+                g_DecodedSurfaces.erase(decoded);
+            }
+            else if(g_DecodingPath == path) {
+                g_DroppedDecodes.insert(path);
+            }
+        }
+        DeleteTexture(it->second.texture);
+        g_SharedImages.erase(it);
+    }
+
+    void FinalizeImageDecoder() {
+        {
+            std::scoped_lock lock(g_DecodeLock);
+            g_DecodeExit = true;
+            g_DecodeQueue.clear();
+        }
+        g_DecodeCondition.notify_all();
+        if(g_DecodeThread.joinable()) {
+            g_DecodeThread.join();
+        }
+
+        for(auto &decoded : g_DecodedSurfaces) {
+            if(decoded.second != nullptr) {
+                SDL_FreeSurface(decoded.second);
+            }
+        }
+        g_DecodedSurfaces.clear();
+        g_DroppedDecodes.clear();
+    }
+
 }
\ No newline at end of file
@@ -3,18 +3,22 @@
 namespace pu::ui {
 
     Layout::~Layout() {
-        render::DeleteTexture(this->over_bg_tex);
+        render::ReleaseSharedImage(this->over_bg_path);
     }
 
     void Layout::SetBackgroundImage(const std::string &path) {
-        render::DeleteTexture(this->over_bg_tex);
+        render::RequestSharedImage(path);
+        render::ReleaseSharedImage(this->over_bg_path);
         this->has_image = true;
-        this->over_bg_tex = render::LoadImage(path);
+        this->over_bg_tex = nullptr;
+        this->over_bg_path = path;
     }
 
     void Layout::SetBackgroundColor(const Color clr) {
-        render::DeleteTexture(this->over_bg_tex);
+        render::ReleaseSharedImage(this->over_bg_path);
         this->has_image = false;
+        this->over_bg_tex = nullptr;
+        this->over_bg_path.clear();
         this->over_bg_color = clr;
     }
 
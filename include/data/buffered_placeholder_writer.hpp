@@ -23,6 +23,8 @@ SOFTWARE.
 #pragma once
 
 #include <atomic>
+#include <condition_variable>
+#include <mutex>
 #include <switch/types.h>
 #include <memory>
 
@@ -58,12 +60,19 @@ namespace tin::data
 
 		std::unique_ptr<BufferSegment[]> m_bufferSegments;
 
-		std::shared_ptr<nx::ncm::ContentStorage> m_contentStorage;
+		std::shared_ptr<nx::ncm::ContentSink> m_contentStorage;
 		NcmContentId m_ncaId;
 		NcaWriter m_writer;
 
+		// Wakes whichever of the receive and write threads is waiting on the other
+		std::mutex m_mutex;
+		std::condition_variable m_condition;
+		bool m_aborted = false;
+
+		void NotifyWaiters();
+
 	public:
-		BufferedPlaceholderWriter(std::shared_ptr<nx::ncm::ContentStorage>& contentStorage, NcmContentId ncaId, size_t totalDataSize);
+		BufferedPlaceholderWriter(const std::shared_ptr<nx::ncm::ContentSink>& contentStorage, NcmContentId ncaId, size_t totalDataSize);
 
 		void AppendData(void* source, size_t length);
 		bool CanAppendData(size_t length);
@@ -71,6 +80,13 @@ namespace tin::data
 		void WriteSegmentToPlaceholder();
 		bool CanWriteSegmentToPlaceholder();
 
+		// Block until data of this size can be appended, false once aborted
+		bool WaitToAppendData(size_t length);
+		// Block until a segment can be written, false once the placeholder is complete or aborted
+		bool WaitToWriteSegment();
+		// Release both waits for good, used when either side of the transfer fails
+		void Abort();
+
 		// Determine the number of segments required to fit data of this size
 		u32 CalcNumSegmentsRequired(size_t size);
 
@@ -35,7 +35,7 @@ namespace tin::install::xci
 
 		HTTPXCI(std::string url);
 
-		virtual void StreamToPlaceholder(std::shared_ptr<nx::ncm::ContentStorage>& contentStorage, NcmContentId placeholderId) override;
+		virtual void StreamToPlaceholder(const std::shared_ptr<nx::ncm::ContentSink>& contentStorage, NcmContentId placeholderId) override;
 		virtual void BufferData(void* buf, off_t offset, size_t size) override;
 	};
 }
\ No newline at end of file
@@ -27,14 +27,18 @@ extern "C"
 #include <switch/services/fs.h>
 }
 
+#include <map>
 #include <memory>
+#include <string>
 #include <tuple>
 #include <vector>
 
+#include "install/nca.hpp"
 #include "install/simple_filesystem.hpp"
 #include "data/byte_buffer.hpp"
 
 #include "nx/content_meta.hpp"
+#include "nx/ncm.hpp"
 #include "nx/ipc/tin_ipc.h"
 
 namespace tin::install
@@ -45,25 +49,55 @@ namespace tin::install
 		const NcmStorageId m_destStorageId;
 		bool m_ignoreReqFirmVersion = false;
 		bool m_declinedValidation = false;
+		bool m_ncaHeadersValidated = false;
+		u64 m_bytesSkipped = 0;
 
 		std::vector<nx::ncm::ContentMeta> m_contentMeta;
 
+		// Raw NCA bytes read ahead of time by PrefetchCNMT, keyed by NCA id string
+		std::map<std::string, std::vector<u8>> m_prefetchedNcas;
+
 		Install(NcmStorageId destStorageId, bool ignoreReqFirmVersion);
 
 		virtual std::vector<std::tuple<nx::ncm::ContentMeta, NcmContentInfo>> ReadCNMT() = 0;
 
-		virtual void InstallContentMetaRecords(tin::data::ByteBuffer& installContentMetaBuf, int i);
-		virtual void InstallApplicationRecord(int i);
+		// Both take every CNMT of the title at once: one commit, one record push per base title
+		virtual void InstallContentMetaRecords(std::vector<tin::data::ByteBuffer>& installContentMetaBufs);
+		virtual void InstallApplicationRecords();
+		void PushApplicationRecord(u64 baseTitleId, const std::vector<ContentStorageRecord>& newRecords);
 		virtual void InstallNCA(const NcmContentId& ncaId) = 0;
+		// Whether Begin may run InstallNCA for several NCAs of the title at once, on worker threads
+		virtual bool CanInstallNCAsConcurrently() { return false; }
+		void InstallNCAsConcurrently(std::vector<std::tuple<NcmContentId, u64>> ncas, u64 writeBlockSize);
+		virtual bool IsContentPresent(nx::ncm::ContentStorage& contentStorage, const nx::ncm::PackagedContentInfo& contentInfo);
+
+		virtual void ReadNcaHeader(const NcmContentId& ncaId, NcaHeader* header) = 0;
+		// Reads every header with as few source reads as possible, see GetNcaSourceOffset
+		virtual void ReadNcaHeaders(const std::vector<NcmContentId>& ncaIds, std::vector<NcaHeader>& headers);
+		// Where the NCA starts in the package, false when ReadNcaHeader has to fetch its header instead
+		virtual bool GetNcaSourceOffset(const NcmContentId& ncaId, u64* offset) { return false; }
+		virtual void ReadSource(void* buf, u64 offset, size_t size) {}
+		virtual void ConfirmInvalidNcaSignature(const NcmContentId& ncaId) = 0;
+		virtual void ValidateNcaHeaders(const std::vector<NcmContentId>& ncaIds);
+
+		bool ReadPrefetchedNCA(const NcmContentId& ncaId, void* buf, size_t size);
+		bool WritePrefetchedNCA(const std::shared_ptr<nx::ncm::ContentSink>& contentStorage, const NcmContentId& ncaId);
 
 	public:
 		virtual ~Install();
 
+		// Reads the CNMT NCAs into memory without touching storage or the UI,
+		// so it may run on a worker thread while another title is installing
+		virtual void PrefetchCNMT();
+
 		virtual void Prepare();
 		virtual void InstallTicketCert();
 		virtual void Begin();
 
 		virtual u64 GetTitleId(int i = 0);
 		virtual NcmContentMetaType GetContentMetaType(int i = 0);
+
+		// Size of the NCAs Begin didn't transfer because they were already installed
+		u64 GetBytesSkipped();
 	};
 }
\ No newline at end of file
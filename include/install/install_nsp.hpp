@@ -37,9 +37,16 @@ namespace tin::install::nsp
 	protected:
 		std::vector<std::tuple<nx::ncm::ContentMeta, NcmContentInfo>> ReadCNMT() override;
 		void InstallNCA(const NcmContentId& ncaId) override;
+		bool CanInstallNCAsConcurrently() override;
+		void ReadNcaHeader(const NcmContentId& ncaId, tin::install::NcaHeader* header) override;
+		bool GetNcaSourceOffset(const NcmContentId& ncaId, u64* offset) override;
+		void ReadSource(void* buf, u64 offset, size_t size) override;
+		void ConfirmInvalidNcaSignature(const NcmContentId& ncaId) override;
 		void InstallTicketCert() override;
 
 	public:
+		void PrefetchCNMT() override;
+
 		NSPInstall(NcmStorageId destStorageId, bool ignoreReqFirmVersion, const std::shared_ptr<NSP>& remoteNSP);
 	};
 }
\ No newline at end of file
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <exception>
+#include <functional>
+#include <memory>
+#include <thread>
+#include "install/install.hpp"
+
+namespace tin::install
+{
+	// Runs a batch of install tasks in order. While one title's NCAs are
+	// streaming, the next title's header and CNMT are read on a worker thread
+	// so the source never sits idle between titles.
+	class InstallQueue
+	{
+	public:
+		typedef std::function<std::unique_ptr<Install>(size_t)> TaskFactory;
+
+		// The factory is called from the worker thread when prefetching is
+		// enabled, so it must not touch the UI.
+		InstallQueue(size_t count, TaskFactory factory, bool prefetch);
+		~InstallQueue();
+
+		InstallQueue(const InstallQueue&) = delete;
+		InstallQueue& operator=(const InstallQueue&) = delete;
+
+		// onTitleStart is called on the caller's thread before each title is prepared
+		void Run(const std::function<void(size_t)>& onTitleStart);
+
+		// Total size of the NCAs skipped because they were already installed
+		u64 GetBytesSkipped() const;
+
+	private:
+		const size_t m_count;
+		const TaskFactory m_factory;
+		const bool m_prefetch;
+
+		std::thread m_prefetchThread;
+		std::unique_ptr<Install> m_nextTask;
+		std::exception_ptr m_prefetchError;
+		u64 m_bytesSkipped = 0;
+
+		void StartPrefetch(size_t index);
+		std::unique_ptr<Install> TakeTask(size_t index);
+		void JoinPrefetch();
+	};
+}
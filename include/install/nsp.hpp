@@ -40,8 +40,12 @@ namespace tin::install::nsp
 		NSP();
 
 	public:
-		virtual void StreamToPlaceholder(std::shared_ptr<nx::ncm::ContentStorage>& contentStorage, NcmContentId placeholderId) = 0;
+		virtual void StreamToPlaceholder(const std::shared_ptr<nx::ncm::ContentSink>& contentStorage, NcmContentId placeholderId) = 0;
 		virtual void BufferData(void* buf, off_t offset, size_t size) = 0;
+		// Whether StreamToPlaceholder can continue a partially written placeholder
+		virtual bool CanResume() { return false; }
+		// Whether BufferData and StreamToPlaceholder may be called from several threads at once
+		virtual bool CanReadConcurrently() { return false; }
 
 		virtual void RetrieveHeader();
 		virtual const PFS0BaseHeader* GetBaseHeader();
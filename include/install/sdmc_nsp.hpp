@@ -22,6 +22,7 @@ SOFTWARE.
 
 #pragma once
 
+#include <mutex>
 #include "install/nsp.hpp"
 
 namespace tin::install::nsp
@@ -32,9 +33,13 @@ namespace tin::install::nsp
 		SDMCNSP(std::string path);
 		~SDMCNSP();
 
-		virtual void StreamToPlaceholder(std::shared_ptr<nx::ncm::ContentStorage>& contentStorage, NcmContentId ncaId) override;
+		virtual void StreamToPlaceholder(const std::shared_ptr<nx::ncm::ContentSink>& contentStorage, NcmContentId ncaId) override;
 		virtual void BufferData(void* buf, off_t offset, size_t size) override;
+		virtual bool CanResume() override { return true; }
+		virtual bool CanReadConcurrently() override { return true; }
 	private:
 		FILE* m_nspFile;
+		// Seek and read have to happen together, concurrent NCAs share the file
+		std::mutex m_fileMutex;
 	};
 }
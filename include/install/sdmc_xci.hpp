@@ -22,6 +22,7 @@ SOFTWARE.
 
 #pragma once
 
+#include <mutex>
 #include "install/xci.hpp"
 
 namespace tin::install::xci
@@ -32,9 +33,13 @@ namespace tin::install::xci
 		SDMCXCI(std::string path);
 		~SDMCXCI();
 
-		virtual void StreamToPlaceholder(std::shared_ptr<nx::ncm::ContentStorage>& contentStorage, NcmContentId ncaId) override;
+		virtual void StreamToPlaceholder(const std::shared_ptr<nx::ncm::ContentSink>& contentStorage, NcmContentId ncaId) override;
 		virtual void BufferData(void* buf, off_t offset, size_t size) override;
+		virtual bool CanResume() override { return true; }
+		virtual bool CanReadConcurrently() override { return true; }
 	private:
 		FILE* m_xciFile;
+		// Seek and read have to happen together, concurrent NCAs share the file
+		std::mutex m_fileMutex;
 	};
 }
\ No newline at end of file
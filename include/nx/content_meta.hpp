@@ -66,6 +66,7 @@ namespace nx::ncm
 
 		PackagedContentMetaHeader GetPackagedContentMetaHeader();
 		NcmContentMetaKey GetContentMetaKey();
+		std::vector<PackagedContentInfo> GetPackagedContentInfos();
 		std::vector<NcmContentInfo> GetContentInfos();
 
 		void GetInstallContentMeta(tin::data::ByteBuffer& installContentMetaBuffer, NcmContentInfo& cnmtContentInfo, bool ignoreReqFirmVersion);
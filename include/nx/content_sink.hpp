@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstdio>
+#include <map>
+#include <string>
+#include <vector>
+
+extern "C"
+{
+#include <switch/types.h>
+#include <switch/services/ncm_types.h>
+}
+
+namespace nx::ncm
+{
+	// Where the install pipeline puts NCA data. ContentStorage is the real NCM placeholder storage,
+	// the other sinks let the pipeline be benchmarked without touching the console's storage.
+	class ContentSink
+	{
+	public:
+		virtual ~ContentSink() = default;
+
+		virtual void CreatePlaceholder(const NcmContentId& placeholderId, const NcmPlaceHolderId& registeredId, size_t size) = 0;
+		virtual void DeletePlaceholder(const NcmPlaceHolderId& placeholderId) = 0;
+		virtual void WritePlaceholder(const NcmPlaceHolderId& placeholderId, u64 offset, void* buffer, size_t bufSize) = 0;
+		virtual void ReadPlaceholder(const NcmPlaceHolderId& placeholderId, u64 offset, void* buffer, size_t bufSize) = 0;
+
+		// Whether placeholders outlive the app, so an interrupted install can be resumed later
+		virtual bool IsPersistent() const { return false; }
+		// NcaBodyWriter combines writes into blocks of this size, aligned to placeholder offsets
+		virtual u64 GetWriteBlockSize() const { return 0x100000; }
+	};
+
+	// Throws the data away, so only the source and the NCA writer are measured
+	class NullSink final : public ContentSink
+	{
+	private:
+		u64 m_bytesWritten = 0;
+
+	public:
+		void CreatePlaceholder(const NcmContentId& placeholderId, const NcmPlaceHolderId& registeredId, size_t size) override;
+		void DeletePlaceholder(const NcmPlaceHolderId& placeholderId) override;
+		void WritePlaceholder(const NcmPlaceHolderId& placeholderId, u64 offset, void* buffer, size_t bufSize) override;
+		void ReadPlaceholder(const NcmPlaceHolderId& placeholderId, u64 offset, void* buffer, size_t bufSize) override;
+
+		u64 GetBytesWritten() const { return m_bytesWritten; }
+	};
+
+	// Copies every write into RAM, adds the cost of a copy without any storage latency. A placeholder
+	// only gets a buffer of up to window bytes and bigger ones wrap around it, so multi-GB NCAs can be
+	// benchmarked too; only placeholders that fit in the window can be read back.
+	class MemorySink final : public ContentSink
+	{
+	private:
+		struct Placeholder
+		{
+			u64 size;
+			std::vector<u8> data;
+		};
+
+		u64 m_window;
+		u64 m_bytesWritten = 0;
+		std::map<std::string, Placeholder> m_placeholders;
+
+	public:
+		MemorySink(u64 window = 0x4000000);
+
+		void CreatePlaceholder(const NcmContentId& placeholderId, const NcmPlaceHolderId& registeredId, size_t size) override;
+		void DeletePlaceholder(const NcmPlaceHolderId& placeholderId) override;
+		void WritePlaceholder(const NcmPlaceHolderId& placeholderId, u64 offset, void* buffer, size_t bufSize) override;
+		void ReadPlaceholder(const NcmPlaceHolderId& placeholderId, u64 offset, void* buffer, size_t bufSize) override;
+
+		const std::vector<u8>& GetPlaceholder(const NcmPlaceHolderId& placeholderId);
+		u64 GetBytesWritten() const { return m_bytesWritten; }
+	};
+
+	// Writes each placeholder to <directory>/<placeholder id>.nca, so the output can be checked afterwards
+	class FileSink final : public ContentSink
+	{
+	private:
+		std::string m_directory;
+		std::map<std::string, FILE*> m_files;
+
+	public:
+		FileSink& operator=(const FileSink&) = delete;
+		FileSink(const FileSink&) = delete;
+
+		FileSink(const std::string& directory);
+		~FileSink();
+
+		void CreatePlaceholder(const NcmContentId& placeholderId, const NcmPlaceHolderId& registeredId, size_t size) override;
+		void DeletePlaceholder(const NcmPlaceHolderId& placeholderId) override;
+		void WritePlaceholder(const NcmPlaceHolderId& placeholderId, u64 offset, void* buffer, size_t bufSize) override;
+		void ReadPlaceholder(const NcmPlaceHolderId& placeholderId, u64 offset, void* buffer, size_t bufSize) override;
+	};
+}
@@ -22,41 +22,190 @@ SOFTWARE.
 
 #pragma once
 #include <switch.h>
+#include <functional>
 #include <vector>
 #include "nx/ncm.hpp"
 #include <memory>
 #include "install/nca.hpp"
+#include "util/crypto.hpp"
+#include <zstd.h>
 
 class NcaBodyWriter
 {
 public:
-	NcaBodyWriter(const NcmContentId& ncaId, u64 offset, std::shared_ptr<nx::ncm::ContentStorage>& contentStorage);
+	NcaBodyWriter(const NcmContentId& ncaId, u64 offset, const std::shared_ptr<nx::ncm::ContentSink>& contentStorage);
 	virtual ~NcaBodyWriter();
 	virtual u64 write(const  u8* ptr, u64 sz);
+	virtual bool close();
+
+	// Stores data as is. Writes are combined into blocks of the sink's write block size, aligned to
+	// placeholder offsets, only the last block of the NCA goes out short when the writer is closed.
+	u64 writePlain(const  u8* ptr, u64 sz);
+	// Everything before this offset has been handed to the sink
+	u64 committed() const;
 
 	bool isOpen() const;
 
 protected:
-	std::shared_ptr<nx::ncm::ContentStorage> m_contentStorage;
+	void flushPending();
+
+	std::shared_ptr<nx::ncm::ContentSink> m_contentStorage;
 	NcmContentId m_ncaId;
 
 	u64 m_offset;
+	u64 m_blockSize;
+	std::vector<u8> m_pending;
+};
+
+class NczHeader
+{
+public:
+	static const u64 MAGIC = 0x4E544345535A434E; //NTCESZCN
+	static const u64 BLOCK = 0x4E435A424C4F434B; //NCZBLOCK at 0x40D0
+
+	class Section
+	{
+	public:
+		u64 offset;
+		u64 size;
+		u8 cryptoType;
+		u8 padding1[7];
+		u64 padding2;
+		u8 cryptoKey[0x10];
+		u8 cryptoCounter[0x10];
+	} PACKED;
+
+	class SectionContext : public Section
+	{
+	public:
+		Crypto::Aes128Ctr crypto;
+
+		SectionContext(const Section& s) : Section(s), crypto(s.cryptoKey, Crypto::AesCtr(Crypto::swapEndian(((u64*)&s.cryptoCounter)[0])))
+		{
+		}
+
+		virtual ~SectionContext()
+		{
+		}
+
+		void decrypt(void* p, u64 sz, u64 offset)
+		{
+			encrypt(p, sz, offset);
+		}
+
+		void encrypt(void* p, u64 sz, u64 offset)
+		{
+			if (this->cryptoType == 3 || this->cryptoType == 4)
+			{
+				// The body is written sequentially, so the counter only needs resetting
+				// when a call doesn't pick up where the previous one left off
+				if (offset != cryptoOffset)
+				{
+					// seek lands on the start of the block, the keystream before offset is skipped
+					u8 skipped[0x10] = {};
+					crypto.seek(offset);
+					crypto.encrypt(skipped, skipped, offset & 0xF);
+				}
+
+				crypto.encrypt(p, p, sz);
+				cryptoOffset = offset + sz;
+			}
+			else {
+				return;
+			}
+		}
+
+	private:
+		u64 cryptoOffset = 0;
+	};
+
+	const bool isValid()
+	{
+		return m_magic == MAGIC && m_sectionCount < 0xFFFF;
+	}
+
+	const u64 size() const
+	{
+		return sizeof(m_magic) + sizeof(m_sectionCount) + sizeof(Section) * m_sectionCount;
+	}
+
+	const Section& section(u64 i) const
+	{
+		return m_sections[i];
+	}
+
+	const u64 sectionCount() const
+	{
+		return m_sectionCount;
+	}
+
+protected:
+	u64 m_magic;
+	u64 m_sectionCount;
+	Section m_sections[1];
+} PACKED;
+
+// Body of an NCZ: the section table nsz stores after the header, then a zstd stream of the NCA body
+// with the section crypto removed. The sections are encrypted again on the way to the placeholder.
+class NczBodyWriter : public NcaBodyWriter
+{
+public:
+	NczBodyWriter(const NcmContentId& ncaId, u64 offset, const std::shared_ptr<nx::ncm::ContentSink>& contentStorage);
+	// Whatever is still buffered is dropped, only close() writes it out
+	virtual ~NczBodyWriter();
+
+	bool close() override;
+	bool flush();
+
+	// First section ending after offset. sections is sorted by offset once the header is read.
+	std::vector<NczHeader::SectionContext*>::iterator section(u64 offset);
+	// Encrypts the sections that overlap [offset, offset + sz) in place, gaps between them stay as is
+	bool encrypt(const void* ptr, u64 sz, u64 offset);
+	u64 processChunk(const u8* ptr, u64 sz);
+	u64 write(const  u8* ptr, u64 sz) override;
+
+	size_t const buffInSize = ZSTD_DStreamInSize();
+	size_t const buffOutSize = ZSTD_DStreamOutSize();
+
+	void* buffIn = NULL;
+	void* buffOut = NULL;
+
+	ZSTD_DCtx* dctx = NULL;
+
+	std::vector<u8> m_buffer;
+	std::vector<u8> m_deflateBuffer;
+
+	bool m_sectionsInitialized = false;
+
+	std::vector<NczHeader::SectionContext*> sections;
 };
 
 class NcaWriter
 {
 public:
-	NcaWriter(const NcmContentId& ncaId, std::shared_ptr<nx::ncm::ContentStorage>& contentStorage);
+	NcaWriter(const NcmContentId& ncaId, const std::shared_ptr<nx::ncm::ContentSink>& contentStorage);
 	virtual ~NcaWriter();
 
 	bool isOpen() const;
+	// Writes out whatever is still pending, must be called once the whole NCA was written. The
+	// destructor drops pending data instead.
 	bool close();
 	u64 write(const  u8* ptr, u64 sz);
 	void flushHeader();
 
+	// Journals this NCA and picks up where an earlier attempt stopped, for sources that can read
+	// from any offset. Returns the offset to continue streaming from, 0 to start over.
+	u64 resume(u64 ncaSize, const std::function<void(void* buf, u64 offset, size_t size)>& readSource);
+
 protected:
+	void prepareHeader();
+
 	NcmContentId m_ncaId;
-	std::shared_ptr<nx::ncm::ContentStorage> m_contentStorage;
+	std::shared_ptr<nx::ncm::ContentSink> m_contentStorage;
 	std::vector<u8> m_buffer;
 	std::shared_ptr<NcaBodyWriter> m_writer;
+
+	bool m_headerReady = false;
+	bool m_journaled = false;
+	bool m_plainBody = false;
 };
@@ -22,7 +22,9 @@ SOFTWARE.
 
 #pragma once
 
+#include <memory>
 #include <string>
+#include <vector>
 
 extern "C"
 {
@@ -31,13 +33,15 @@ extern "C"
 }
 
 #include "nx/ipc/tin_ipc.h"
+#include "nx/content_sink.hpp"
 
 namespace nx::ncm
 {
-	class ContentStorage final
+	class ContentStorage final : public ContentSink
 	{
 	private:
 		NcmContentStorage m_contentStorage;
+		u64 m_writeBlockSize;
 
 	public:
 		// Don't allow copying, or garbage may be closed by the destructor
@@ -47,12 +51,42 @@ namespace nx::ncm
 		ContentStorage(NcmStorageId storageId);
 		~ContentStorage();
 
-		void CreatePlaceholder(const NcmContentId& placeholderId, const NcmPlaceHolderId& registeredId, size_t size);
-		void DeletePlaceholder(const NcmPlaceHolderId& placeholderId);
-		void WritePlaceholder(const NcmPlaceHolderId& placeholderId, u64 offset, void* buffer, size_t bufSize);
+		void CreatePlaceholder(const NcmContentId& placeholderId, const NcmPlaceHolderId& registeredId, size_t size) override;
+		void DeletePlaceholder(const NcmPlaceHolderId& placeholderId) override;
+		void WritePlaceholder(const NcmPlaceHolderId& placeholderId, u64 offset, void* buffer, size_t bufSize) override;
+		void ReadPlaceholder(const NcmPlaceHolderId& placeholderId, u64 offset, void* buffer, size_t bufSize) override;
+		bool IsPersistent() const override { return true; }
+		u64 GetWriteBlockSize() const override { return m_writeBlockSize; }
+		std::vector<NcmPlaceHolderId> ListPlaceholders();
+		s64 GetPlaceholderSize(const NcmPlaceHolderId& placeholderId);
 		void Register(const NcmPlaceHolderId& placeholderId, const NcmContentId& registeredId);
 		void Delete(const NcmContentId& registeredId);
 		bool Has(const NcmContentId& registeredId);
+		s64 GetSize(const NcmContentId& registeredId);
+		void Read(const NcmContentId& registeredId, s64 offset, void* buffer, size_t bufSize);
 		std::string GetPath(const NcmContentId& registeredId);
 	};
-}
\ No newline at end of file
+
+	class ContentMetaDatabase final
+	{
+	private:
+		NcmContentMetaDatabase m_contentMetaDatabase;
+
+	public:
+		// Don't allow copying, or garbage may be closed by the destructor
+		ContentMetaDatabase& operator=(const ContentMetaDatabase&) = delete;
+		ContentMetaDatabase(const ContentMetaDatabase&) = delete;
+
+		ContentMetaDatabase(NcmStorageId storageId);
+		~ContentMetaDatabase();
+
+		void Set(const NcmContentMetaKey& key, const void* data, size_t size);
+		void Commit();
+	};
+
+	// Sessions shared by every task of an install, so opening them isn't paid per NCA or per title.
+	// They stay open until CloseSessions at the end of the install.
+	std::shared_ptr<ContentStorage> GetContentStorage(NcmStorageId storageId);
+	std::shared_ptr<ContentMetaDatabase> GetContentMetaDatabase(NcmStorageId storageId);
+	void CloseSessions();
+}
@@ -22,7 +22,10 @@ SOFTWARE.
 
 #pragma once
 #include <filesystem>
+#include <string>
 #include <vector>
 namespace nspInstStuff {
 	void installNspFromFile(std::vector<std::filesystem::path> ourNspList, int whereToInstall);
+	// Streams the NCAs through the install pipeline into a "null", "memory" or "file" sink instead of NCM
+	void benchmarkNspFromFile(std::vector<std::filesystem::path> ourNspList, std::string sinkType);
 }
@@ -10,18 +10,43 @@
 #include "ui/optionsPage.hpp"
 
 namespace inst::ui {
+	// Builds its page on first use, so startup only pays for the pages that are actually opened
+	template<typename T>
+	class LazyPage {
+	public:
+		typename T::Ref& Get() {
+			if (!m_page) {
+				m_page = T::New();
+				m_page->SetOnInput(std::bind(&T::onInput, m_page, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3, std::placeholders::_4));
+			}
+			return m_page;
+		}
+
+		T* operator->() {
+			return this->Get().get();
+		}
+
+		operator pu::ui::Layout::Ref() {
+			return this->Get();
+		}
+
+	private:
+		typename T::Ref m_page;
+	};
+
 	class MainApplication : public pu::ui::Application {
 	public:
 		using Application::Application;
 		PU_SMART_CTOR(MainApplication)
 			void OnLoad() override;
-		MainPage::Ref mainPage;
-		netInstPage::Ref netinstPage;
-		ThemeInstPage::Ref ThemeinstPage;
-		sdInstPage::Ref sdinstPage;
-		HDInstPage::Ref HDinstPage;
-		usbInstPage::Ref usbinstPage;
-		instPage::Ref instpage;
-		optionsPage::Ref optionspage;
+		LazyPage<MainPage> mainPage;
+		LazyPage<netInstPage> netinstPage;
+		LazyPage<ThemeInstPage> ThemeinstPage;
+		LazyPage<sdInstPage> sdinstPage;
+		LazyPage<HDInstPage> HDinstPage;
+		LazyPage<usbInstPage> usbinstPage;
+		LazyPage<instPage> instpage;
+		LazyPage<optionsPage> optionspage;
+		static u64 startTick;
 	};
 }
\ No newline at end of file
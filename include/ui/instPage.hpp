@@ -19,6 +19,17 @@ namespace inst::ui {
 		static void setInstInfoText(std::string ourText);
 		static void filecount(std::string ourText);
 		static void setInstBarPerc(double ourPercent);
+		// Progress of the NCA being streamed. publishBuffered/publishWritten are lock-free and may be
+		// called from transfer threads; pumpProgress redraws at a capped rate, only when something changed.
+		// A progress begun on any thread but the one that loaded the install screen is ignored.
+		static void beginProgress(bool downloading, std::string ncaName, u64 totalSize);
+		static void publishBuffered(u64 sizeBuffered);
+		static void publishWritten(u64 sizeWritten);
+		static void beginInstallStage();
+		// Same bar, labelled as checking an NCA that's already installed
+		static void beginCheckProgress(std::string ncaName, u64 totalSize);
+		static void pumpProgress(bool idle = true);
+		static void endProgress();
 		static void loadMainMenu();
 		static void loadInstallScreen();
 	private:
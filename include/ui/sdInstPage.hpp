@@ -27,6 +27,7 @@ namespace inst::ui {
 		TextBlock::Ref appVersionText;
 		void followDirectory();
 		void selectNsp(int selectedIndex);
+		pu::ui::elm::MenuItem::Ref makeMenuItem(u32 index);
 		bool show_ext;
 	};
 }
\ No newline at end of file
@@ -13,6 +13,7 @@ namespace inst::ui {
 		void onInput(u64 Down, u64 Up, u64 Held, pu::ui::TouchPoint touch_pos);
 		TextBlock::Ref pageInfoText;
 	private:
+		bool showExtension = false;
 		std::vector<std::string> ourTitles;
 		std::vector<std::string> selectedTitles;
 		std::string lastUrl;
@@ -27,6 +28,8 @@ namespace inst::ui {
 		Image::Ref infoImage;
 		void drawMenuItems(bool clearItems);
 		void drawMenuItems_withext(bool clearItems);
+		void setMenuSource(bool clearItems);
+		pu::ui::elm::MenuItem::Ref makeMenuItem(u32 index);
 		void selectTitle(int selectedIndex);
 	};
 }
\ No newline at end of file
@@ -26,6 +26,9 @@ namespace inst::config {
 	extern bool fixticket;
 	extern bool listoveride;
 	extern bool httpkeyboard;
+	extern std::string benchmarkSink;
+	extern int writeBlockSd;
+	extern int writeBlockNand;
 
 	void setConfig();
 	void parseConfig();
@@ -2,6 +2,10 @@
 
 #include <stddef.h>
 #include <switch.h>
+#include <array>
+#include <map>
+#include <mutex>
+#include <vector>
 
 namespace Crypto
 {
@@ -33,16 +37,38 @@ namespace Crypto
 		{
 			u8 kek[0x10] = { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 };
 
-			splCryptoGenerateAesKek(headerKekSource, 0, 0, kek);
-			splCryptoGenerateAesKey(kek, headerKeySource, headerKey);
-			splCryptoGenerateAesKey(kek, headerKeySource + 0x10, headerKey + 0x10);
+			valid = R_SUCCEEDED(splCryptoGenerateAesKek(headerKekSource, 0, 0, kek))
+				&& R_SUCCEEDED(splCryptoGenerateAesKey(kek, headerKeySource, headerKey))
+				&& R_SUCCEEDED(splCryptoGenerateAesKey(kek, headerKeySource + 0x10, headerKey + 0x10));
 		}
 
+		Keys(const Keys&) = delete;
+		Keys& operator=(const Keys&) = delete;
+
+		// Deriving the header key takes three SPL calls, so it is only done once per process
+		static Keys& Get();
+
+		bool valid = false;
+
 		u8 headerKekSource[0x10] = { 0x1F, 0x12, 0x91, 0x3A, 0x4A, 0xCB, 0xF0, 0x0D, 0x4C, 0xDE, 0x3A, 0xF6, 0xD5, 0x23, 0x88, 0x2A };
 		u8 headerKeySource[0x20] = { 0x5A, 0x3E, 0xD8, 0x4F, 0xDE, 0xC0, 0xD8, 0x26, 0x31, 0xF7, 0xE2, 0x5D, 0x19, 0x7B, 0xF5, 0xD0, 0x1C, 0x9B, 0x7B, 0xFA, 0xF6, 0x28, 0x18, 0x3D, 0x71, 0xF6, 0x4D, 0x73, 0xF1, 0x50, 0xB9, 0xD2 };
 
 		u8 headerKey[0x20] = { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 };
 		//u8 headerKey[0x20] = { 0xAE, 0xAA, 0xB1, 0xCA, 0x08, 0xAD, 0xF9, 0xBE, 0xF1, 0x29, 0x91, 0xF3, 0x69, 0xE3, 0xC5, 0x67, 0xD6, 0x88, 0x1E, 0x4E, 0x4A, 0x6A, 0x47, 0xA5, 0x1F, 0x6E, 0x48, 0x77, 0x06, 0x2D, 0x54, 0x2D };
+
+		// Unwraps a key from an NCA's key area with the given key area key index and key generation
+		void GetKeyAreaKey(u8 kaekIndex, u8 keyGeneration, const u8* encryptedKey, u8* out);
+
+		// Application, ocean and system key area key sources
+		const u8 keyAreaKeySources[3][0x10] = {
+			{ 0x7F, 0x59, 0x97, 0x1E, 0x62, 0x9F, 0x36, 0xA1, 0x30, 0x98, 0x06, 0x6F, 0x21, 0x44, 0xC3, 0x0D },
+			{ 0x32, 0x7D, 0x36, 0x08, 0x5A, 0xD1, 0x75, 0x8D, 0xAB, 0x4E, 0x6F, 0xBA, 0xA5, 0x55, 0xD8, 0x82 },
+			{ 0x87, 0x45, 0xF1, 0xBB, 0xA6, 0xBE, 0x79, 0x64, 0x7D, 0x04, 0x8B, 0xA6, 0x7B, 0x5F, 0xDA, 0x4A }
+		};
+
+	private:
+		std::mutex m_keyAreaKekMutex;
+		std::map<u16, std::array<u8, 0x10>> m_keyAreaKeks;
 	};
 
 	void calculateMGF1andXOR(unsigned char* data, size_t data_size, const void* source, size_t source_size);
@@ -152,4 +178,22 @@ namespace Crypto
 	protected:
 		Aes128XtsContext ctx;
 	};
+
+	// Borrows an NCA header XTS context from a shared pool, so the key schedule is
+	// only set up once per concurrent user instead of once per NCA
+	class HeaderXtsLease
+	{
+	public:
+		HeaderXtsLease(bool is_encryptor);
+		~HeaderXtsLease();
+
+		HeaderXtsLease(const HeaderXtsLease&) = delete;
+		HeaderXtsLease& operator=(const HeaderXtsLease&) = delete;
+
+		AesXtr* operator->() { return m_xtr; }
+
+	private:
+		bool m_isEncryptor;
+		AesXtr* m_xtr;
+	};
 }
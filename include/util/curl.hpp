@@ -1,8 +1,11 @@
 #pragma once
+#include <functional>
 #include <string>
 
 namespace inst::curl {
 	bool downloadFile(const std::string ourUrl, const char* pagefilename, long timeout = 5000, bool writeProgress = false);
+	// onData gets the body in the chunks curl receives it, returning false aborts the transfer
+	bool downloadToCallback(const std::string ourUrl, std::function<bool(const void*, size_t)> onData, long timeout = 5000, bool writeProgress = false);
 	std::string downloadToBuffer(const std::string ourUrl, int firstRange = -1, int secondRange = -1, long timeout = 5000);
 	std::string html_to_buffer(const std::string ourUrl);
 }
\ No newline at end of file
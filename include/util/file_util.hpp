@@ -32,5 +32,6 @@ namespace tin::util
 {
 	NcmContentInfo CreateNSPCNMTContentRecord(const std::string& nspPath);
 	nx::ncm::ContentMeta GetContentMetaFromNCA(const std::string& ncaPath);
+	nx::ncm::ContentMeta GetContentMetaFromNCA(std::vector<u8>& ncaBytes);
 	std::vector<std::string> GetNSPList();
 }
\ No newline at end of file
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <switch.h>
+
+#include <vector>
+
+// Placeholders we created and how far plain NCAs got into them, kept in install_journal.json in the app
+// directory so an install that was cancelled, slept through or lost power can carry on from there, and
+// so placeholders left behind by failed installs can be told apart from other software's.
+namespace inst::journal {
+	// Record a placeholder created for this NCA. Saved before returning, so the placeholder never holds
+	// data the journal doesn't know about
+	void Track(const NcmContentId& ncaId, u64 size);
+	// Bytes handed to the placeholder so far, saved to the SD card every few dozen MB
+	void Progress(const NcmContentId& ncaId, u64 written);
+	// Only changes the journal in memory, it's written out by the next save or Flush. An entry left over
+	// by a crash is harmless, Retain drops it once its placeholder is gone.
+	void Remove(const NcmContentId& ncaId);
+	// Write out pending Remove calls, once per title instead of once per NCA
+	void Flush();
+	// Offset an earlier attempt at this NCA got to, 0 if there's nothing to resume
+	u64 GetResumeOffset(const NcmContentId& ncaId, u64 size);
+	bool IsTracked(const NcmContentId& ncaId);
+	bool IsResumable(const NcmContentId& ncaId);
+	// Forget every NCA whose placeholder isn't in the list any more
+	void Retain(const std::vector<NcmContentId>& ncaIds);
+}
@@ -4,12 +4,13 @@
 #include <sstream>
 #include <fstream>
 #include "json.hpp"
+#include "util/string_table.hpp"
 
 using json = nlohmann::json;
 
 namespace Language {
 	void Load();
-	std::string LanguageEntry(std::string key);
+	const std::string& LanguageEntry(u64 hash, std::string_view key);
 	std::string GetRandomMsg();
 	inline json GetRelativeJson(json j, std::string key) {
 		std::istringstream ss(key);
@@ -23,6 +24,7 @@ namespace Language {
 	}
 }
 
-inline std::string operator ""_lang(const char* key, size_t size) {
-	return Language::LanguageEntry(std::string(key, size));
+template<inst::util::FixedString Key>
+inline const std::string& operator ""_lang() {
+	return Language::LanguageEntry(inst::util::HashLiteral<Key>(), Key.view());
 }
\ No newline at end of file
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <switch.h>
+
+// Finds and deletes NCM placeholders left behind on the SD card and NAND by failed or aborted installs
+namespace inst::placeholder_gc {
+	struct Usage {
+		u32 count = 0;
+		u64 bytes = 0;
+	};
+
+	struct Report {
+		Usage stale;     // ours, nothing will ever finish them
+		Usage resumable; // ours, the journal can pick them up again
+		Usage foreign;   // not created by us, e.g. a paused system download
+	};
+
+	Report Scan();
+	// Deletes stale placeholders, resumable and foreign ones only when asked to. Returns the bytes freed.
+	u64 Collect(bool includeResumable = false, bool includeForeign = false);
+
+	// Collects stale placeholders on a background thread at launch
+	void StartBackgroundCollect();
+	// Installs create placeholders of their own, so they wait for the background pass first
+	void WaitForBackgroundCollect();
+}
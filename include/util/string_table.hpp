@@ -0,0 +1,81 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+#include <switch.h>
+#include "json.hpp"
+
+namespace inst::util {
+	// FNV-1a, the same at compile time and at load
+	constexpr u64 HashKey(const char* key, size_t size) {
+		u64 hash = 0xcbf29ce484222325;
+		for (size_t i = 0; i < size; i++) {
+			hash ^= (u8)key[i];
+			hash *= 0x100000001b3;
+		}
+		return hash;
+	}
+
+	// A string literal as a template argument, so the literal operators below get the key at compile time
+	template<size_t N>
+	struct FixedString {
+		char data[N];
+
+		constexpr FixedString(const char (&str)[N]) {
+			for (size_t i = 0; i < N; i++)
+				data[i] = str[i];
+		}
+
+		constexpr std::string_view view() const {
+			return std::string_view(data, N - 1);
+		}
+	};
+
+	// consteval, so a key that can't be hashed at compile time doesn't build instead of hashing at runtime
+	template<FixedString Key>
+	consteval u64 HashLiteral() {
+		return HashKey(Key.data, sizeof(Key.data) - 1);
+	}
+
+	// Flattened "a.b.c" -> string view of a JSON document, stored in an open addressing table.
+	// Lookups of present keys don't allocate; missing keys are answered from a separate, locked map.
+	// Build assembles a new table off to the side and publishes it atomically. Tables are never freed
+	// before the StringTable itself, so references handed out by Get stay valid across a reload.
+	class StringTable
+	{
+	public:
+		StringTable(std::string missingPrefix, std::string missingSuffix);
+
+		void Build(const nlohmann::json& root);
+		const std::string& Get(u64 hash, std::string_view key);
+
+	private:
+		struct Slot
+		{
+			bool used = false;
+			u64 hash = 0;
+			std::string key;
+			std::string value;
+		};
+
+		struct Table
+		{
+			std::vector<Slot> slots;
+		};
+
+		std::string m_missingPrefix;
+		std::string m_missingSuffix;
+		std::atomic<const Table*> m_table{nullptr};
+		std::mutex m_buildMutex;
+		std::vector<std::unique_ptr<Table>> m_tables;
+		std::mutex m_missMutex;
+		std::unordered_map<std::string, std::string> m_misses;
+
+		void Flatten(const nlohmann::json& j, const std::string& prefix, std::vector<std::pair<std::string, std::string>>& entries);
+	};
+}
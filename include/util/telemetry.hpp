@@ -0,0 +1,39 @@
+#pragma once
+
+#include <string>
+#include <switch.h>
+
+// Per NCA timing of every stage an install streams through, written to install_report.json in the
+// app directory after each install. Counters are lock-free so transfer threads can record directly.
+namespace inst::telemetry {
+	enum class Stage {
+		Source,      // reading from USB, HTTP or the SD card/HDD
+		Buffer,      // copying into the BufferedPlaceholderWriter segments
+		Decompress,  // zstd, NCZ only
+		Encrypt,     // AES-CTR re-encryption, NCZ only
+		Placeholder, // ncmContentStorageWritePlaceHolder
+		Count
+	};
+
+	// Time the stage spent working since startTick (armGetSystemTick) and the bytes it handled
+	void AddBusy(Stage stage, u64 startTick, u64 bytes);
+	// Time the stage spent blocked on its neighbour since startTick
+	void AddWait(Stage stage, u64 startTick);
+
+	void BeginReport(const std::string& source, NcmStorageId destStorageId);
+	// destination is free form, e.g. the sink a benchmark run streams into
+	void BeginReport(const std::string& source, const std::string& destination);
+	void EndReport(bool success, const std::string& error = "");
+
+	// Stages record into the NCA of the scope open on the calling thread. Threads without one, like
+	// the download threads of USB and HTTP installs, record into the most recently opened scope.
+	class NcaScope
+	{
+	public:
+		NcaScope(const std::string& name, u64 size);
+		~NcaScope();
+
+		NcaScope(const NcaScope&) = delete;
+		NcaScope& operator=(const NcaScope&) = delete;
+	};
+}
@@ -3,13 +3,21 @@
 #include <string>
 #include <sstream>
 #include <fstream>
+#include <pu/ui/ui_Types.hpp>
 #include "json.hpp"
+#include "util/string_table.hpp"
 
 using json = nlohmann::json;
 
 namespace Theme {
 	void Load();
-	std::string ThemeEntry(std::string key);
+	const std::string& ThemeEntry(u64 hash, std::string_view key);
+	// Asset paths are resolved once by Load, these don't touch the filesystem
+	bool Enabled();
+	bool HasAsset(const std::string& key);
+	std::string Asset(const std::string& key, const std::string& fallback);
+	// Colours are parsed once by Load, fallback is used when the theme is off or lacks the key
+	pu::ui::Color Colour(const std::string& key, const std::string& fallbackHex);
 	inline json GetRelativeJson(json j, std::string key) {
 		std::istringstream ss(key);
 		std::string token;
@@ -22,6 +30,7 @@ namespace Theme {
 	}
 }
 
-inline std::string operator ""_theme(const char* key, size_t size) {
-	return Theme::ThemeEntry(std::string(key, size));
+template<inst::util::FixedString Key>
+inline const std::string& operator ""_theme() {
+	return Theme::ThemeEntry(inst::util::HashLiteral<Key>(), Key.view());
 }
\ No newline at end of file
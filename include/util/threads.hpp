@@ -0,0 +1,34 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <switch.h>
+
+// Core and priority layout of the app's threads. The UI keeps core 0 to itself, receiving and
+// writing an NCA each get a core of their own, everything else shares whatever is left over.
+namespace inst::threads {
+	enum class Role {
+		Ui,         // main thread, rendering and input
+		Receive,    // USB and HTTP transfer threads
+		Write,      // placeholder writes, with the NCZ decompression and re-encryption they do
+		Install,    // NCAs installed beside the one on screen
+		Background, // prefetching, placeholder collection, update checks, extraction
+		Audio,      // sound effects
+		Count
+	};
+
+	struct ThreadInfo {
+		std::string name;
+		std::string role;
+		s32 core = -1;      // preferred core, -1 when the affinity was left alone
+		u32 coreMask = 0;
+		u32 priority = 0;
+		bool applied = false;
+	};
+
+	// Names the calling thread and moves it to the cores and priority of its role. Cores and
+	// priorities the process isn't allowed to use are dropped, so this never fails.
+	void Enter(const std::string& name, Role role);
+	// Every thread that entered a role, for the install report
+	std::vector<ThreadInfo> Layout();
+}
@@ -1,3 +1,19 @@
+#pragma once
+#include <functional>
+#include <string>
+
 namespace inst::zip {
 	bool extractFile(const std::string filename, const std::string destination);
+
+	enum class StreamResult {
+		Ok,
+		DownloadFailed,
+		ExtractFailed
+	};
+
+	// Inflates the entries of a remote zip while the body is still downloading, so the archive itself never
+	// touches the SD card. Entries land in a staging directory and are only renamed into destination once
+	// every one of them checked out; beforeCommit runs right before that, a failed download leaves
+	// destination untouched.
+	StreamResult extractFromUrl(const std::string url, const std::string destination, long timeout = 5000, bool writeProgress = false, std::function<void()> beforeCommit = nullptr);
 }
\ No newline at end of file
@@ -30,6 +30,7 @@ SOFTWARE.
 #include "HDInstall.hpp"
 #include "install/install_nsp.hpp"
 #include "install/install_xci.hpp"
+#include "install/install_queue.hpp"
 #include "install/sdmc_xci.hpp"
 #include "install/sdmc_nsp.hpp"
 #include "nx/fs.hpp"
@@ -39,6 +40,7 @@ SOFTWARE.
 #include "util/config.hpp"
 #include "util/util.hpp"
 #include "util/lang.hpp"
+#include "util/telemetry.hpp"
 #include "ui/MainApplication.hpp"
 #include "ui/instPage.hpp"
 #include "util/theme.hpp"
@@ -47,11 +49,6 @@ namespace inst::ui {
 	extern MainApplication* mainApp;
 }
 
-namespace inst::ui {
-	std::string hdi_root = inst::config::appDir + "/theme";
-	bool hdi_theme = util::themeit(hdi_root); //check if we have a previous theme directory first.
-}
-
 namespace nspInstStuff_B {
 
 	void installNspFromFile(std::vector<std::filesystem::path> ourTitleList, int whereToInstall)
@@ -64,18 +61,9 @@ namespace nspInstStuff_B {
 		if (whereToInstall) m_destStorageId = NcmStorageId_BuiltInUser;
 		unsigned int titleItr;
 
-		std::string bin = "romfs:/images/icons/bin.png";
-		if (inst::ui::hdi_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json") && std::filesystem::exists(inst::config::appDir + "icons_others.bin"_theme)) {
-			bin = inst::config::appDir + "icons_others.bin"_theme;
-		}
-		std::string info = "romfs:/images/icons/information.png";
-		if (inst::ui::hdi_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json") && std::filesystem::exists(inst::config::appDir + "icons_others.information"_theme)) {
-			info = inst::config::appDir + "icons_others.information"_theme;
-		}
-		std::string fail = "romfs:/images/icons/fail.png";
-		if (inst::ui::hdi_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json") && std::filesystem::exists(inst::config::appDir + "icons_others.fail"_theme)) {
-			fail = inst::config::appDir + "icons_others.fail"_theme;
-		}
+		std::string bin = Theme::Asset("icons_others.bin", "romfs:/images/icons/bin.png");
+		std::string info = Theme::Asset("icons_others.information", "romfs:/images/icons/information.png");
+		std::string fail = Theme::Asset("icons_others.fail", "romfs:/images/icons/fail.png");
 
 		std::vector<int> previousClockValues;
 		if (inst::config::overClock) {
@@ -84,32 +72,31 @@ namespace nspInstStuff_B {
 			previousClockValues.push_back(inst::util::setClockSpeed(2, 1600000000)[0]);
 		}
 
+		u64 bytesSkipped = 0;
+		inst::telemetry::BeginReport("hdd", m_destStorageId);
 		try
 		{
 			int togo = ourTitleList.size();
-			for (titleItr = 0; titleItr < ourTitleList.size(); titleItr++) {
+			tin::install::InstallQueue installQueue(ourTitleList.size(), [&](size_t i) -> std::unique_ptr<tin::install::Install> {
+				if (ourTitleList[i].extension() == ".xci" || ourTitleList[i].extension() == ".xcz") {
+					auto sdmcXCI = std::make_shared<tin::install::xci::SDMCXCI>(ourTitleList[i]);
+					return std::make_unique<tin::install::xci::XCIInstallTask>(m_destStorageId, inst::config::ignoreReqVers, sdmcXCI);
+				}
+				auto sdmcNSP = std::make_shared<tin::install::nsp::SDMCNSP>(ourTitleList[i]);
+				return std::make_unique<tin::install::nsp::NSPInstall>(m_destStorageId, inst::config::ignoreReqVers, sdmcNSP);
+			}, true);
+
+			installQueue.Run([&](size_t i) {
+				titleItr = i;
 				auto s = std::to_string(togo);
 				inst::ui::instPage::filecount("inst.info_page.queue"_lang + s);
 				inst::ui::instPage::setTopInstInfoText("inst.info_page.top_info0"_lang + inst::util::shortenString(ourTitleList[titleItr].filename().string(), 40, true) + "inst.hd.source_string"_lang);
-				std::unique_ptr<tin::install::Install> installTask;
-
-				if (ourTitleList[titleItr].extension() == ".xci" || ourTitleList[titleItr].extension() == ".xcz") {
-					auto sdmcXCI = std::make_shared<tin::install::xci::SDMCXCI>(ourTitleList[titleItr]);
-					installTask = std::make_unique<tin::install::xci::XCIInstallTask>(m_destStorageId, inst::config::ignoreReqVers, sdmcXCI);
-				}
-				else {
-					auto sdmcNSP = std::make_shared<tin::install::nsp::SDMCNSP>(ourTitleList[titleItr]);
-					installTask = std::make_unique<tin::install::nsp::NSPInstall>(m_destStorageId, inst::config::ignoreReqVers, sdmcNSP);
-				}
-
-				LOG_DEBUG("%s\n", "Preparing installation");
 				inst::ui::instPage::setInstInfoText("inst.info_page.preparing"_lang);
 				inst::ui::instPage::setInstBarPerc(0);
-				installTask->Prepare();
-				installTask->InstallTicketCert();
-				installTask->Begin();
 				togo = (togo - 1);
-			}
+			});
+			bytesSkipped = installQueue.GetBytesSkipped();
+			inst::telemetry::EndReport(true);
 
 			inst::ui::instPage::filecount("inst.info_page.queue"_lang + "0");
 		}
@@ -117,6 +104,7 @@ namespace nspInstStuff_B {
 		{
 			LOG_DEBUG("Failed to install");
 			LOG_DEBUG("%s", e.what());
+			inst::telemetry::EndReport(false, e.what());
 			fprintf(stdout, "%s", e.what());
 			inst::ui::instPage::setInstInfoText("inst.info_page.failed"_lang + inst::util::shortenString(ourTitleList[titleItr].filename().string(), 42, true));
 			inst::ui::instPage::setInstBarPerc(0);
@@ -124,7 +112,7 @@ namespace nspInstStuff_B {
 			if (inst::config::useSound) {
 				std::string audioPath = "romfs:/audio/fail.mp3";
 				std::string fail = inst::config::appDir + "audio.fail"_theme;
-				if (inst::ui::hdi_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json") && std::filesystem::exists(fail)) audioPath = (fail);
+				if (Theme::HasAsset("audio.fail")) audioPath = (fail);
 				std::thread audioThread(inst::util::playAudio, audioPath);
 				audioThread.join();
 			}
@@ -140,13 +128,15 @@ namespace nspInstStuff_B {
 		}
 
 		if (nspInstalled) {
-			inst::ui::instPage::setInstInfoText("inst.info_page.complete"_lang);
+			std::string completeText = "inst.info_page.complete"_lang;
+			if (bytesSkipped > 0) completeText += "inst.info_page.skipped"_lang + std::to_string(bytesSkipped / 1000000) + " MB";
+			inst::ui::instPage::setInstInfoText(completeText);
 			inst::ui::instPage::setInstBarPerc(100);
 
 			if (inst::config::useSound) {
 				std::string audioPath = "romfs:/audio/pass.mp3";
 				std::string pass = inst::config::appDir + "audio.pass"_theme;
-				if (inst::ui::hdi_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json") && std::filesystem::exists(pass)) audioPath = (pass);
+				if (Theme::HasAsset("audio.pass")) audioPath = (pass);
 				std::thread audioThread(inst::util::playAudio, audioPath);
 				audioThread.join();
 			}
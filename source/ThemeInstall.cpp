@@ -43,11 +43,6 @@ namespace inst::ui {
 	extern MainApplication* mainApp;
 }
 
-namespace inst::ui {
-	std::string themei_root = inst::config::appDir + "/theme";
-	bool themei_theme = util::themeit(themei_root); //check if we have a previous theme directory first.
-}
-
 namespace ThemeInstStuff {
 
 	//Strip the filename from the url we are trying to download - ie list.txt, index.html etc...
@@ -130,18 +125,9 @@ namespace ThemeInstStuff {
 		u64 startTime = armGetSystemTick();
 		OnUnwound();
 
-		std::string info = "romfs:/images/icons/information.png";
-		if (inst::ui::themei_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json") && std::filesystem::exists(inst::config::appDir + "icons_others.information"_theme)) {
-			info = inst::config::appDir + "icons_others.information"_theme;
-		}
-		std::string fail = "romfs:/images/icons/fail.png";
-		if (inst::ui::themei_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json") && std::filesystem::exists(inst::config::appDir + "icons_others.fail"_theme)) {
-			fail = inst::config::appDir + "icons_others.fail"_theme;
-		}
-		std::string wait = "romfs:/images/icons/wait.png";
-		if (inst::ui::themei_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json") && std::filesystem::exists(inst::config::appDir + "icons_others.wait"_theme)) {
-			wait = inst::config::appDir + "icons_others.wait"_theme;
-		}
+		std::string info = Theme::Asset("icons_others.information", "romfs:/images/icons/information.png");
+		std::string fail = Theme::Asset("icons_others.fail", "romfs:/images/icons/fail.png");
+		std::string wait = Theme::Asset("icons_others.wait", "romfs:/images/icons/wait.png");
 
 		try {
 			ASSERT_OK(curl_global_init(CURL_GLOBAL_ALL), "Curl failed to initialized");
@@ -28,12 +28,13 @@ SOFTWARE.
 #include <exception>
 #include "util/error.hpp"
 #include "util/debug.h"
+#include "util/telemetry.hpp"
 
 namespace tin::data
 {
 	int NUM_BUFFER_SEGMENTS;
 
-	BufferedPlaceholderWriter::BufferedPlaceholderWriter(std::shared_ptr<nx::ncm::ContentStorage>& contentStorage, NcmContentId ncaId, size_t totalDataSize) :
+	BufferedPlaceholderWriter::BufferedPlaceholderWriter(const std::shared_ptr<nx::ncm::ContentSink>& contentStorage, NcmContentId ncaId, size_t totalDataSize) :
 		m_totalDataSize(totalDataSize), m_contentStorage(contentStorage), m_ncaId(ncaId), m_writer(ncaId, contentStorage)
 	{
 		// Though currently the number of segments is fixed, we want them allocated on the heap, not the stack
@@ -51,6 +52,7 @@ namespace tin::data
 		if (m_sizeBuffered + length > m_totalDataSize)
 			THROW_FORMAT("Cannot append data as it would exceed the expected total.\n");
 
+		u64 copyStart = armGetSystemTick();
 		size_t dataSizeRemaining = length;
 		u64 sourceOffset = 0;
 
@@ -82,11 +84,14 @@ namespace tin::data
 		}
 
 		m_sizeBuffered += length;
+		inst::telemetry::AddBusy(inst::telemetry::Stage::Buffer, copyStart, length);
 
 		if (m_sizeBuffered == m_totalDataSize)
 		{
 			m_currentFreeSegmentPtr->isFinalized = true;
 		}
+
+		this->NotifyWaiters();
 	}
 
 	bool BufferedPlaceholderWriter::CanAppendData(size_t length)
@@ -113,11 +118,17 @@ namespace tin::data
 		size_t sizeToWriteToPlaceholder = std::min(m_totalDataSize - m_sizeWrittenToPlaceholder, BUFFER_SEGMENT_DATA_SIZE);
 		m_writer.write(m_currentSegmentToWritePtr->data, sizeToWriteToPlaceholder);
 
+		// Writes out the last partial block before the placeholder counts as complete
+		if (m_sizeWrittenToPlaceholder + sizeToWriteToPlaceholder == m_totalDataSize)
+			m_writer.close();
+
 		m_currentSegmentToWritePtr->isFinalized = false;
 		m_currentSegmentToWritePtr->writeOffset = 0;
 		m_currentSegmentToWrite = (m_currentSegmentToWrite + 1) % NUM_BUFFER_SEGMENTS;
 		m_currentSegmentToWritePtr = &m_bufferSegments[m_currentSegmentToWrite];
 		m_sizeWrittenToPlaceholder += sizeToWriteToPlaceholder;
+
+		this->NotifyWaiters();
 	}
 
 	bool BufferedPlaceholderWriter::CanWriteSegmentToPlaceholder()
@@ -131,6 +142,39 @@ namespace tin::data
 		return true;
 	}
 
+	bool BufferedPlaceholderWriter::WaitToAppendData(size_t length)
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		// Data past the expected total is let through so AppendData can reject it
+		m_condition.wait(lock, [&] { return m_aborted || m_sizeBuffered + length > m_totalDataSize || this->IsSizeAvailable(length); });
+		return !m_aborted;
+	}
+
+	bool BufferedPlaceholderWriter::WaitToWriteSegment()
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_condition.wait(lock, [&] { return m_aborted || this->IsPlaceholderComplete() || this->CanWriteSegmentToPlaceholder(); });
+		return !m_aborted && this->CanWriteSegmentToPlaceholder();
+	}
+
+	void BufferedPlaceholderWriter::Abort()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_aborted = true;
+		}
+		m_condition.notify_all();
+	}
+
+	void BufferedPlaceholderWriter::NotifyWaiters()
+	{
+		// Taking the lock orders this after a waiter's last look at the segments, so the wakeup isn't lost
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+		}
+		m_condition.notify_all();
+	}
+
 	u32 BufferedPlaceholderWriter::CalcNumSegmentsRequired(size_t size)
 	{
 		if (m_currentFreeSegmentPtr->isFinalized)
@@ -31,6 +31,8 @@ SOFTWARE.
 #include "util/util.hpp"
 #include "util/lang.hpp"
 #include "ui/instPage.hpp"
+#include "util/telemetry.hpp"
+#include "util/threads.hpp"
 
 namespace tin::install::nsp
 {
@@ -52,38 +54,52 @@ namespace tin::install::nsp
 
 	int CurlStreamFunc(void* in)
 	{
+		inst::threads::Enter("http-receive", inst::threads::Role::Receive);
 		StreamFuncArgs* args = reinterpret_cast<StreamFuncArgs*>(in);
 
+		// Source time is whatever curl spends between two callbacks
+		u64 sourceStart = armGetSystemTick();
 		auto streamFunc = [&](u8* streamBuf, size_t streamBufSize) -> size_t
 			{
-				while (true)
-				{
-					if (args->bufferedPlaceholderWriter->CanAppendData(streamBufSize))
-						break;
-				}
+				inst::telemetry::AddBusy(inst::telemetry::Stage::Source, sourceStart, streamBufSize);
+
+				u64 waitStart = armGetSystemTick();
+				if (!args->bufferedPlaceholderWriter->WaitToAppendData(streamBufSize))
+					return 0;
+				inst::telemetry::AddWait(inst::telemetry::Stage::Source, waitStart);
 
 				args->bufferedPlaceholderWriter->AppendData(streamBuf, streamBufSize);
+				inst::ui::instPage::publishBuffered(args->bufferedPlaceholderWriter->GetSizeBuffered());
+				sourceStart = armGetSystemTick();
 				return streamBufSize;
 			};
 
-		if (args->download->StreamDataRange(args->pfs0Offset, args->ncaSize, streamFunc) == 1) stopThreadsHttpNsp = true;
+		if (args->download->StreamDataRange(args->pfs0Offset, args->ncaSize, streamFunc) == 1)
+		{
+			stopThreadsHttpNsp = true;
+			args->bufferedPlaceholderWriter->Abort();
+		}
 		return 0;
 	}
 
 	int PlaceholderWriteFunc(void* in)
 	{
+		inst::threads::Enter("http-write", inst::threads::Role::Write);
 		StreamFuncArgs* args = reinterpret_cast<StreamFuncArgs*>(in);
 
-		while (!args->bufferedPlaceholderWriter->IsPlaceholderComplete() && !stopThreadsHttpNsp)
+		u64 waitStart = armGetSystemTick();
+		while (args->bufferedPlaceholderWriter->WaitToWriteSegment())
 		{
-			if (args->bufferedPlaceholderWriter->CanWriteSegmentToPlaceholder())
-				args->bufferedPlaceholderWriter->WriteSegmentToPlaceholder();
+			inst::telemetry::AddWait(inst::telemetry::Stage::Placeholder, waitStart);
+			args->bufferedPlaceholderWriter->WriteSegmentToPlaceholder();
+			waitStart = armGetSystemTick();
+			inst::ui::instPage::publishWritten(args->bufferedPlaceholderWriter->GetSizeWrittenToPlaceholder());
 		}
 
 		return 0;
 	}
 
-	void HTTPNSP::StreamToPlaceholder(std::shared_ptr<nx::ncm::ContentStorage>& contentStorage, NcmContentId placeholderId)
+	void HTTPNSP::StreamToPlaceholder(const std::shared_ptr<nx::ncm::ContentSink>& contentStorage, NcmContentId placeholderId)
 	{
 		const PFS0FileEntry* fileEntry = this->GetFileEntryByNcaId(placeholderId);
 		std::string ncaFileName = this->GetFileEntryName(fileEntry);
@@ -100,51 +116,19 @@ namespace tin::install::nsp
 		thrd_t curlThread;
 		thrd_t writeThread;
 
+		inst::ui::instPage::beginProgress(true, ncaFileName, ncaSize);
 		stopThreadsHttpNsp = false;
 		thrd_create(&curlThread, CurlStreamFunc, &args);
 		thrd_create(&writeThread, PlaceholderWriteFunc, &args);
 
-		u64 freq = armGetSystemTickFreq();
-		u64 startTime = armGetSystemTick();
-		size_t startSizeBuffered = 0;
-		double speed = 0.0;
-
-		inst::ui::instPage::setInstBarPerc(0);
 		while (!bufferedPlaceholderWriter.IsBufferDataComplete() && !stopThreadsHttpNsp)
-		{
-			u64 newTime = armGetSystemTick();
-
-			if (newTime - startTime >= freq * 0.5)
-			{
-				size_t newSizeBuffered = bufferedPlaceholderWriter.GetSizeBuffered();
-				double mbBuffered = (newSizeBuffered / 1000000.0) - (startSizeBuffered / 1000000.0);
-				double duration = ((double)(newTime - startTime) / (double)freq);
-				speed = mbBuffered / duration;
-
-				startTime = newTime;
-				startSizeBuffered = newSizeBuffered;
-
-				int downloadProgress = (int)(((double)bufferedPlaceholderWriter.GetSizeBuffered() / (double)bufferedPlaceholderWriter.GetTotalDataSize()) * 100.0);
-
-				inst::ui::instPage::setInstInfoText("inst.info_page.downloading"_lang + inst::util::formatUrlString(ncaFileName) + "inst.info_page.at"_lang + std::to_string(speed).substr(0, std::to_string(speed).size() - 4) + "MB/s");
-				inst::ui::instPage::setInstBarPerc((double)downloadProgress);
-			}
-		}
+			inst::ui::instPage::pumpProgress();
 		inst::ui::instPage::setInstBarPerc(100);
 
-		//inst::ui::instPage::setInstInfoText("inst.info_page.top_info0"_lang + ncaFileName + "...");
-		inst::ui::instPage::setInstBarPerc(0);
+		inst::ui::instPage::beginInstallStage();
 		while (!bufferedPlaceholderWriter.IsPlaceholderComplete() && !stopThreadsHttpNsp)
-		{
-			int installProgress = (int)(((double)bufferedPlaceholderWriter.GetSizeWrittenToPlaceholder() / (double)bufferedPlaceholderWriter.GetTotalDataSize()) * 100.0);
-
-			inst::ui::instPage::setInstBarPerc((double)installProgress);
-			//
-			std::stringstream x;
-			x << (int)(installProgress);
-			inst::ui::instPage::setInstInfoText("inst.info_page.top_info0"_lang + ncaFileName + " " + x.str() + "%");
-		}
-		inst::ui::instPage::setInstBarPerc(100);
+			inst::ui::instPage::pumpProgress();
+		inst::ui::instPage::endProgress();
 
 		thrd_join(curlThread, NULL);
 		thrd_join(writeThread, NULL);
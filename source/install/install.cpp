@@ -27,10 +27,49 @@ SOFTWARE.
 #include <cstring>
 #include <sstream>
 #include <memory>
+#include <mutex>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <thread>
 #include "util/error.hpp"
 
 #include "nx/ncm.hpp"
+#include "nx/nca_writer.h"
 #include "util/title_util.hpp"
+#include "util/config.hpp"
+#include "util/crypto.hpp"
+#include "util/journal.hpp"
+#include "util/threads.hpp"
+#include "ui/instPage.hpp"
+
+namespace
+{
+	// Install tasks may overlap when queued, so only the first one in enables
+	// media playback state and only the last one out clears it
+	std::mutex g_mediaPlaybackMutex;
+	int g_mediaPlaybackRefs = 0;
+
+	// Largest read ReadNcaHeaders makes to pick up several headers at once
+	const u64 g_headerReadSpan = 0x400000;
+
+	// Budget for NCAs streaming at the same time, shared by every install task
+	const size_t g_maxConcurrentNcas = 3;
+	const u64 g_streamMemoryBudget = 0x4000000;
+	std::mutex g_streamMutex;
+	std::condition_variable g_streamCondition;
+	size_t g_streamCount = 0;
+	u64 g_streamMemory = 0;
+
+	// Read buffer and write block, plus the two NCZ buffers in case the NCA is compressed.
+	// None of them grow past the size of the NCA, so small NCAs cost little.
+	u64 EstimateStreamMemory(u64 ncaSize, u64 writeBlockSize)
+	{
+		return std::min<u64>(ncaSize, 0x400000) + std::min(ncaSize, writeBlockSize) + 2 * std::min<u64>(ncaSize, 0x1000000);
+	}
+}
 
 
 // TODO: Check NCA files are present
@@ -40,40 +79,79 @@ namespace tin::install
 	Install::Install(NcmStorageId destStorageId, bool ignoreReqFirmVersion) :
 		m_destStorageId(destStorageId), m_ignoreReqFirmVersion(ignoreReqFirmVersion), m_contentMeta()
 	{
-		appletSetMediaPlaybackState(true);
+		std::lock_guard<std::mutex> lock(g_mediaPlaybackMutex);
+		if (g_mediaPlaybackRefs++ == 0)
+			appletSetMediaPlaybackState(true);
 	}
 
 	Install::~Install()
 	{
-		appletSetMediaPlaybackState(false);
+		std::lock_guard<std::mutex> lock(g_mediaPlaybackMutex);
+		if (--g_mediaPlaybackRefs == 0)
+			appletSetMediaPlaybackState(false);
 	}
 
-	// TODO: Implement RAII on NcmContentMetaDatabase
-	void Install::InstallContentMetaRecords(tin::data::ByteBuffer& installContentMetaBuf, int i)
+	void Install::PrefetchCNMT()
 	{
-		NcmContentMetaDatabase contentMetaDatabase;
-		NcmContentMetaKey contentMetaKey = m_contentMeta[i].GetContentMetaKey();
+	}
 
-		try
+	bool Install::ReadPrefetchedNCA(const NcmContentId& ncaId, void* buf, size_t size)
+	{
+		auto it = m_prefetchedNcas.find(tin::util::GetNcaIdString(ncaId));
+		if (it == m_prefetchedNcas.end() || it->second.size() < size)
+			return false;
+
+		memcpy(buf, it->second.data(), size);
+		return true;
+	}
+
+	bool Install::WritePrefetchedNCA(const std::shared_ptr<nx::ncm::ContentSink>& contentStorage, const NcmContentId& ncaId)
+	{
+		auto it = m_prefetchedNcas.find(tin::util::GetNcaIdString(ncaId));
+		if (it == m_prefetchedNcas.end())
+			return false;
+
+		LOG_DEBUG("Writing prefetched %s\n", it->first.c_str());
+		NcaWriter writer(ncaId, contentStorage);
+		writer.write(it->second.data(), it->second.size());
+		writer.close();
+
+		m_prefetchedNcas.erase(it);
+		return true;
+	}
+
+	void Install::InstallContentMetaRecords(std::vector<tin::data::ByteBuffer>& installContentMetaBufs)
+	{
+		auto contentMetaDatabase = nx::ncm::GetContentMetaDatabase(m_destStorageId);
+
+		for (size_t i = 0; i < installContentMetaBufs.size(); i++)
 		{
-			ASSERT_OK(ncmOpenContentMetaDatabase(&contentMetaDatabase, m_destStorageId), "Failed to open content meta database");
-			ASSERT_OK(ncmContentMetaDatabaseSet(&contentMetaDatabase, &contentMetaKey, (NcmContentMetaHeader*)installContentMetaBuf.GetData(), installContentMetaBuf.GetSize()), "Failed to set content records");
-			ASSERT_OK(ncmContentMetaDatabaseCommit(&contentMetaDatabase), "Failed to commit content records");
+			NcmContentMetaKey contentMetaKey = m_contentMeta[i].GetContentMetaKey();
+			contentMetaDatabase->Set(contentMetaKey, installContentMetaBufs[i].GetData(), installContentMetaBufs[i].GetSize());
 		}
-		catch (std::runtime_error& e)
+		contentMetaDatabase->Commit();
+	}
+
+	void Install::InstallApplicationRecords()
+	{
+		// A bundle of base, update and DLCs shares one base title, and so one application record
+		std::map<u64, std::vector<ContentStorageRecord>> newRecords;
+		for (size_t i = 0; i < m_contentMeta.size(); i++)
 		{
-			serviceClose(&contentMetaDatabase.s);
-			THROW_FORMAT(e.what());
+			ContentStorageRecord storageRecord;
+			storageRecord.metaRecord = m_contentMeta[i].GetContentMetaKey();
+			storageRecord.storageId = m_destStorageId;
+			newRecords[tin::util::GetBaseTitleId(this->GetTitleId(i), this->GetContentMetaType(i))].push_back(storageRecord);
 		}
 
-		serviceClose(&contentMetaDatabase.s);
+		for (auto& [baseTitleId, records] : newRecords)
+			this->PushApplicationRecord(baseTitleId, records);
 	}
 
-	void Install::InstallApplicationRecord(int i)
+	void Install::PushApplicationRecord(u64 baseTitleId, const std::vector<ContentStorageRecord>& newRecords)
 	{
 		Result rc = 0;
 		std::vector<ContentStorageRecord> storageRecords;
-		u64 baseTitleId = tin::util::GetBaseTitleId(this->GetTitleId(i), this->GetContentMetaType(i));
 		s32 contentMetaCount = 0;
 
 		LOG_DEBUG("Base title Id: 0x%lx", baseTitleId);
@@ -107,10 +185,7 @@ namespace tin::install
 		}
 
 		// Add our new content meta
-		ContentStorageRecord storageRecord;
-		storageRecord.metaRecord = m_contentMeta[i].GetContentMetaKey();
-		storageRecord.storageId = m_destStorageId;
-		storageRecords.push_back(storageRecord);
+		storageRecords.insert(storageRecords.end(), newRecords.begin(), newRecords.end());
 
 		// Replace the existing application records with our own
 		try
@@ -126,19 +201,25 @@ namespace tin::install
 	// Validate and obtain all data needed for install
 	void Install::Prepare()
 	{
-		tin::data::ByteBuffer cnmtBuf;
-
 		std::vector<std::tuple<nx::ncm::ContentMeta, NcmContentInfo>> tupelList = this->ReadCNMT();
+		std::vector<NcmContentId> ncaIds;
 
-		for (size_t i = 0; i < tupelList.size(); i++) {
-			std::tuple<nx::ncm::ContentMeta, NcmContentInfo> cnmtTuple = tupelList[i];
-
+		for (auto& cnmtTuple : tupelList) {
 			m_contentMeta.push_back(std::get<0>(cnmtTuple));
-			NcmContentInfo cnmtContentRecord = std::get<1>(cnmtTuple);
 
-			nx::ncm::ContentStorage contentStorage(m_destStorageId);
+			ncaIds.push_back(std::get<1>(cnmtTuple).content_id);
+			for (auto& record : std::get<0>(cnmtTuple).GetContentInfos())
+				ncaIds.push_back(record.content_id);
+		}
+
+		// Settle NCA signature validation for the whole title before anything is transferred
+		this->ValidateNcaHeaders(ncaIds);
 
-			if (!contentStorage.Has(cnmtContentRecord.content_id))
+		std::vector<tin::data::ByteBuffer> installContentMetaBufs(tupelList.size());
+		for (size_t i = 0; i < tupelList.size(); i++) {
+			NcmContentInfo cnmtContentRecord = std::get<1>(tupelList[i]);
+
+			if (!nx::ncm::GetContentStorage(m_destStorageId)->Has(cnmtContentRecord.content_id))
 			{
 				LOG_DEBUG("Installing CNMT NCA...\n");
 				this->InstallNCA(cnmtContentRecord.content_id);
@@ -152,24 +233,278 @@ namespace tin::install
 			if (m_ignoreReqFirmVersion)
 				LOG_DEBUG("WARNING: Required system firmware version is being IGNORED!\n");
 
-			tin::data::ByteBuffer installContentMetaBuf;
-			m_contentMeta[i].GetInstallContentMeta(installContentMetaBuf, cnmtContentRecord, m_ignoreReqFirmVersion);
+			m_contentMeta[i].GetInstallContentMeta(installContentMetaBufs[i], cnmtContentRecord, m_ignoreReqFirmVersion);
+		}
+
+		this->InstallContentMetaRecords(installContentMetaBufs);
+		this->InstallApplicationRecords();
+	}
+
+	// Headers that lie close together in the package, like those of the small control, legal and
+	// meta NCAs, are fetched with a single read. Reading everything at once would also pull in
+	// the bodies between them, so headers further apart than g_headerReadSpan get a read of their own.
+	void Install::ReadNcaHeaders(const std::vector<NcmContentId>& ncaIds, std::vector<NcaHeader>& headers)
+	{
+		std::vector<std::tuple<u64, size_t>> sourceHeaders;
+		for (size_t i = 0; i < ncaIds.size(); i++)
+		{
+			u64 offset = 0;
+			if (this->ReadPrefetchedNCA(ncaIds[i], &headers[i], sizeof(NcaHeader)))
+				continue;
+			if (this->GetNcaSourceOffset(ncaIds[i], &offset))
+				sourceHeaders.push_back({ offset, i });
+			else
+				this->ReadNcaHeader(ncaIds[i], &headers[i]);
+		}
+
+		std::sort(sourceHeaders.begin(), sourceHeaders.end());
+		std::vector<u8> span;
+
+		for (size_t first = 0; first < sourceHeaders.size();)
+		{
+			u64 start = std::get<0>(sourceHeaders[first]);
+			size_t last = first;
+			while (last + 1 < sourceHeaders.size() && std::get<0>(sourceHeaders[last + 1]) + sizeof(NcaHeader) - start <= g_headerReadSpan)
+				last++;
+
+			u64 size = std::get<0>(sourceHeaders[last]) + sizeof(NcaHeader) - start;
+			span.resize(size);
+			this->ReadSource(span.data(), start, size);
+
+			for (size_t i = first; i <= last; i++)
+				memcpy(&headers[std::get<1>(sourceHeaders[i])], span.data() + std::get<0>(sourceHeaders[i]) - start, sizeof(NcaHeader));
 
-			this->InstallContentMetaRecords(installContentMetaBuf, i);
-			this->InstallApplicationRecord(i);
+			first = last + 1;
+		}
+	}
+
+	// Fetches every header first, then verifies the signatures on worker threads so
+	// the user is asked about unsigned content at most once, before the install starts
+	void Install::ValidateNcaHeaders(const std::vector<NcmContentId>& ncaIds)
+	{
+		if (!inst::config::validateNCAs || m_declinedValidation || ncaIds.empty())
+			return;
+
+		std::vector<NcaHeader> headers(ncaIds.size());
+		this->ReadNcaHeaders(ncaIds, headers);
+
+		std::vector<u8> badMagic(ncaIds.size(), 0);
+		std::vector<u8> badSignature(ncaIds.size(), 0);
+		std::atomic<size_t> next(0);
+
+		auto verify = [&]() {
+			Crypto::HeaderXtsLease crypto(false);
+			for (size_t i = next++; i < headers.size(); i = next++)
+			{
+				crypto->decrypt(&headers[i], &headers[i], sizeof(NcaHeader), 0, 0x200);
+
+				if (headers[i].magic != MAGIC_NCA3)
+					badMagic[i] = 1;
+				else if (!Crypto::rsa2048PssVerify(&headers[i].magic, 0x200, headers[i].fixed_key_sig, Crypto::NCAHeaderSignature))
+					badSignature[i] = 1;
+			}
+		};
+
+		// Take the key derivation out of the workers before they start
+		Crypto::Keys::Get();
+
+		size_t workerCount = std::min<size_t>(ncaIds.size(), 3);
+		std::vector<std::thread> workers;
+		for (size_t i = 1; i < workerCount; i++)
+			workers.emplace_back(verify);
+		verify();
+		for (auto& worker : workers)
+			worker.join();
+
+		for (size_t i = 0; i < ncaIds.size(); i++)
+		{
+			if (badMagic[i])
+				THROW_FORMAT("Invalid NCA magic");
+		}
+
+		for (size_t i = 0; i < ncaIds.size(); i++)
+		{
+			if (badSignature[i])
+			{
+				this->ConfirmInvalidNcaSignature(ncaIds[i]);
+				m_declinedValidation = true;
+				break;
+			}
+		}
+
+		m_ncaHeadersValidated = true;
+	}
+
+	// Checks whether an NCA is already registered with the expected size. The content id is
+	// the first half of the NCA's SHA-256, so the full hash is only checked when validating NCAs.
+	bool Install::IsContentPresent(nx::ncm::ContentStorage& contentStorage, const nx::ncm::PackagedContentInfo& contentInfo)
+	{
+		const NcmContentId& ncaId = contentInfo.content_info.content_id;
+		u64 expectedSize = 0;
+		ncmContentInfoSizeToU64(&contentInfo.content_info, &expectedSize);
+
+		try
+		{
+			if (!contentStorage.Has(ncaId) || (u64)contentStorage.GetSize(ncaId) != expectedSize)
+				return false;
+
+			if (!inst::config::validateNCAs)
+				return true;
+
+			const size_t readSize = 0x400000;
+			auto readBuffer = std::make_unique<u8[]>(readSize);
+			Sha256Context sha256;
+			sha256ContextCreate(&sha256);
+
+			// Hashing a big NCA takes a while, show it like an install
+			inst::ui::instPage::beginCheckProgress(tin::util::GetNcaIdString(ncaId) + ".nca", expectedSize);
+			for (u64 offset = 0; offset < expectedSize;)
+			{
+				inst::ui::instPage::publishWritten(offset);
+				inst::ui::instPage::pumpProgress(false);
+
+				size_t chunk = std::min<u64>(readSize, expectedSize - offset);
+				contentStorage.Read(ncaId, offset, readBuffer.get(), chunk);
+				sha256ContextUpdate(&sha256, readBuffer.get(), chunk);
+				offset += chunk;
+			}
+			inst::ui::instPage::endProgress();
+
+			u8 hash[SHA256_HASH_SIZE];
+			sha256ContextGetHash(&sha256, hash);
+			return memcmp(hash, contentInfo.hash, sizeof(hash)) == 0;
+		}
+		catch (std::exception& e)
+		{
+			LOG_DEBUG("Failed to check installed NCA: %s\n", e.what());
+			return false;
 		}
 	}
 
 	void Install::Begin()
 	{
+		auto contentStorage = nx::ncm::GetContentStorage(m_destStorageId);
+		std::vector<std::tuple<NcmContentId, u64>> ncas;
+
 		for (nx::ncm::ContentMeta contentMeta : m_contentMeta) {
-			LOG_DEBUG("Installing NCAs...\n");
-			for (auto& record : contentMeta.GetContentInfos())
+			for (auto& packagedContentInfo : contentMeta.GetPackagedContentInfos())
 			{
-				LOG_DEBUG("Installing from %s\n", tin::util::GetNcaIdString(record.content_id).c_str());
-				this->InstallNCA(record.content_id);
+				const NcmContentInfo& record = packagedContentInfo.content_info;
+				u64 size = 0;
+				ncmContentInfoSizeToU64(&record, &size);
+
+				if (this->IsContentPresent(*contentStorage, packagedContentInfo))
+				{
+					LOG_DEBUG("%s is already installed, skipping\n", tin::util::GetNcaIdString(record.content_id).c_str());
+					m_bytesSkipped += size;
+					continue;
+				}
+
+				ncas.push_back({ record.content_id, size });
 			}
 		}
+
+		LOG_DEBUG("Installing NCAs...\n");
+		try
+		{
+			if (ncas.size() > 1 && this->CanInstallNCAsConcurrently())
+			{
+				this->InstallNCAsConcurrently(ncas, contentStorage->GetWriteBlockSize());
+			}
+			else
+			{
+				for (auto& [ncaId, size] : ncas)
+				{
+					LOG_DEBUG("Installing from %s\n", tin::util::GetNcaIdString(ncaId).c_str());
+					this->InstallNCA(ncaId);
+				}
+			}
+		}
+		catch (...)
+		{
+			// The NCAs that did finish shouldn't stay on record either way
+			inst::journal::Flush();
+			throw;
+		}
+		inst::journal::Flush();
+	}
+
+	// The calling thread works through the NCAs from the largest down and keeps the progress on
+	// screen, workers take the smallest ones beside it, so the control and manual NCAs don't queue
+	// behind the program NCA. An NCA only starts once it fits the stream budget, unless nothing is streaming.
+	void Install::InstallNCAsConcurrently(std::vector<std::tuple<NcmContentId, u64>> ncas, u64 writeBlockSize)
+	{
+		std::sort(ncas.begin(), ncas.end(), [](const auto& a, const auto& b) {
+			return std::get<1>(a) > std::get<1>(b);
+		});
+
+		std::deque<std::tuple<NcmContentId, u64>> queue(ncas.begin(), ncas.end());
+		std::exception_ptr error;
+
+		auto run = [&](bool largest) {
+			while (true)
+			{
+				NcmContentId ncaId;
+				u64 memory;
+				{
+					std::unique_lock<std::mutex> lock(g_streamMutex);
+					while (true)
+					{
+						if (error || queue.empty())
+							return;
+
+						memory = EstimateStreamMemory(std::get<1>(largest ? queue.front() : queue.back()), writeBlockSize);
+						if (!g_streamCount || (g_streamCount < g_maxConcurrentNcas && g_streamMemory + memory <= g_streamMemoryBudget))
+							break;
+
+						g_streamCondition.wait(lock);
+					}
+
+					ncaId = std::get<0>(largest ? queue.front() : queue.back());
+					if (largest)
+						queue.pop_front();
+					else
+						queue.pop_back();
+					g_streamCount++;
+					g_streamMemory += memory;
+				}
+
+				try
+				{
+					LOG_DEBUG("Installing from %s\n", tin::util::GetNcaIdString(ncaId).c_str());
+					this->InstallNCA(ncaId);
+				}
+				catch (...)
+				{
+					std::lock_guard<std::mutex> lock(g_streamMutex);
+					if (!error)
+						error = std::current_exception();
+				}
+
+				{
+					std::lock_guard<std::mutex> lock(g_streamMutex);
+					g_streamCount--;
+					g_streamMemory -= memory;
+				}
+				g_streamCondition.notify_all();
+			}
+		};
+
+		size_t workerCount = std::min(ncas.size(), g_maxConcurrentNcas) - 1;
+		std::vector<std::thread> workers;
+		for (size_t i = 0; i < workerCount; i++)
+		{
+			workers.emplace_back([&run, i]() {
+				inst::threads::Enter("install-" + std::to_string(i + 1), inst::threads::Role::Install);
+				run(false);
+			});
+		}
+		run(true);
+		for (auto& worker : workers)
+			worker.join();
+
+		if (error)
+			std::rethrow_exception(error);
 	}
 
 	void Install::InstallTicketCert() {
@@ -185,4 +520,9 @@ namespace tin::install
 	{
 		return static_cast<NcmContentMetaType>(m_contentMeta[i].GetContentMetaKey().type);
 	}
+
+	u64 Install::GetBytesSkipped()
+	{
+		return m_bytesSkipped;
+	}
 }
@@ -39,6 +39,8 @@ SOFTWARE.
 #include "util/error.hpp"
 #include "util/util.hpp"
 #include "util/lang.hpp"
+#include "util/telemetry.hpp"
+#include "util/journal.hpp"
 #include "ui/MainApplication.hpp"
 #include "util/theme.hpp"
 
@@ -46,11 +48,6 @@ namespace inst::ui {
 	extern MainApplication* mainApp;
 }
 
-namespace inst::ui {
-	std::string nspi_root = inst::config::appDir + "/theme";
-	bool nspi_theme = util::themeit(nspi_root); //check if we have a previous theme directory first.
-}
-
 namespace tin::install::nsp
 {
 	NSPInstall::NSPInstall(NcmStorageId destStorageId, bool ignoreReqFirmVersion, const std::shared_ptr<NSP>& remoteNSP) :
@@ -63,18 +60,30 @@ namespace tin::install::nsp
 	{
 		std::vector<std::tuple<nx::ncm::ContentMeta, NcmContentInfo>> CNMTList;
 
+		// Pull the CNMT NCAs into memory unless the install queue already did
+		this->PrefetchCNMT();
+
 		for (const PFS0FileEntry* fileEntry : m_NSP->GetFileEntriesByExtension("cnmt.nca")) {
 			std::string cnmtNcaName(m_NSP->GetFileEntryName(fileEntry));
 			NcmContentId cnmtContentId = tin::util::GetNcaIdFromString(cnmtNcaName);
 			size_t cnmtNcaSize = fileEntry->fileSize;
 
-			nx::ncm::ContentStorage contentStorage(m_destStorageId);
-
 			LOG_DEBUG("CNMT Name: %s\n", cnmtNcaName.c_str());
 
-			// We install the cnmt nca early to read from it later
-			this->InstallNCA(cnmtContentId);
-			std::string cnmtNCAFullPath = contentStorage.GetPath(cnmtContentId);
+			// Parse the cnmt from memory, the NCA itself is installed by Prepare
+			nx::ncm::ContentMeta contentMeta;
+			try
+			{
+				contentMeta = tin::util::GetContentMetaFromNCA(m_prefetchedNcas[tin::util::GetNcaIdString(cnmtContentId)]);
+			}
+			catch (std::exception& e)
+			{
+				LOG_DEBUG("Failed to parse CNMT in memory: %s\n", e.what());
+
+				// Fall back to installing the cnmt nca early to read from it
+				this->InstallNCA(cnmtContentId);
+				contentMeta = tin::util::GetContentMetaFromNCA(nx::ncm::GetContentStorage(m_destStorageId)->GetPath(cnmtContentId));
+			}
 
 			NcmContentInfo cnmtContentInfo;
 			cnmtContentInfo.content_id = cnmtContentId;
@@ -82,11 +91,64 @@ namespace tin::install::nsp
 			ncmU64ToContentInfoSize(cnmtNcaSize & 0xFFFFFFFFFFFF, &cnmtContentInfo);
 			cnmtContentInfo.content_type = NcmContentType_Meta;
 
-			CNMTList.push_back({ tin::util::GetContentMetaFromNCA(cnmtNCAFullPath), cnmtContentInfo });
+			CNMTList.push_back({ contentMeta, cnmtContentInfo });
 		}
 		return CNMTList;
 	}
 
+	void NSPInstall::PrefetchCNMT()
+	{
+		for (const PFS0FileEntry* fileEntry : m_NSP->GetFileEntriesByExtension("cnmt.nca")) {
+			NcmContentId cnmtContentId = tin::util::GetNcaIdFromString(m_NSP->GetFileEntryName(fileEntry));
+			if (m_prefetchedNcas.count(tin::util::GetNcaIdString(cnmtContentId)))
+				continue;
+
+			std::vector<u8> cnmtBuf(fileEntry->fileSize);
+
+			LOG_DEBUG("Prefetching %s\n", m_NSP->GetFileEntryName(fileEntry));
+			m_NSP->BufferData(cnmtBuf.data(), m_NSP->GetDataOffset() + fileEntry->dataOffset, cnmtBuf.size());
+			m_prefetchedNcas[tin::util::GetNcaIdString(cnmtContentId)] = std::move(cnmtBuf);
+		}
+	}
+
+	void NSPInstall::ReadNcaHeader(const NcmContentId& ncaId, tin::install::NcaHeader* header)
+	{
+		if (this->ReadPrefetchedNCA(ncaId, header, sizeof(tin::install::NcaHeader)))
+			return;
+
+		const PFS0FileEntry* fileEntry = m_NSP->GetFileEntryByNcaId(ncaId);
+		if (fileEntry == nullptr)
+			THROW_FORMAT("NCA %s is missing from the package", tin::util::GetNcaIdString(ncaId).c_str());
+
+		m_NSP->BufferData(header, m_NSP->GetDataOffset() + fileEntry->dataOffset, sizeof(tin::install::NcaHeader));
+	}
+
+	bool NSPInstall::GetNcaSourceOffset(const NcmContentId& ncaId, u64* offset)
+	{
+		auto fileEntry = m_NSP->GetFileEntryByNcaId(ncaId);
+		if (fileEntry == nullptr)
+			return false;
+
+		*offset = m_NSP->GetDataOffset() + fileEntry->dataOffset;
+		return true;
+	}
+
+	void NSPInstall::ReadSource(void* buf, u64 offset, size_t size)
+	{
+		m_NSP->BufferData(buf, offset, size);
+	}
+
+	void NSPInstall::ConfirmInvalidNcaSignature(const NcmContentId& ncaId)
+	{
+		std::string audioPath = Theme::Asset("audio.infobeep", "romfs:/audio/infobeep.mp3");
+		std::thread audioThread(inst::util::playAudio, audioPath);
+		std::string information = Theme::Asset("icons_others.information", "romfs:/images/icons/information.png");
+		int rc = inst::ui::mainApp->CreateShowDialog("inst.nca_verify.title"_lang, "inst.nca_verify.desc"_lang, { "common.cancel"_lang, "inst.nca_verify.opt1"_lang }, false, information);
+		audioThread.join();
+		if (rc != 1)
+			THROW_FORMAT(("inst.nca_verify.error"_lang + tin::util::GetNcaIdString(ncaId)).c_str());
+	}
+
 	void NSPInstall::InstallNCA(const NcmContentId& ncaId)
 	{
 		const PFS0FileEntry* fileEntry = m_NSP->GetFileEntryByNcaId(ncaId);
@@ -97,13 +159,17 @@ namespace tin::install::nsp
 		LOG_DEBUG("Installing %s to storage Id %u\n", ncaFileName.c_str(), m_destStorageId);
 #endif
 
-		std::shared_ptr<nx::ncm::ContentStorage> contentStorage(new nx::ncm::ContentStorage(m_destStorageId));
+		std::shared_ptr<nx::ncm::ContentStorage> contentStorage = nx::ncm::GetContentStorage(m_destStorageId);
 
-		// Attempt to delete any leftover placeholders
-		try {
-			contentStorage->DeletePlaceholder(*(NcmPlaceHolderId*)&ncaId);
+		// Attempt to delete any leftover placeholders, unless the source can resume writing one
+		if (!m_NSP->CanResume() || !inst::journal::GetResumeOffset(ncaId, fileEntry->fileSize))
+		{
+			try {
+				contentStorage->DeletePlaceholder(*(NcmPlaceHolderId*)&ncaId);
+			}
+			catch (...) {}
+			inst::journal::Remove(ncaId);
 		}
-		catch (...) {}
 		// Attempt to delete leftover ncas
 		try {
 			contentStorage->Delete(ncaId);
@@ -112,13 +178,14 @@ namespace tin::install::nsp
 
 		LOG_DEBUG("Size: 0x%lx\n", ncaSize);
 
-		if (inst::config::validateNCAs && !m_declinedValidation)
+		// Normally Prepare has already checked every header of the title
+		if (inst::config::validateNCAs && !m_declinedValidation && !m_ncaHeadersValidated)
 		{
 			tin::install::NcaHeader* header = new NcaHeader;
-			m_NSP->BufferData(header, m_NSP->GetDataOffset() + fileEntry->dataOffset, sizeof(tin::install::NcaHeader));
+			this->ReadNcaHeader(ncaId, header);
 
-			Crypto::AesXtr crypto(Crypto::Keys().headerKey, false);
-			crypto.decrypt(header, header, sizeof(tin::install::NcaHeader), 0, 0x200);
+			Crypto::HeaderXtsLease crypto(false);
+			crypto->decrypt(header, header, sizeof(tin::install::NcaHeader), 0, 0x200);
 			//https://gbatemp.net/threads/nszip-nsp-compressor-decompressor-to-reduce-storage.530313/
 
 			if (header->magic != MAGIC_NCA3)
@@ -126,24 +193,17 @@ namespace tin::install::nsp
 
 			if (!Crypto::rsa2048PssVerify(&header->magic, 0x200, header->fixed_key_sig, Crypto::NCAHeaderSignature))
 			{
-				std::string audioPath = "romfs:/audio/infobeep.mp3";
-				std::string beep = inst::config::appDir + "audio.infobeep"_theme;
-				if (inst::ui::nspi_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json") && std::filesystem::exists(beep)) audioPath = (beep);
-				std::thread audioThread(inst::util::playAudio, audioPath);
-				std::string information = "romfs:/images/icons/information.png";
-				if (inst::ui::nspi_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json") && std::filesystem::exists(inst::config::appDir + "icons_others.information"_theme)) {
-					information = inst::config::appDir + "icons_others.information"_theme;
-				}
-				int rc = inst::ui::mainApp->CreateShowDialog("inst.nca_verify.title"_lang, "inst.nca_verify.desc"_lang, { "common.cancel"_lang, "inst.nca_verify.opt1"_lang }, false, information);
-				audioThread.join();
-				if (rc != 1)
-					THROW_FORMAT(("inst.nca_verify.error"_lang + tin::util::GetNcaIdString(ncaId)).c_str());
+				this->ConfirmInvalidNcaSignature(ncaId);
 				m_declinedValidation = true;
 			}
 			delete header;
 		}
 
-		m_NSP->StreamToPlaceholder(contentStorage, ncaId);
+		{
+			inst::telemetry::NcaScope telemetryScope(ncaFileName, fileEntry->fileSize);
+			if (!this->WritePrefetchedNCA(contentStorage, ncaId))
+				m_NSP->StreamToPlaceholder(contentStorage, ncaId);
+		}
 
 		LOG_DEBUG("Registering placeholder...\n");
 
@@ -155,6 +215,7 @@ namespace tin::install::nsp
 		{
 			LOG_DEBUG(("Failed to register " + ncaFileName + ". It may already exist.\n").c_str());
 		}
+		inst::journal::Remove(ncaId);
 
 		try
 		{
@@ -163,6 +224,11 @@ namespace tin::install::nsp
 		catch (...) {}
 	}
 
+	bool NSPInstall::CanInstallNCAsConcurrently()
+	{
+		return m_NSP->CanReadConcurrently();
+	}
+
 	void NSPInstall::InstallTicketCert()
 	{
 		//int cal = 0;
@@ -178,10 +244,7 @@ namespace tin::install::nsp
 			ss << *it;
 		}
 		if (ss.str().length() == 0) {
-			std::string info = "romfs:/images/icons/information.png";
-			if (inst::ui::nspi_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json") && std::filesystem::exists(inst::config::appDir + "icons_others.information"_theme)) {
-				info = inst::config::appDir + "icons_others.information"_theme;
-			}
+			std::string info = Theme::Asset("icons_others.information", "romfs:/images/icons/information.png");
 			inst::ui::mainApp->CreateShowDialog("main.usb.warn.title"_lang, "inst.nca_verify.ticket_missing"_lang, { "common.ok"_lang }, false, info);
 			return; //don't bother trying to install the ticket or cert if it doesn't exist.
 		}
@@ -0,0 +1,84 @@
+#include "install/install_queue.hpp"
+#include "util/error.hpp"
+#include "util/threads.hpp"
+
+namespace tin::install
+{
+	InstallQueue::InstallQueue(size_t count, TaskFactory factory, bool prefetch) :
+		m_count(count), m_factory(std::move(factory)), m_prefetch(prefetch)
+	{
+	}
+
+	InstallQueue::~InstallQueue()
+	{
+		this->JoinPrefetch();
+	}
+
+	void InstallQueue::JoinPrefetch()
+	{
+		if (m_prefetchThread.joinable())
+			m_prefetchThread.join();
+	}
+
+	void InstallQueue::StartPrefetch(size_t index)
+	{
+		m_prefetchThread = std::thread([this, index]() {
+			inst::threads::Enter("prefetch", inst::threads::Role::Background);
+			try
+			{
+				std::unique_ptr<Install> task = m_factory(index);
+				task->PrefetchCNMT();
+				m_nextTask = std::move(task);
+			}
+			catch (...)
+			{
+				// Reported once the queue reaches this title
+				m_prefetchError = std::current_exception();
+			}
+		});
+	}
+
+	std::unique_ptr<Install> InstallQueue::TakeTask(size_t index)
+	{
+		if (!m_prefetch || index == 0)
+			return m_factory(index);
+
+		this->JoinPrefetch();
+
+		if (m_prefetchError)
+		{
+			std::exception_ptr error = m_prefetchError;
+			m_prefetchError = nullptr;
+			std::rethrow_exception(error);
+		}
+
+		return std::move(m_nextTask);
+	}
+
+	void InstallQueue::Run(const std::function<void(size_t)>& onTitleStart)
+	{
+		for (size_t i = 0; i < m_count; i++)
+		{
+			onTitleStart(i);
+
+			std::unique_ptr<Install> installTask = this->TakeTask(i);
+
+			LOG_DEBUG("%s\n", "Preparing installation");
+			installTask->Prepare();
+			installTask->InstallTicketCert();
+
+			// Records for this title are written, overlap the next title's
+			// header and CNMT reads with this title's content stream
+			if (m_prefetch && i + 1 < m_count)
+				this->StartPrefetch(i + 1);
+
+			installTask->Begin();
+			m_bytesSkipped += installTask->GetBytesSkipped();
+		}
+	}
+
+	u64 InstallQueue::GetBytesSkipped() const
+	{
+		return m_bytesSkipped;
+	}
+}
@@ -31,6 +31,8 @@ SOFTWARE.
 #include "util/crypto.hpp"
 #include "util/util.hpp"
 #include "util/lang.hpp"
+#include "util/telemetry.hpp"
+#include "util/journal.hpp"
 #include "install/nca.hpp"
 #include "ui/MainApplication.hpp"
 #include "util/theme.hpp"
@@ -39,11 +41,6 @@ namespace inst::ui {
 	extern MainApplication* mainApp;
 }
 
-namespace inst::ui {
-	std::string xci_root = inst::config::appDir + "/theme";
-	bool xci_theme = util::themeit(xci_root); //check if we have a previous theme directory first.
-}
-
 namespace tin::install::xci
 {
 	XCIInstallTask::XCIInstallTask(NcmStorageId destStorageId, bool ignoreReqFirmVersion, const std::shared_ptr<XCI>& xci) :
@@ -56,18 +53,30 @@ namespace tin::install::xci
 	{
 		std::vector<std::tuple<nx::ncm::ContentMeta, NcmContentInfo>> CNMTList;
 
+		// Pull the CNMT NCAs into memory unless the install queue already did
+		this->PrefetchCNMT();
+
 		for (const HFS0FileEntry* fileEntry : m_xci->GetFileEntriesByExtension("cnmt.nca")) {
 			std::string cnmtNcaName(m_xci->GetFileEntryName(fileEntry));
 			NcmContentId cnmtContentId = tin::util::GetNcaIdFromString(cnmtNcaName);
 			size_t cnmtNcaSize = fileEntry->fileSize;
 
-			nx::ncm::ContentStorage contentStorage(m_destStorageId);
-
 			LOG_DEBUG("CNMT Name: %s\n", cnmtNcaName.c_str());
 
-			// We install the cnmt nca early to read from it later
-			this->InstallNCA(cnmtContentId);
-			std::string cnmtNCAFullPath = contentStorage.GetPath(cnmtContentId);
+			// Parse the cnmt from memory, the NCA itself is installed by Prepare
+			nx::ncm::ContentMeta contentMeta;
+			try
+			{
+				contentMeta = tin::util::GetContentMetaFromNCA(m_prefetchedNcas[tin::util::GetNcaIdString(cnmtContentId)]);
+			}
+			catch (std::exception& e)
+			{
+				LOG_DEBUG("Failed to parse CNMT in memory: %s\n", e.what());
+
+				// Fall back to installing the cnmt nca early to read from it
+				this->InstallNCA(cnmtContentId);
+				contentMeta = tin::util::GetContentMetaFromNCA(nx::ncm::GetContentStorage(m_destStorageId)->GetPath(cnmtContentId));
+			}
 
 			NcmContentInfo cnmtContentInfo;
 			cnmtContentInfo.content_id = cnmtContentId;
@@ -75,12 +84,65 @@ namespace tin::install::xci
 			ncmU64ToContentInfoSize(cnmtNcaSize & 0xFFFFFFFFFFFF, &cnmtContentInfo);
 			cnmtContentInfo.content_type = NcmContentType_Meta;
 
-			CNMTList.push_back({ tin::util::GetContentMetaFromNCA(cnmtNCAFullPath), cnmtContentInfo });
+			CNMTList.push_back({ contentMeta, cnmtContentInfo });
 		}
 
 		return CNMTList;
 	}
 
+	void XCIInstallTask::PrefetchCNMT()
+	{
+		for (const HFS0FileEntry* fileEntry : m_xci->GetFileEntriesByExtension("cnmt.nca")) {
+			NcmContentId cnmtContentId = tin::util::GetNcaIdFromString(m_xci->GetFileEntryName(fileEntry));
+			if (m_prefetchedNcas.count(tin::util::GetNcaIdString(cnmtContentId)))
+				continue;
+
+			std::vector<u8> cnmtBuf(fileEntry->fileSize);
+
+			LOG_DEBUG("Prefetching %s\n", m_xci->GetFileEntryName(fileEntry));
+			m_xci->BufferData(cnmtBuf.data(), m_xci->GetDataOffset() + fileEntry->dataOffset, cnmtBuf.size());
+			m_prefetchedNcas[tin::util::GetNcaIdString(cnmtContentId)] = std::move(cnmtBuf);
+		}
+	}
+
+	void XCIInstallTask::ReadNcaHeader(const NcmContentId& ncaId, tin::install::NcaHeader* header)
+	{
+		if (this->ReadPrefetchedNCA(ncaId, header, sizeof(tin::install::NcaHeader)))
+			return;
+
+		const HFS0FileEntry* fileEntry = m_xci->GetFileEntryByNcaId(ncaId);
+		if (fileEntry == nullptr)
+			THROW_FORMAT("NCA %s is missing from the package", tin::util::GetNcaIdString(ncaId).c_str());
+
+		m_xci->BufferData(header, m_xci->GetDataOffset() + fileEntry->dataOffset, sizeof(tin::install::NcaHeader));
+	}
+
+	bool XCIInstallTask::GetNcaSourceOffset(const NcmContentId& ncaId, u64* offset)
+	{
+		auto fileEntry = m_xci->GetFileEntryByNcaId(ncaId);
+		if (fileEntry == nullptr)
+			return false;
+
+		*offset = m_xci->GetDataOffset() + fileEntry->dataOffset;
+		return true;
+	}
+
+	void XCIInstallTask::ReadSource(void* buf, u64 offset, size_t size)
+	{
+		m_xci->BufferData(buf, offset, size);
+	}
+
+	void XCIInstallTask::ConfirmInvalidNcaSignature(const NcmContentId& ncaId)
+	{
+		std::string audioPath = Theme::Asset("audio.infobeep", "romfs:/audio/infobeep.mp3");
+		std::thread audioThread(inst::util::playAudio, audioPath);
+		std::string information = Theme::Asset("icons_others.information", "romfs:/images/icons/information.png");
+		int rc = inst::ui::mainApp->CreateShowDialog("inst.nca_verify.title"_lang, "inst.nca_verify.desc"_lang, { "common.cancel"_lang, "inst.nca_verify.opt1"_lang }, false, information);
+		audioThread.join();
+		if (rc != 1)
+			THROW_FORMAT(("inst.nca_verify.error"_lang + tin::util::GetNcaIdString(ncaId)).c_str());
+	}
+
 	void XCIInstallTask::InstallNCA(const NcmContentId& ncaId)
 	{
 		const HFS0FileEntry* fileEntry = m_xci->GetFileEntryByNcaId(ncaId);
@@ -91,13 +153,17 @@ namespace tin::install::xci
 		LOG_DEBUG("Installing %s to storage Id %u\n", ncaFileName.c_str(), m_destStorageId);
 #endif
 
-		std::shared_ptr<nx::ncm::ContentStorage> contentStorage(new nx::ncm::ContentStorage(m_destStorageId));
+		std::shared_ptr<nx::ncm::ContentStorage> contentStorage = nx::ncm::GetContentStorage(m_destStorageId);
 
-		// Attempt to delete any leftover placeholders
-		try {
-			contentStorage->DeletePlaceholder(*(NcmPlaceHolderId*)&ncaId);
+		// Attempt to delete any leftover placeholders, unless the source can resume writing one
+		if (!m_xci->CanResume() || !inst::journal::GetResumeOffset(ncaId, fileEntry->fileSize))
+		{
+			try {
+				contentStorage->DeletePlaceholder(*(NcmPlaceHolderId*)&ncaId);
+			}
+			catch (...) {}
+			inst::journal::Remove(ncaId);
 		}
-		catch (...) {}
 		// Attempt to delete leftover ncas
 		try {
 			contentStorage->Delete(ncaId);
@@ -106,37 +172,31 @@ namespace tin::install::xci
 
 		LOG_DEBUG("Size: 0x%lx\n", ncaSize);
 
-		if (inst::config::validateNCAs && !m_declinedValidation)
+		// Normally Prepare has already checked every header of the title
+		if (inst::config::validateNCAs && !m_declinedValidation && !m_ncaHeadersValidated)
 		{
 			tin::install::NcaHeader* header = new NcaHeader;
-			m_xci->BufferData(header, m_xci->GetDataOffset() + fileEntry->dataOffset, sizeof(tin::install::NcaHeader));
+			this->ReadNcaHeader(ncaId, header);
 
-			Crypto::AesXtr crypto(Crypto::Keys().headerKey, false);
-			crypto.decrypt(header, header, sizeof(tin::install::NcaHeader), 0, 0x200);
+			Crypto::HeaderXtsLease crypto(false);
+			crypto->decrypt(header, header, sizeof(tin::install::NcaHeader), 0, 0x200);
 
 			if (header->magic != MAGIC_NCA3)
 				THROW_FORMAT("Invalid NCA magic");
 
 			if (!Crypto::rsa2048PssVerify(&header->magic, 0x200, header->fixed_key_sig, Crypto::NCAHeaderSignature))
 			{
-				std::string audioPath = "romfs:/audio/infobeep.mp3";
-				std::string beep = inst::config::appDir + "audio.infobeep"_theme;
-				if (inst::ui::xci_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json") && std::filesystem::exists(beep)) audioPath = (beep);
-				std::thread audioThread(inst::util::playAudio, audioPath);
-				std::string information = "romfs:/images/icons/information.png";
-				if (inst::ui::xci_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json") && std::filesystem::exists(inst::config::appDir + "icons_others.information"_theme)) {
-					information = inst::config::appDir + "icons_others.information"_theme;
-				}
-				int rc = inst::ui::mainApp->CreateShowDialog("inst.nca_verify.title"_lang, "inst.nca_verify.desc"_lang, { "common.cancel"_lang, "inst.nca_verify.opt1"_lang }, false, information);
-				audioThread.join();
-				if (rc != 1)
-					THROW_FORMAT(("inst.nca_verify.error"_lang + tin::util::GetNcaIdString(ncaId)).c_str());
+				this->ConfirmInvalidNcaSignature(ncaId);
 				m_declinedValidation = true;
 			}
 			delete header;
 		}
 
-		m_xci->StreamToPlaceholder(contentStorage, ncaId);
+		{
+			inst::telemetry::NcaScope telemetryScope(ncaFileName, fileEntry->fileSize);
+			if (!this->WritePrefetchedNCA(contentStorage, ncaId))
+				m_xci->StreamToPlaceholder(contentStorage, ncaId);
+		}
 
 		// Clean up the line for whatever comes next
 		LOG_DEBUG("                                                           \r");
@@ -150,6 +210,7 @@ namespace tin::install::xci
 		{
 			LOG_DEBUG(("Failed to register " + ncaFileName + ". It may already exist.\n").c_str());
 		}
+		inst::journal::Remove(ncaId);
 
 		try
 		{
@@ -158,6 +219,11 @@ namespace tin::install::xci
 		catch (...) {}
 	}
 
+	bool XCIInstallTask::CanInstallNCAsConcurrently()
+	{
+		return m_xci->CanReadConcurrently();
+	}
+
 	//xci files don't have a ticket or cert - so this is useful when installing a converted nsp to xci
 	void XCIInstallTask::InstallTicketCert()
 	{
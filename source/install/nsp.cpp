@@ -30,14 +30,6 @@ SOFTWARE.
 #include "util/error.hpp"
 #include "util/debug.h"
 
-//
-#include "util/lang.hpp"
-#include "ui/MainApplication.hpp"
-namespace inst::ui {
-	extern MainApplication* mainApp;
-}
-//
-
 namespace tin::install::nsp
 {
 	NSP::NSP() {}
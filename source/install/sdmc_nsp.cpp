@@ -3,8 +3,10 @@
 #include "debug.h"
 #include "nx/nca_writer.h"
 #include "ui/instPage.hpp"
+#include "util/telemetry.hpp"
 #include "util/lang.hpp"
 #include <sstream>
+#include <algorithm>
 
 namespace tin::install::nsp
 {
@@ -20,7 +22,7 @@ namespace tin::install::nsp
 		fclose(m_nspFile);
 	}
 
-	void SDMCNSP::StreamToPlaceholder(std::shared_ptr<nx::ncm::ContentStorage>& contentStorage, NcmContentId ncaId)
+	void SDMCNSP::StreamToPlaceholder(const std::shared_ptr<nx::ncm::ContentSink>& contentStorage, NcmContentId ncaId)
 	{
 		const PFS0FileEntry* fileEntry = this->GetFileEntryByNcaId(ncaId);
 		std::string ncaFileName = this->GetFileEntryName(fileEntry);
@@ -30,38 +32,29 @@ namespace tin::install::nsp
 
 		NcaWriter writer(ncaId, contentStorage);
 
-		float progress;
-
 		u64 fileStart = GetDataOffset() + fileEntry->dataOffset;
-		u64 fileOff = 0;
-		size_t readSize = 0x400000; // 4MB buff
+		u64 fileOff = writer.resume(ncaSize, [&](void* buf, u64 offset, size_t size) { this->BufferData(buf, fileStart + offset, size); });
+		size_t readSize = std::min<size_t>(0x400000, ncaSize); // 4MB buff, less for small NCAs
 		auto readBuffer = std::make_unique<u8[]>(readSize);
 
 		try
 		{
-			//inst::ui::instPage::setInstInfoText("inst.info_page.top_info0"_lang + ncaFileName + "...");
-			inst::ui::instPage::setInstBarPerc(0);
+			inst::ui::instPage::beginProgress(false, ncaFileName, ncaSize);
 			while (fileOff < ncaSize)
 			{
-				progress = (float)fileOff / (float)ncaSize;
-
-				if (fileOff % (0x400000 * 3) == 0) {
-					LOG_DEBUG("> Progress: %lu/%lu MB (%d%s)\r", (fileOff / 1000000), (ncaSize / 1000000), (int)(progress * 100.0), "%");
-					inst::ui::instPage::setInstBarPerc((double)(progress * 100.0));
-					//
-					std::stringstream x;
-					x << (int)(progress * 100.0);
-					inst::ui::instPage::setInstInfoText("inst.info_page.top_info0"_lang + ncaFileName + " " + x.str() + "%");
-				}
+				inst::ui::instPage::publishWritten(fileOff);
+				inst::ui::instPage::pumpProgress(false);
 
 				if (fileOff + readSize >= ncaSize) readSize = ncaSize - fileOff;
 
+				u64 readStart = armGetSystemTick();
 				this->BufferData(readBuffer.get(), fileOff + fileStart, readSize);
+				inst::telemetry::AddBusy(inst::telemetry::Stage::Source, readStart, readSize);
 				writer.write(readBuffer.get(), readSize);
 
 				fileOff += readSize;
 			}
-			inst::ui::instPage::setInstBarPerc(100);
+			inst::ui::instPage::endProgress();
 		}
 		catch (std::exception& e)
 		{
@@ -73,6 +66,7 @@ namespace tin::install::nsp
 
 	void SDMCNSP::BufferData(void* buf, off_t offset, size_t size)
 	{
+		std::lock_guard<std::mutex> lock(m_fileMutex);
 		fseeko(m_nspFile, offset, SEEK_SET);
 		//fseek(m_nspFile, offset, SEEK_SET);
 		fread(buf, 1, size, m_nspFile);
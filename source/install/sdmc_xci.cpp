@@ -3,7 +3,9 @@
 #include "debug.h"
 #include "nx/nca_writer.h"
 #include "ui/instPage.hpp"
+#include "util/telemetry.hpp"
 #include "util/lang.hpp"
+#include <algorithm>
 
 namespace tin::install::xci
 {
@@ -19,7 +21,7 @@ namespace tin::install::xci
 		fclose(m_xciFile);
 	}
 
-	void SDMCXCI::StreamToPlaceholder(std::shared_ptr<nx::ncm::ContentStorage>& contentStorage, NcmContentId ncaId)
+	void SDMCXCI::StreamToPlaceholder(const std::shared_ptr<nx::ncm::ContentSink>& contentStorage, NcmContentId ncaId)
 	{
 		const HFS0FileEntry* fileEntry = this->GetFileEntryByNcaId(ncaId);
 		std::string ncaFileName = this->GetFileEntryName(fileEntry);
@@ -29,38 +31,29 @@ namespace tin::install::xci
 
 		NcaWriter writer(ncaId, contentStorage);
 
-		float progress;
-
 		u64 fileStart = GetDataOffset() + fileEntry->dataOffset;
-		u64 fileOff = 0;
-		size_t readSize = 0x400000; // 4MB buff
+		u64 fileOff = writer.resume(ncaSize, [&](void* buf, u64 offset, size_t size) { this->BufferData(buf, fileStart + offset, size); });
+		size_t readSize = std::min<size_t>(0x400000, ncaSize); // 4MB buff, less for small NCAs
 		auto readBuffer = std::make_unique<u8[]>(readSize);
 
 		try
 		{
-			//inst::ui::instPage::setInstInfoText("inst.info_page.top_info0"_lang + ncaFileName + "...");
-			inst::ui::instPage::setInstBarPerc(0);
+			inst::ui::instPage::beginProgress(false, ncaFileName, ncaSize);
 			while (fileOff < ncaSize)
 			{
-				progress = (float)fileOff / (float)ncaSize;
-
-				if (fileOff % (0x400000 * 3) == 0) {
-					LOG_DEBUG("> Progress: %lu/%lu MB (%d%s)\r", (fileOff / 1000000), (ncaSize / 1000000), (int)(progress * 100.0), "%");
-					inst::ui::instPage::setInstBarPerc((double)(progress * 100.0));
-					//
-					std::stringstream x;
-					x << (int)(progress * 100.0);
-					inst::ui::instPage::setInstInfoText("inst.info_page.top_info0"_lang + ncaFileName + " " + x.str() + "%");
-				}
+				inst::ui::instPage::publishWritten(fileOff);
+				inst::ui::instPage::pumpProgress(false);
 
 				if (fileOff + readSize >= ncaSize) readSize = ncaSize - fileOff;
 
+				u64 readStart = armGetSystemTick();
 				this->BufferData(readBuffer.get(), fileOff + fileStart, readSize);
+				inst::telemetry::AddBusy(inst::telemetry::Stage::Source, readStart, readSize);
 				writer.write(readBuffer.get(), readSize);
 
 				fileOff += readSize;
 			}
-			inst::ui::instPage::setInstBarPerc(100);
+			inst::ui::instPage::endProgress();
 		}
 		catch (std::exception& e)
 		{
@@ -72,6 +65,7 @@ namespace tin::install::xci
 
 	void SDMCXCI::BufferData(void* buf, off_t offset, size_t size)
 	{
+		std::lock_guard<std::mutex> lock(m_fileMutex);
 		fseeko(m_xciFile, offset, SEEK_SET);
 		//fseek(m_xciFile, offset, SEEK_SET);
 		fread(buf, 1, size, m_xciFile);
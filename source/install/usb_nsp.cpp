@@ -35,6 +35,8 @@ SOFTWARE.
 #include "util/usb_comms_tinleaf.h"
 #include "util/lang.hpp"
 #include "ui/instPage.hpp"
+#include "util/telemetry.hpp"
+#include "util/threads.hpp"
 
 
 namespace tin::install::nsp
@@ -58,6 +60,7 @@ namespace tin::install::nsp
 
 	int USBThreadFunc(void* in)
 	{
+		inst::threads::Enter("usb-receive", inst::threads::Role::Receive);
 		USBFuncArgs* args = reinterpret_cast<USBFuncArgs*>(in);
 		tin::util::USBCmdHeader header = tin::util::USBCmdManager::SendFileRangeCmd(args->nspName, args->pfs0Offset, args->ncaSize);
 
@@ -69,22 +72,25 @@ namespace tin::install::nsp
 		{
 			while (sizeRemaining && !stopThreadsUsbNsp)
 			{
+				u64 readStart = armGetSystemTick();
 				tmpSizeRead = tinleaf_usbCommsRead(buf, std::min(sizeRemaining, (u64)0x800000), 5000000000);
 				if (tmpSizeRead == 0) THROW_FORMAT(("inst.usb.error"_lang).c_str());
 				sizeRemaining -= tmpSizeRead;
+				inst::telemetry::AddBusy(inst::telemetry::Stage::Source, readStart, tmpSizeRead);
 
-				while (true)
-				{
-					if (args->bufferedPlaceholderWriter->CanAppendData(tmpSizeRead))
-						break;
-				}
+				u64 waitStart = armGetSystemTick();
+				if (!args->bufferedPlaceholderWriter->WaitToAppendData(tmpSizeRead))
+					break;
+				inst::telemetry::AddWait(inst::telemetry::Stage::Source, waitStart);
 
 				args->bufferedPlaceholderWriter->AppendData(buf, tmpSizeRead);
+				inst::ui::instPage::publishBuffered(args->bufferedPlaceholderWriter->GetSizeBuffered());
 			}
 		}
 		catch (std::exception& e)
 		{
 			stopThreadsUsbNsp = true;
+			args->bufferedPlaceholderWriter->Abort();
 			errorMessageUsbNsp = e.what();
 		}
 
@@ -95,18 +101,22 @@ namespace tin::install::nsp
 
 	int USBPlaceholderWriteFunc(void* in)
 	{
+		inst::threads::Enter("usb-write", inst::threads::Role::Write);
 		USBFuncArgs* args = reinterpret_cast<USBFuncArgs*>(in);
 
-		while (!args->bufferedPlaceholderWriter->IsPlaceholderComplete() && !stopThreadsUsbNsp)
+		u64 waitStart = armGetSystemTick();
+		while (args->bufferedPlaceholderWriter->WaitToWriteSegment())
 		{
-			if (args->bufferedPlaceholderWriter->CanWriteSegmentToPlaceholder())
-				args->bufferedPlaceholderWriter->WriteSegmentToPlaceholder();
+			inst::telemetry::AddWait(inst::telemetry::Stage::Placeholder, waitStart);
+			args->bufferedPlaceholderWriter->WriteSegmentToPlaceholder();
+			waitStart = armGetSystemTick();
+			inst::ui::instPage::publishWritten(args->bufferedPlaceholderWriter->GetSizeWrittenToPlaceholder());
 		}
 
 		return 0;
 	}
 
-	void USBNSP::StreamToPlaceholder(std::shared_ptr<nx::ncm::ContentStorage>& contentStorage, NcmContentId placeholderId)
+	void USBNSP::StreamToPlaceholder(const std::shared_ptr<nx::ncm::ContentSink>& contentStorage, NcmContentId placeholderId)
 	{
 		const PFS0FileEntry* fileEntry = this->GetFileEntryByNcaId(placeholderId);
 		std::string ncaFileName = this->GetFileEntryName(fileEntry);
@@ -123,62 +133,19 @@ namespace tin::install::nsp
 		thrd_t usbThread;
 		thrd_t writeThread;
 
+		inst::ui::instPage::beginProgress(true, ncaFileName, ncaSize);
 		stopThreadsUsbNsp = false;
 		thrd_create(&usbThread, USBThreadFunc, &args);
 		thrd_create(&writeThread, USBPlaceholderWriteFunc, &args);
 
-		u64 freq = armGetSystemTickFreq();
-		u64 startTime = armGetSystemTick();
-		size_t startSizeBuffered = 0;
-		double speed = 0.0;
-
-		inst::ui::instPage::setInstBarPerc(0);
 		while (!bufferedPlaceholderWriter.IsBufferDataComplete() && !stopThreadsUsbNsp)
-		{
-			u64 newTime = armGetSystemTick();
-
-			if (newTime - startTime >= freq)
-			{
-				size_t newSizeBuffered = bufferedPlaceholderWriter.GetSizeBuffered();
-				double mbBuffered = (newSizeBuffered / 1000000.0) - (startSizeBuffered / 1000000.0);
-				double duration = ((double)(newTime - startTime) / (double)freq);
-				speed = mbBuffered / duration;
-
-				startTime = newTime;
-				startSizeBuffered = newSizeBuffered;
-				int downloadProgress = (int)(((double)bufferedPlaceholderWriter.GetSizeBuffered() / (double)bufferedPlaceholderWriter.GetTotalDataSize()) * 100.0);
-#ifdef NXLINK_DEBUG
-				u64 totalSizeMB = bufferedPlaceholderWriter.GetTotalDataSize() / 1000000;
-				u64 downloadSizeMB = bufferedPlaceholderWriter.GetSizeBuffered() / 1000000;
-				LOG_DEBUG("> Download Progress: %lu/%lu MB (%i%s) (%.2f MB/s)\r", downloadSizeMB, totalSizeMB, downloadProgress, "%", speed);
-#endif
-
-				inst::ui::instPage::setInstInfoText("inst.info_page.downloading"_lang + inst::util::formatUrlString(ncaFileName) + "inst.info_page.at"_lang + std::to_string(speed).substr(0, std::to_string(speed).size() - 4) + "MB/s");
-				inst::ui::instPage::setInstBarPerc((double)downloadProgress);
-			}
-		}
+			inst::ui::instPage::pumpProgress();
 		inst::ui::instPage::setInstBarPerc(100);
 
-#ifdef NXLINK_DEBUG
-		u64 totalSizeMB = bufferedPlaceholderWriter.GetTotalDataSize() / 1000000;
-#endif
-
-		//inst::ui::instPage::setInstInfoText("inst.info_page.top_info0"_lang + ncaFileName + "...");
-		inst::ui::instPage::setInstBarPerc(0);
+		inst::ui::instPage::beginInstallStage();
 		while (!bufferedPlaceholderWriter.IsPlaceholderComplete() && !stopThreadsUsbNsp)
-		{
-			int installProgress = (int)(((double)bufferedPlaceholderWriter.GetSizeWrittenToPlaceholder() / (double)bufferedPlaceholderWriter.GetTotalDataSize()) * 100.0);
-#ifdef NXLINK_DEBUG
-			u64 installSizeMB = bufferedPlaceholderWriter.GetSizeWrittenToPlaceholder() / 1000000;
-			LOG_DEBUG("> Install Progress: %lu/%lu MB (%i%s)\r", installSizeMB, totalSizeMB, installProgress, "%");
-#endif
-			inst::ui::instPage::setInstBarPerc((double)installProgress);
-			//
-			std::stringstream x;
-			x << (int)(installProgress);
-			inst::ui::instPage::setInstInfoText("inst.info_page.top_info0"_lang + ncaFileName + " " + x.str() + "%");
-		}
-		inst::ui::instPage::setInstBarPerc(100);
+			inst::ui::instPage::pumpProgress();
+		inst::ui::instPage::endProgress();
 
 		thrd_join(usbThread, NULL);
 		thrd_join(writeThread, NULL);
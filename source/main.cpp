@@ -7,15 +7,12 @@
 #include "util/util.hpp"
 #include "util/config.hpp"
 #include "util/theme.hpp"
-
-namespace inst::ui {
-	std::string main_root = inst::config::appDir + "/theme";
-	bool main_theme = util::themeit(main_root); //check if we have a previous theme directory first.
-}
+#include "util/threads.hpp"
 
 using namespace pu::ui::render;
 int main(int argc, char* argv[])
 {
+	inst::ui::MainApplication::startTick = armGetSystemTick();
 	inst::util::initApp();
 	try {
 		Theme::Load();
@@ -26,7 +23,7 @@ int main(int argc, char* argv[])
 		if (langInt != 2) {
 			if (langInt != 8) {
 				if (langInt != 9) {
-					if (inst::ui::main_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json") && std::filesystem::exists(inst::config::appDir + "fonts.default"_theme)) {
+					if (Theme::HasAsset("fonts.default")) {
 						x = 1;
 					}
 				}
@@ -50,7 +47,10 @@ int main(int argc, char* argv[])
 
 		auto main = inst::ui::MainApplication::New(renderer);
 		std::thread updateThread;
-		if (inst::config::autoUpdate && inst::util::getIPAddress() != "1.0.0.127") updateThread = std::thread(inst::util::checkForAppUpdate);
+		if (inst::config::autoUpdate && inst::util::getIPAddress() != "1.0.0.127") updateThread = std::thread([]() {
+			inst::threads::Enter("update-check", inst::threads::Role::Background);
+			inst::util::checkForAppUpdate();
+		});
 		main->Prepare();
 		main->ShowWithFadeIn();
 		updateThread.join();
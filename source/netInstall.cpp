@@ -37,12 +37,14 @@ SOFTWARE.
 #include "install/install_xci.hpp"
 #include "install/http_xci.hpp"
 #include "install/install.hpp"
+#include "install/install_queue.hpp"
 #include "util/error.hpp"
 #include "util/network_util.hpp"
 #include "util/config.hpp"
 #include "util/util.hpp"
 #include "util/curl.hpp"
 #include "util/lang.hpp"
+#include "util/telemetry.hpp"
 #include "ui/MainApplication.hpp"
 #include "ui/instPage.hpp"
 #include "util/theme.hpp"
@@ -58,11 +60,6 @@ namespace inst::ui {
 	extern MainApplication* mainApp;
 }
 
-namespace inst::ui {
-	std::string neti_root = inst::config::appDir + "/theme";
-	bool neti_theme = util::themeit(neti_root); //check if we have a previous theme directory first.
-}
-
 namespace netInstStuff {
 
 	//Strip the filename from the url we are trying to download - ie list.txt, index.html etc...
@@ -169,10 +166,7 @@ namespace netInstStuff {
 				close(m_serverSocket);
 				m_serverSocket = 0;
 			}
-			std::string fail = "romfs:/images/icons/fail.png";
-			if (inst::ui::neti_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json") && std::filesystem::exists(inst::config::appDir + "icons_others.fail"_theme)) {
-				fail = inst::config::appDir + "icons_others.fail"_theme;
-			}
+			std::string fail = Theme::Asset("icons_others.fail", "romfs:/images/icons/fail.png");
 
 			inst::ui::mainApp->CreateShowDialog("Failed to initialize server socket!", (std::string)e.what(), { "OK" }, true, fail);
 		}
@@ -217,32 +211,31 @@ namespace netInstStuff {
 			previousClockValues.push_back(inst::util::setClockSpeed(2, 1600000000)[0]);
 		}
 
+		u64 bytesSkipped = 0;
+		inst::telemetry::BeginReport("http", m_destStorageId);
 		try {
 			int togo = ourUrlList.size();
-			for (urlItr = 0; urlItr < ourUrlList.size(); urlItr++) {
+			tin::install::InstallQueue installQueue(ourUrlList.size(), [&](size_t i) -> std::unique_ptr<tin::install::Install> {
+				if (inst::curl::downloadToBuffer(ourUrlList[i], 0x100, 0x103) == "HEAD") {
+					auto httpXCI = std::make_shared<tin::install::xci::HTTPXCI>(ourUrlList[i]);
+					return std::make_unique<tin::install::xci::XCIInstallTask>(m_destStorageId, inst::config::ignoreReqVers, httpXCI);
+				}
+				auto httpNSP = std::make_shared<tin::install::nsp::HTTPNSP>(ourUrlList[i]);
+				return std::make_unique<tin::install::nsp::NSPInstall>(m_destStorageId, inst::config::ignoreReqVers, httpNSP);
+			}, true);
+
+			installQueue.Run([&](size_t i) {
+				urlItr = i;
 				auto s = std::to_string(togo);
 				inst::ui::instPage::filecount("inst.info_page.queue"_lang + s);
 				LOG_DEBUG("%s %s\n", "Install request from", ourUrlList[urlItr].c_str());
 				inst::ui::instPage::setTopInstInfoText("inst.info_page.top_info0"_lang + urlNames[urlItr] + ourSource);
-				std::unique_ptr<tin::install::Install> installTask;
-
-				if (inst::curl::downloadToBuffer(ourUrlList[urlItr], 0x100, 0x103) == "HEAD") {
-					auto httpXCI = std::make_shared<tin::install::xci::HTTPXCI>(ourUrlList[urlItr]);
-					installTask = std::make_unique<tin::install::xci::XCIInstallTask>(m_destStorageId, inst::config::ignoreReqVers, httpXCI);
-				}
-				else {
-					auto httpNSP = std::make_shared<tin::install::nsp::HTTPNSP>(ourUrlList[urlItr]);
-					installTask = std::make_unique<tin::install::nsp::NSPInstall>(m_destStorageId, inst::config::ignoreReqVers, httpNSP);
-				}
-
-				LOG_DEBUG("%s\n", "Preparing installation");
 				inst::ui::instPage::setInstInfoText("inst.info_page.preparing"_lang);
 				inst::ui::instPage::setInstBarPerc(0);
-				installTask->Prepare();
-				installTask->InstallTicketCert();
-				installTask->Begin();
 				togo = (togo - 1);
-			}
+			});
+			bytesSkipped = installQueue.GetBytesSkipped();
+			inst::telemetry::EndReport(true);
 
 			inst::ui::instPage::filecount("inst.info_page.queue"_lang + "0");
 		}
@@ -250,6 +243,7 @@ namespace netInstStuff {
 		catch (std::exception& e) {
 			LOG_DEBUG("Failed to install");
 			LOG_DEBUG("%s", e.what());
+			inst::telemetry::EndReport(false, e.what());
 			fprintf(stdout, "%s", e.what());
 			inst::ui::instPage::setInstInfoText("inst.info_page.failed"_lang + urlNames[urlItr]);
 			inst::ui::instPage::setInstBarPerc(0);
@@ -257,15 +251,12 @@ namespace netInstStuff {
 			if (inst::config::useSound) {
 				std::string audioPath = "romfs:/audio/fail.mp3";
 				std::string fail = inst::config::appDir + "audio.fail"_theme;
-				if (inst::ui::neti_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json") && std::filesystem::exists(fail)) audioPath = (fail);
+				if (Theme::HasAsset("audio.fail")) audioPath = (fail);
 				std::thread audioThread(inst::util::playAudio, audioPath);
 				audioThread.join();
 			}
 
-			std::string fail = "romfs:/images/icons/fail.png";
-			if (inst::ui::neti_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json") && std::filesystem::exists(inst::config::appDir + "icons_others.fail"_theme)) {
-				fail = inst::config::appDir + "icons_others.fail"_theme;
-			}
+			std::string fail = Theme::Asset("icons_others.fail", "romfs:/images/icons/fail.png");
 
 			inst::ui::mainApp->CreateShowDialog("inst.info_page.failed"_lang + urlNames[urlItr] + "!", "inst.info_page.failed_desc"_lang + "\n\n" + (std::string)e.what(), { "common.ok"_lang }, true, fail);
 			nspInstalled = false;
@@ -283,21 +274,20 @@ namespace netInstStuff {
 		tin::network::WaitSendNetworkData(m_clientSocket, &ack, sizeof(u8));
 
 		if (nspInstalled) {
-			inst::ui::instPage::setInstInfoText("inst.info_page.complete"_lang);
+			std::string completeText = "inst.info_page.complete"_lang;
+			if (bytesSkipped > 0) completeText += "inst.info_page.skipped"_lang + std::to_string(bytesSkipped / 1000000) + " MB";
+			inst::ui::instPage::setInstInfoText(completeText);
 			inst::ui::instPage::setInstBarPerc(100);
 
 			if (inst::config::useSound) {
 				std::string audioPath = "romfs:/audio/pass.mp3";
 				std::string pass = inst::config::appDir + "audio.pass"_theme;
-				if (inst::ui::neti_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json") && std::filesystem::exists(pass)) audioPath = (pass);
+				if (Theme::HasAsset("audio.pass")) audioPath = (pass);
 				std::thread audioThread(inst::util::playAudio, audioPath);
 				audioThread.join();
 			}
 
-			std::string good = "romfs:/images/icons/good.png";
-			if (inst::ui::neti_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json") && std::filesystem::exists(inst::config::appDir + "icons_others.good"_theme)) {
-				good = inst::config::appDir + "icons_others.good"_theme;
-			}
+			std::string good = Theme::Asset("icons_others.good", "romfs:/images/icons/good.png");
 
 			if (ourUrlList.size() > 1) {
 				inst::ui::mainApp->CreateShowDialog(std::to_string(ourUrlList.size()) + "inst.info_page.desc0"_lang, Language::GetRandomMsg(), { "common.ok"_lang }, true, good);
@@ -346,18 +336,9 @@ namespace netInstStuff {
 			std::vector<std::string> urls;
 			std::vector<std::string> tmp_array;
 
-			std::string info = "romfs:/images/icons/information.png";
-			if (inst::ui::neti_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json") && std::filesystem::exists(inst::config::appDir + "icons_others.information"_theme)) {
-				info = inst::config::appDir + "icons_others.information"_theme;
-			}
-			std::string fail = "romfs:/images/icons/fail.png";
-			if (inst::ui::neti_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json") && std::filesystem::exists(inst::config::appDir + "icons_others.fail"_theme)) {
-				fail = inst::config::appDir + "icons_others.fail"_theme;
-			}
-			std::string wait = "romfs:/images/icons/wait.png";
-			if (inst::ui::neti_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json") && std::filesystem::exists(inst::config::appDir + "icons_others.wait"_theme)) {
-				wait = inst::config::appDir + "icons_others.wait"_theme;
-			}
+			std::string info = Theme::Asset("icons_others.information", "romfs:/images/icons/information.png");
+			std::string fail = Theme::Asset("icons_others.fail", "romfs:/images/icons/fail.png");
+			std::string wait = Theme::Asset("icons_others.wait", "romfs:/images/icons/wait.png");
 
 			while (true) {
 				padUpdate(&pad);
@@ -602,10 +583,7 @@ namespace netInstStuff {
 			LOG_DEBUG("Failed to perform remote install!\n");
 			LOG_DEBUG("%s", e.what());
 			fprintf(stdout, "%s", e.what());
-			std::string fail = "romfs:/images/icons/fail.png";
-			if (inst::ui::neti_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json") && std::filesystem::exists(inst::config::appDir + "icons_others.fail"_theme)) {
-				fail = inst::config::appDir + "icons_others.fail"_theme;
-			}
+			std::string fail = Theme::Asset("icons_others.fail", "romfs:/images/icons/fail.png");
 			inst::ui::mainApp->CreateShowDialog("inst.net.failed"_lang, (std::string)e.what(), { "common.ok"_lang }, true, fail);
 			return {};
 		}
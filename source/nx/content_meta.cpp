@@ -63,11 +63,11 @@ namespace nx::ncm
 	}
 
 	// TODO: Cache this
-	std::vector<NcmContentInfo> ContentMeta::GetContentInfos()
+	std::vector<PackagedContentInfo> ContentMeta::GetPackagedContentInfos()
 	{
 		PackagedContentMetaHeader contentMetaHeader = this->GetPackagedContentMetaHeader();
 
-		std::vector<NcmContentInfo> contentInfos;
+		std::vector<PackagedContentInfo> contentInfos;
 		PackagedContentInfo* packagedContentInfos = (PackagedContentInfo*)(m_bytes.GetData() + sizeof(PackagedContentMetaHeader) + contentMetaHeader.extended_header_size);
 
 		for (unsigned int i = 0; i < contentMetaHeader.content_count; i++)
@@ -77,13 +77,25 @@ namespace nx::ncm
 			// Don't install delta fragments. Even patches don't seem to install them.
 			if (static_cast<u8>(packagedContentInfo.content_info.content_type) <= 5)
 			{
-				contentInfos.push_back(packagedContentInfo.content_info);
+				contentInfos.push_back(packagedContentInfo);
 			}
 		}
 
 		return contentInfos;
 	}
 
+	std::vector<NcmContentInfo> ContentMeta::GetContentInfos()
+	{
+		std::vector<NcmContentInfo> contentInfos;
+
+		for (auto& packagedContentInfo : this->GetPackagedContentInfos())
+		{
+			contentInfos.push_back(packagedContentInfo.content_info);
+		}
+
+		return contentInfos;
+	}
+
 	void ContentMeta::GetInstallContentMeta(tin::data::ByteBuffer& installContentMetaBuffer, NcmContentInfo& cnmtNcmContentInfo, bool ignoreReqFirmVersion)
 	{
 		PackagedContentMetaHeader packagedContentMetaHeader = this->GetPackagedContentMetaHeader();
@@ -0,0 +1,161 @@
+#include "nx/content_sink.hpp"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include "util/error.hpp"
+
+namespace nx::ncm
+{
+	namespace
+	{
+		std::string placeholderName(const NcmPlaceHolderId& placeholderId)
+		{
+			const u8* bytes = reinterpret_cast<const u8*>(&placeholderId);
+			char name[sizeof(NcmPlaceHolderId) * 2 + 1] = {0};
+
+			for (size_t i = 0; i < sizeof(NcmPlaceHolderId); i++)
+				snprintf(name + i * 2, 3, "%02x", bytes[i]);
+
+			return name;
+		}
+	}
+
+	void NullSink::CreatePlaceholder(const NcmContentId& placeholderId, const NcmPlaceHolderId& registeredId, size_t size)
+	{
+	}
+
+	void NullSink::DeletePlaceholder(const NcmPlaceHolderId& placeholderId)
+	{
+	}
+
+	void NullSink::WritePlaceholder(const NcmPlaceHolderId& placeholderId, u64 offset, void* buffer, size_t bufSize)
+	{
+		m_bytesWritten += bufSize;
+	}
+
+	void NullSink::ReadPlaceholder(const NcmPlaceHolderId& placeholderId, u64 offset, void* buffer, size_t bufSize)
+	{
+		THROW_FORMAT("Can't read back from the null sink\n");
+	}
+
+	MemorySink::MemorySink(u64 window) : m_window(window)
+	{
+	}
+
+	void MemorySink::CreatePlaceholder(const NcmContentId& placeholderId, const NcmPlaceHolderId& registeredId, size_t size)
+	{
+		// NcaWriter passes the content id as both ids, key on the one WritePlaceholder gets
+		Placeholder& placeholder = m_placeholders[placeholderName(registeredId)];
+		placeholder.size = size;
+		placeholder.data.assign(std::min<u64>(size, m_window), 0);
+	}
+
+	void MemorySink::DeletePlaceholder(const NcmPlaceHolderId& placeholderId)
+	{
+		m_placeholders.erase(placeholderName(placeholderId));
+	}
+
+	void MemorySink::WritePlaceholder(const NcmPlaceHolderId& placeholderId, u64 offset, void* buffer, size_t bufSize)
+	{
+		auto it = m_placeholders.find(placeholderName(placeholderId));
+		if (it == m_placeholders.end())
+			THROW_FORMAT("Placeholder %s doesn't exist\n", placeholderName(placeholderId).c_str());
+		Placeholder& placeholder = it->second;
+		if (offset + bufSize > placeholder.size)
+			THROW_FORMAT("Write past the end of placeholder %s\n", it->first.c_str());
+
+		const u8* data = (const u8*)buffer;
+		u64 left = bufSize;
+		while (left > 0)
+		{
+			u64 pos = offset % placeholder.data.size();
+			u64 chunk = std::min<u64>(left, placeholder.data.size() - pos);
+			memcpy(placeholder.data.data() + pos, data, chunk);
+			data += chunk;
+			offset += chunk;
+			left -= chunk;
+		}
+		m_bytesWritten += bufSize;
+	}
+
+	void MemorySink::ReadPlaceholder(const NcmPlaceHolderId& placeholderId, u64 offset, void* buffer, size_t bufSize)
+	{
+		const std::vector<u8>& data = this->GetPlaceholder(placeholderId);
+		if (offset + bufSize > data.size())
+			THROW_FORMAT("Read past the end of placeholder %s\n", placeholderName(placeholderId).c_str());
+
+		memcpy(buffer, data.data() + offset, bufSize);
+	}
+
+	const std::vector<u8>& MemorySink::GetPlaceholder(const NcmPlaceHolderId& placeholderId)
+	{
+		auto it = m_placeholders.find(placeholderName(placeholderId));
+		if (it == m_placeholders.end())
+			THROW_FORMAT("Placeholder %s doesn't exist\n", placeholderName(placeholderId).c_str());
+		if (it->second.size > m_window)
+			THROW_FORMAT("Placeholder %s is larger than the memory sink's %llu MB window and can't be read back\n", it->first.c_str(), (unsigned long long)(m_window / 0x100000));
+
+		return it->second.data;
+	}
+
+	FileSink::FileSink(const std::string& directory) : m_directory(directory)
+	{
+		std::filesystem::create_directories(m_directory);
+	}
+
+	FileSink::~FileSink()
+	{
+		for (auto& file : m_files)
+			fclose(file.second);
+	}
+
+	void FileSink::CreatePlaceholder(const NcmContentId& placeholderId, const NcmPlaceHolderId& registeredId, size_t size)
+	{
+		std::string name = placeholderName(registeredId);
+		std::string path = m_directory + "/" + name + ".nca";
+
+		FILE* file = fopen(path.c_str(), "w+b");
+		if (!file)
+			THROW_FORMAT("Can't create %s\n", path.c_str());
+
+		auto it = m_files.find(name);
+		if (it != m_files.end())
+		{
+			fclose(it->second);
+			it->second = file;
+		}
+		else m_files[name] = file;
+	}
+
+	void FileSink::DeletePlaceholder(const NcmPlaceHolderId& placeholderId)
+	{
+		std::string name = placeholderName(placeholderId);
+		auto it = m_files.find(name);
+		if (it == m_files.end())
+			return;
+
+		fclose(it->second);
+		m_files.erase(it);
+		std::filesystem::remove(m_directory + "/" + name + ".nca");
+	}
+
+	void FileSink::WritePlaceholder(const NcmPlaceHolderId& placeholderId, u64 offset, void* buffer, size_t bufSize)
+	{
+		auto it = m_files.find(placeholderName(placeholderId));
+		if (it == m_files.end())
+			THROW_FORMAT("Placeholder %s doesn't exist\n", placeholderName(placeholderId).c_str());
+
+		if (fseeko(it->second, offset, SEEK_SET) != 0 || fwrite(buffer, 1, bufSize, it->second) != bufSize)
+			THROW_FORMAT("Failed to write to placeholder %s\n", it->first.c_str());
+	}
+
+	void FileSink::ReadPlaceholder(const NcmPlaceHolderId& placeholderId, u64 offset, void* buffer, size_t bufSize)
+	{
+		auto it = m_files.find(placeholderName(placeholderId));
+		if (it == m_files.end())
+			THROW_FORMAT("Placeholder %s doesn't exist\n", placeholderName(placeholderId).c_str());
+
+		if (fseeko(it->second, offset, SEEK_SET) != 0 || fread(buffer, 1, bufSize, it->second) != bufSize)
+			THROW_FORMAT("Failed to read from placeholder %s\n", it->first.c_str());
+	}
+}
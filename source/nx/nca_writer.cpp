@@ -20,8 +20,8 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 SOFTWARE.
 */
 
+#include <algorithm>
 #include <filesystem>
-#include <sstream>
 #include <switch.h>
 #include "nx/nca_writer.h"
 #include "util/error.hpp"
@@ -31,11 +31,10 @@ SOFTWARE.
 #include "util/config.hpp"
 #include "util/title_util.hpp"
 #include "install/nca.hpp"
+#include "util/telemetry.hpp"
+#include "util/journal.hpp"
 
-//added for debugging messages on screen
-#include "util/lang.hpp"
-#include "ui/MainApplication.hpp"
-//
+#define RESUME_CHECK_SIZE 0x100000
 
 void append(std::vector<u8>& buffer, const u8* ptr, u64 sz)
 {
@@ -44,8 +43,9 @@ void append(std::vector<u8>& buffer, const u8* ptr, u64 sz)
 	memcpy(buffer.data() + offset, ptr, sz);
 }
 
-NcaBodyWriter::NcaBodyWriter(const NcmContentId& ncaId, u64 offset, std::shared_ptr<nx::ncm::ContentStorage>& contentStorage) : m_contentStorage(contentStorage), m_ncaId(ncaId), m_offset(offset)
+NcaBodyWriter::NcaBodyWriter(const NcmContentId& ncaId, u64 offset, const std::shared_ptr<nx::ncm::ContentSink>& contentStorage) : m_contentStorage(contentStorage), m_ncaId(ncaId), m_offset(offset)
 {
+	m_blockSize = contentStorage ? contentStorage->GetWriteBlockSize() : 0;
 }
 
 NcaBodyWriter::~NcaBodyWriter()
@@ -54,14 +54,83 @@ NcaBodyWriter::~NcaBodyWriter()
 
 u64 NcaBodyWriter::write(const  u8* ptr, u64 sz)
 {
-	if (isOpen())
+	return writePlain(ptr, sz);
+}
+
+bool NcaBodyWriter::close()
+{
+	if (!isOpen())
+	{
+		return false;
+	}
+
+	flushPending();
+	return true;
+}
+
+u64 NcaBodyWriter::writePlain(const  u8* ptr, u64 sz)
+{
+	if (!isOpen())
+	{
+		return 0;
+	}
+
+	u64 total = sz;
+
+	while (sz)
 	{
-		m_contentStorage->WritePlaceholder(*(NcmPlaceHolderId*)&m_ncaId, m_offset, (void*)ptr, sz);
-		m_offset += sz;
-		return sz;
+		u64 start = committed();
+		// A resumed body starts wherever the earlier attempt stopped, so the first block may be short
+		u64 blockEnd = start - start % m_blockSize + m_blockSize;
+		u64 chunk;
+
+		if (m_pending.empty() && sz >= blockEnd - start)
+		{
+			// Aligned and at least a block, no need to copy
+			chunk = blockEnd - start;
+			chunk += (sz - chunk) / m_blockSize * m_blockSize;
+
+			u64 writeStart = armGetSystemTick();
+			m_contentStorage->WritePlaceholder(*(NcmPlaceHolderId*)&m_ncaId, start, (void*)ptr, chunk);
+			inst::telemetry::AddBusy(inst::telemetry::Stage::Placeholder, writeStart, chunk);
+			m_offset += chunk;
+		}
+		else
+		{
+			if (m_pending.capacity() < m_blockSize)
+				m_pending.reserve(m_blockSize);
+
+			chunk = std::min(sz, blockEnd - m_offset);
+			append(m_pending, ptr, chunk);
+			m_offset += chunk;
+
+			if (m_offset == blockEnd)
+				flushPending();
+		}
+
+		ptr += chunk;
+		sz -= chunk;
 	}
 
-	return 0;
+	return total;
+}
+
+u64 NcaBodyWriter::committed() const
+{
+	return m_offset - m_pending.size();
+}
+
+void NcaBodyWriter::flushPending()
+{
+	if (m_pending.empty())
+	{
+		return;
+	}
+
+	u64 writeStart = armGetSystemTick();
+	m_contentStorage->WritePlaceholder(*(NcmPlaceHolderId*)&m_ncaId, committed(), m_pending.data(), m_pending.size());
+	inst::telemetry::AddBusy(inst::telemetry::Stage::Placeholder, writeStart, m_pending.size());
+	m_pending.clear();
 }
 
 bool NcaBodyWriter::isOpen() const
@@ -76,341 +145,238 @@ bool NcaBodyWriter::isOpen() const
 //https://github.com/nicoboss/nsz/blob/master/nsz/BlockDecompressorReader.py
 //https://switchbrew.org/wiki/NCA
 
-namespace inst::ui {
-	extern MainApplication* mainApp;
+NczBodyWriter::NczBodyWriter(const NcmContentId& ncaId, u64 offset, const std::shared_ptr<nx::ncm::ContentSink>& contentStorage) : NcaBodyWriter(ncaId, offset, contentStorage)
+{
+	buffIn = malloc(buffInSize);
+	buffOut = malloc(buffOutSize);
+
+	dctx = ZSTD_createDCtx();
 }
 
-class NczHeader
+NczBodyWriter::~NczBodyWriter()
 {
-public:
-	static const u64 MAGIC = 0x4E544345535A434E; //NTCESZCN
-	static const u64 BLOCK = 0x4E435A424C4F434B; //NCZBLOCK at 0x40D0
-
-	class Section
+	for (auto& i : sections)
 	{
-	public:
-		u64 offset;
-		u64 size;
-		u8 cryptoType;
-		u8 padding1[7];
-		u64 padding2;
-		u8 cryptoKey[0x10];
-		u8 cryptoCounter[0x10];
-	} PACKED;
-
-	class SectionContext : public Section
-	{
-	public:
-		Crypto::Aes128Ctr crypto;
-
-		SectionContext(const Section& s) : Section(s), crypto(s.cryptoKey, Crypto::AesCtr(Crypto::swapEndian(((u64*)&s.cryptoCounter)[0])))
-		{
-		}
-
-		virtual ~SectionContext()
+		if (i)
 		{
+			delete i;
+			i = NULL;
 		}
-
-		void decrypt(void* p, u64 sz, u64 offset)
-		{
-			if (this->cryptoType == 3 || this->cryptoType == 4)
-			{
-				crypto.seek(offset);
-				crypto.decrypt(p, p, sz);
-			}
-			else {
-				return;
-			}
-		}
-
-		void encrypt(void* p, u64 sz, u64 offset)
-		{
-			if (this->cryptoType == 3 || this->cryptoType == 4)
-			{
-				crypto.seek(offset);
-				crypto.encrypt(p, p, sz);
-			}
-			else {
-				return;
-			}
-		}
-	};
-
-	const bool isValid()
-	{
-		return m_magic == MAGIC && m_sectionCount < 0xFFFF;
 	}
 
-	const u64 size() const
+	if (dctx)
 	{
-		return sizeof(m_magic) + sizeof(m_sectionCount) + sizeof(Section) * m_sectionCount;
+		ZSTD_freeDCtx(dctx);
+		dctx = NULL;
 	}
+}
 
-	const Section& section(u64 i) const
+bool NczBodyWriter::close()
+{
+	if (this->m_buffer.size())
 	{
-		return m_sections[i];
+		processChunk(m_buffer.data(), m_buffer.size());
+		m_buffer.resize(0);
 	}
 
-	const u64 sectionCount() const
-	{
-		return m_sectionCount;
-	}
+	encrypt(m_deflateBuffer.data(), m_deflateBuffer.size(), m_offset);
+	flush();
 
-protected:
-	u64 m_magic;
-	u64 m_sectionCount;
-	Section m_sections[1];
-} PACKED;
+	return NcaBodyWriter::close();
+}
 
-class NczBodyWriter : public NcaBodyWriter
+bool NczBodyWriter::flush()
 {
-public:
-	NczBodyWriter(const NcmContentId& ncaId, u64 offset, std::shared_ptr<nx::ncm::ContentStorage>& contentStorage) : NcaBodyWriter(ncaId, offset, contentStorage)
+	if (!isOpen())
 	{
-		buffIn = malloc(buffInSize);
-		buffOut = malloc(buffOutSize);
-
-		dctx = ZSTD_createDCtx();
+		return false;
 	}
 
-	virtual ~NczBodyWriter()
+	if (m_deflateBuffer.size())
 	{
-		close();
-
-		for (auto& i : sections)
-		{
-			if (i)
-			{
-				delete i;
-				i = NULL;
-			}
-		}
-
-		if (dctx)
-		{
-			ZSTD_freeDCtx(dctx);
-			dctx = NULL;
-		}
+		writePlain(m_deflateBuffer.data(), m_deflateBuffer.size());
+		m_deflateBuffer.resize(0);
 	}
+	return true;
+}
 
-	bool close()
-	{
-		if (this->m_buffer.size())
-		{
-			processChunk(m_buffer.data(), m_buffer.size());
-		}
-
-		encrypt(m_deflateBuffer.data(), m_deflateBuffer.size(), m_offset);
-		flush();
+std::vector<NczHeader::SectionContext*>::iterator NczBodyWriter::section(u64 offset)
+{
+	return std::upper_bound(sections.begin(), sections.end(), offset, [](u64 o, const NczHeader::SectionContext* s) {
+		return o < s->offset + s->size;
+	});
+}
 
-		return true;
-	}
+bool NczBodyWriter::encrypt(const void* ptr, u64 sz, u64 offset)
+{
+	u64 encryptStart = armGetSystemTick();
+	u64 totalSize = sz;
+	const u8* start = (u8*)ptr;
+	const u8* end = start + sz;
+	auto it = section(offset);
 
-	bool flush()
+	while (start < end)
 	{
-		if (!isOpen())
-		{
-			return false;
-		}
+		u64 chunk;
 
-		if (m_deflateBuffer.size())
+		if (it == sections.end())
 		{
-			m_contentStorage->WritePlaceholder(*(NcmPlaceHolderId*)&m_ncaId, m_offset, m_deflateBuffer.data(), m_deflateBuffer.size());
-			m_offset += m_deflateBuffer.size();
-			m_deflateBuffer.resize(0);
+			// Past the last section, nothing left to encrypt
+			break;
 		}
-		return true;
-	}
-
-	NczHeader::SectionContext& section(u64 offset)
-	{
-		for (u64 i = 0; i < sections.size(); i++)
+		else if (offset < (*it)->offset)
 		{
-			if (offset >= sections[i]->offset && offset < sections[i]->offset + sections[i]->size)
-			{
-				return *sections[i];
-			}
+			// Gap before the next section stays as is
+			chunk = std::min(sz, (*it)->offset - offset);
 		}
-		return *sections[0];
-	}
-
-	bool encrypt(const void* ptr, u64 sz, u64 offset)
-	{
-		const u8* start = (u8*)ptr;
-		const u8* end = start + sz;
-
-		while (start < end)
+		else
 		{
-			auto& s = section(offset);
-
-			u64 sectionEnd = s.offset + s.size;
-
-			u64 chunk = offset + sz > sectionEnd ? sectionEnd - offset : sz;
-
+			auto& s = **it;
+			chunk = std::min(sz, s.offset + s.size - offset);
 			s.encrypt((void*)start, chunk, offset);
-
-			offset += chunk;
-			start += chunk;
-			sz -= chunk;
+			++it;
 		}
 
-		return true;
+		offset += chunk;
+		start += chunk;
+		sz -= chunk;
 	}
 
-	u64 processChunk(const u8* ptr, u64 sz)
+	inst::telemetry::AddBusy(inst::telemetry::Stage::Encrypt, encryptStart, totalSize);
+	return true;
+}
+
+u64 NczBodyWriter::processChunk(const u8* ptr, u64 sz)
+{
+	while (sz > 0)
 	{
-		while (sz > 0)
+		const size_t readChunkSz = std::min(sz, buffInSize);
+		ZSTD_inBuffer input = { ptr, readChunkSz, 0 };
+
+		while (input.pos < input.size)
 		{
-			const size_t readChunkSz = std::min(sz, buffInSize);
-			ZSTD_inBuffer input = { ptr, readChunkSz, 0 };
+			ZSTD_outBuffer output = { buffOut, buffOutSize, 0 };
+			u64 decompressStart = armGetSystemTick();
+			size_t const ret = ZSTD_decompressStream(dctx, &output, &input);
+			inst::telemetry::AddBusy(inst::telemetry::Stage::Decompress, decompressStart, output.pos);
 
-			while (input.pos < input.size)
+			if (ZSTD_isError(ret))
 			{
-				ZSTD_outBuffer output = { buffOut, buffOutSize, 0 };
-				size_t const ret = ZSTD_decompressStream(dctx, &output, &input);
-
-				if (ZSTD_isError(ret))
-				{
-					LOG_DEBUG("%s\n", ZSTD_getErrorName(ret));
-					return 0;
-				}
-
-				size_t len = output.pos;
-				u8* p = (u8*)buffOut;
+				LOG_DEBUG("%s\n", ZSTD_getErrorName(ret));
+				return 0;
+			}
 
-				while (len)
-				{
-					const size_t writeChunkSz = std::min(0x1000000 - m_deflateBuffer.size(), len);
+			size_t len = output.pos;
+			u8* p = (u8*)buffOut;
 
-					append(m_deflateBuffer, p, writeChunkSz);
+			while (len)
+			{
+				const size_t writeChunkSz = std::min(0x1000000 - m_deflateBuffer.size(), len);
 
-					if (m_deflateBuffer.size() >= 0x1000000)
-					{
-						encrypt(m_deflateBuffer.data(), m_deflateBuffer.size(), m_offset);
-						flush();
-					}
+				append(m_deflateBuffer, p, writeChunkSz);
 
-					p += writeChunkSz;
-					len -= writeChunkSz;
+				if (m_deflateBuffer.size() >= 0x1000000)
+				{
+					encrypt(m_deflateBuffer.data(), m_deflateBuffer.size(), m_offset);
+					flush();
 				}
-			}
 
-			sz -= readChunkSz;
-			ptr += readChunkSz;
+				p += writeChunkSz;
+				len -= writeChunkSz;
+			}
 		}
 
-		return 1;
+		sz -= readChunkSz;
+		ptr += readChunkSz;
 	}
 
-	u64 write(const  u8* ptr, u64 sz) override
+	return 1;
+}
+
+u64 NczBodyWriter::write(const  u8* ptr, u64 sz)
+{
+	if (!m_sectionsInitialized)
 	{
-		if (!m_sectionsInitialized)
+		if (!m_buffer.size())
 		{
-			if (!m_buffer.size())
-			{
-				append(m_buffer, ptr, sizeof(u64) * 2);
-				ptr += sizeof(u64) * 2;
-				sz -= sizeof(u64) * 2;
-			}
-
-			auto header = (NczHeader*)m_buffer.data();
-
-			//debug code -- ignore....
-			/*
-			int x =0;
-			if (x == 0) {
-				char aByte = m_buffer.data()[0];
-				//aByte = 0x10+(aByte*0x40);
-				int one = sizeof(NczHeader);
-				std::ostringstream ss;
-				ss << "0x" << std::hex << one;
-				std::string result = ss.str();
-				inst::ui::mainApp->CreateShowDialog("Debug info", result, { "common.ok"_lang }, true, "romfs:/images/icons/information.png");
-				x++;
-			}
-			*/
-
-			if (m_buffer.size() + sz > header->size())
-			{
-				u64 remainder = header->size() - m_buffer.size();
-				append(m_buffer, ptr, remainder);
-				ptr += remainder;
-				sz -= remainder;
-			}
-			else
-			{
-				append(m_buffer, ptr, sz);
-				ptr += sz;
-				sz = 0;
-			}
+			append(m_buffer, ptr, sizeof(u64) * 2);
+			ptr += sizeof(u64) * 2;
+			sz -= sizeof(u64) * 2;
+		}
 
-			header = (NczHeader*)m_buffer.data();
+		auto header = (NczHeader*)m_buffer.data();
 
-			if (m_buffer.size() == header->size())
-			{
-				for (u64 i = 0; i < header->sectionCount(); i++)
-				{
-					sections.push_back(new NczHeader::SectionContext(header->section(i)));
-				}
-
-				m_sectionsInitialized = true;
-				m_buffer.resize(0);
-			}
+		if (m_buffer.size() + sz > header->size())
+		{
+			u64 remainder = header->size() - m_buffer.size();
+			append(m_buffer, ptr, remainder);
+			ptr += remainder;
+			sz -= remainder;
 		}
-
-		while (sz)
+		else
 		{
-			if (m_buffer.size() + sz >= 0x1000000)
-			{
-				u64 chunk = 0x1000000 - m_buffer.size();
-				append(m_buffer, ptr, chunk);
+			append(m_buffer, ptr, sz);
+			ptr += sz;
+			sz = 0;
+		}
 
-				processChunk(m_buffer.data(), m_buffer.size());
-				m_buffer.resize(0);
+		header = (NczHeader*)m_buffer.data();
 
-				sz -= chunk;
-				ptr += chunk;
-			}
-			else
+		if (m_buffer.size() == header->size())
+		{
+			for (u64 i = 0; i < header->sectionCount(); i++)
 			{
-				append(m_buffer, ptr, sz);
-				sz = 0;
+				sections.push_back(new NczHeader::SectionContext(header->section(i)));
 			}
 
-		}
+			std::sort(sections.begin(), sections.end(), [](const NczHeader::SectionContext* a, const NczHeader::SectionContext* b) {
+				return a->offset < b->offset;
+			});
 
-		return sz;
+			m_sectionsInitialized = true;
+			m_buffer.resize(0);
+		}
 	}
 
-	size_t const buffInSize = ZSTD_DStreamInSize();
-	size_t const buffOutSize = ZSTD_DStreamOutSize();
-
-	void* buffIn = NULL;
-	void* buffOut = NULL;
+	while (sz)
+	{
+		if (m_buffer.size() + sz >= 0x1000000)
+		{
+			u64 chunk = 0x1000000 - m_buffer.size();
+			append(m_buffer, ptr, chunk);
 
-	ZSTD_DCtx* dctx = NULL;
+			processChunk(m_buffer.data(), m_buffer.size());
+			m_buffer.resize(0);
 
-	std::vector<u8> m_buffer;
-	std::vector<u8> m_deflateBuffer;
+			sz -= chunk;
+			ptr += chunk;
+		}
+		else
+		{
+			append(m_buffer, ptr, sz);
+			sz = 0;
+		}
 
-	bool m_sectionsInitialized = false;
+	}
 
-	std::vector<NczHeader::SectionContext*> sections;
-};
+	return sz;
+}
 
-NcaWriter::NcaWriter(const NcmContentId& ncaId, std::shared_ptr<nx::ncm::ContentStorage>& contentStorage) : m_ncaId(ncaId), m_contentStorage(contentStorage), m_writer(NULL)
+NcaWriter::NcaWriter(const NcmContentId& ncaId, const std::shared_ptr<nx::ncm::ContentSink>& contentStorage) : m_ncaId(ncaId), m_contentStorage(contentStorage), m_writer(NULL)
 {
 }
 
+// Pending data is dropped rather than written, so a writer destroyed while an exception unwinds the
+// stream never touches the placeholder again. close() is what writes the last block.
 NcaWriter::~NcaWriter()
 {
-	close();
 }
 
 bool NcaWriter::close()
 {
 	if (m_writer)
 	{
+		m_writer->close();
 		m_writer = NULL;
 	}
 	else if (m_buffer.size())
@@ -452,7 +418,7 @@ u64 NcaWriter::write(const  u8* ptr, u64 sz)
 
 		if (m_buffer.size() == NCA_HEADER_SIZE)
 		{
-			flushHeader();
+			prepareHeader();
 		}
 	}
 
@@ -464,12 +430,17 @@ u64 NcaWriter::write(const  u8* ptr, u64 sz)
 			{
 				if (*(u64*)ptr == NczHeader::MAGIC)
 				{
-					m_writer = std::shared_ptr<NcaBodyWriter>(new NczBodyWriter(m_ncaId, m_buffer.size(), m_contentStorage));
+					m_writer = std::shared_ptr<NcaBodyWriter>(new NczBodyWriter(m_ncaId, 0, m_contentStorage));
 				}
 				else
 				{
-					m_writer = std::shared_ptr<NcaBodyWriter>(new NcaBodyWriter(m_ncaId, m_buffer.size(), m_contentStorage));
+					m_writer = std::shared_ptr<NcaBodyWriter>(new NcaBodyWriter(m_ncaId, 0, m_contentStorage));
+					// Only plain NCAs line up with their source, an NCZ has to be decompressed from the start
+					m_plainBody = true;
 				}
+
+				// The header shares its block with the start of the body instead of being written on its own
+				m_writer->writePlain(m_buffer.data(), m_buffer.size());
 			}
 			else
 			{
@@ -480,6 +451,8 @@ u64 NcaWriter::write(const  u8* ptr, u64 sz)
 		if (m_writer)
 		{
 			m_writer->write(ptr, sz);
+			if (m_journaled && m_plainBody)
+				inst::journal::Progress(m_ncaId, m_writer->committed());
 		}
 		else
 		{
@@ -491,18 +464,36 @@ u64 NcaWriter::write(const  u8* ptr, u64 sz)
 }
 
 void NcaWriter::flushHeader()
+{
+	if (!m_headerReady)
+	{
+		prepareHeader();
+	}
+
+	if (isOpen())
+	{
+		u64 writeStart = armGetSystemTick();
+		m_contentStorage->WritePlaceholder(*(NcmPlaceHolderId*)&m_ncaId, 0, m_buffer.data(), m_buffer.size());
+		inst::telemetry::AddBusy(inst::telemetry::Stage::Placeholder, writeStart, m_buffer.size());
+	}
+}
+
+// Creates the placeholder and fixes up the header in m_buffer, the header itself is written by the body writer
+void NcaWriter::prepareHeader()
 {
 	tin::install::NcaHeader header;
 	memcpy(&header, m_buffer.data(), sizeof(header));
-	Crypto::AesXtr decryptor(Crypto::Keys().headerKey, false);
-	Crypto::AesXtr encryptor(Crypto::Keys().headerKey, true);
-	decryptor.decrypt(&header, &header, sizeof(header), 0, 0x200);
+	Crypto::HeaderXtsLease decryptor(false);
+	Crypto::HeaderXtsLease encryptor(true);
+	decryptor->decrypt(&header, &header, sizeof(header), 0, 0x200);
 
 	if (header.magic == MAGIC_NCA3)
 	{
 		if (isOpen())
 		{
 			m_contentStorage->CreatePlaceholder(m_ncaId, *(NcmPlaceHolderId*)&m_ncaId, header.nca_size);
+			if (m_contentStorage->IsPersistent())
+				inst::journal::Track(m_ncaId, header.nca_size);
 		}
 	}
 	else
@@ -514,10 +505,52 @@ void NcaWriter::flushHeader()
 	{
 		header.distribution = 0;
 	}
-	encryptor.encrypt(m_buffer.data(), &header, sizeof(header), 0, 0x200);
+	encryptor->encrypt(m_buffer.data(), &header, sizeof(header), 0, 0x200);
+	m_headerReady = true;
+}
 
-	if (isOpen())
+u64 NcaWriter::resume(u64 ncaSize, const std::function<void(void* buf, u64 offset, size_t size)>& readSource)
+{
+	if (!isOpen() || !m_contentStorage->IsPersistent())
+		return 0;
+
+	m_journaled = true;
+	u64 offset = inst::journal::GetResumeOffset(m_ncaId, ncaSize);
+	if (offset <= NCA_HEADER_SIZE)
+		return 0;
+
+	// Power loss can drop writes NCM already acknowledged, so check the tail of what the journal
+	// says is there against the source before trusting it
+	u64 checkSize = std::min<u64>(RESUME_CHECK_SIZE, offset - NCA_HEADER_SIZE);
+	std::vector<u8> placeholderData(checkSize);
+	std::vector<u8> sourceData(checkSize);
+	bool valid = false;
+
+	try
 	{
-		m_contentStorage->WritePlaceholder(*(NcmPlaceHolderId*)&m_ncaId, 0, m_buffer.data(), m_buffer.size());
+		m_contentStorage->ReadPlaceholder(*(NcmPlaceHolderId*)&m_ncaId, offset - checkSize, placeholderData.data(), checkSize);
+		readSource(sourceData.data(), offset - checkSize, checkSize);
+		valid = !memcmp(placeholderData.data(), sourceData.data(), checkSize);
 	}
-}
\ No newline at end of file
+	catch (...) {}
+
+	if (!valid)
+	{
+		LOG_DEBUG("Can't resume %s, starting over\n", tin::util::GetNcaIdString(m_ncaId).c_str());
+		try
+		{
+			m_contentStorage->DeletePlaceholder(*(NcmPlaceHolderId*)&m_ncaId);
+		}
+		catch (...) {}
+		inst::journal::Remove(m_ncaId);
+		return 0;
+	}
+
+	LOG_DEBUG("Resuming %s at 0x%lx\n", tin::util::GetNcaIdString(m_ncaId).c_str(), offset);
+	// The header was fixed up and written by the earlier attempt
+	m_buffer.resize(NCA_HEADER_SIZE);
+	m_headerReady = true;
+	m_plainBody = true;
+	m_writer = std::shared_ptr<NcaBodyWriter>(new NcaBodyWriter(m_ncaId, offset, m_contentStorage));
+	return offset;
+}
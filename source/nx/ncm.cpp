@@ -20,14 +20,18 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 SOFTWARE.
 */
 
+#include <map>
+#include <mutex>
 #include "nx/ncm.hpp"
 #include "util/error.hpp"
+#include "util/config.hpp"
 
 namespace nx::ncm
 {
 	ContentStorage::ContentStorage(NcmStorageId storageId)
 	{
 		ASSERT_OK(ncmOpenContentStorage(&m_contentStorage, storageId), "Failed to open NCM ContentStorage");
+		m_writeBlockSize = (u64)(storageId == NcmStorageId_SdCard ? inst::config::writeBlockSd : inst::config::writeBlockNand) * 1024;
 	}
 
 	ContentStorage::~ContentStorage()
@@ -50,6 +54,32 @@ namespace nx::ncm
 		ASSERT_OK(ncmContentStorageWritePlaceHolder(&m_contentStorage, &placeholderId, offset, buffer, bufSize), "Failed to write to placeholder");
 	}
 
+	void ContentStorage::ReadPlaceholder(const NcmPlaceHolderId& placeholderId, u64 offset, void* buffer, size_t bufSize)
+	{
+		ASSERT_OK(ncmContentStorageReadPlaceHolder(&m_contentStorage, &placeholderId, buffer, bufSize, offset), "Failed to read from placeholder");
+	}
+
+	std::vector<NcmPlaceHolderId> ContentStorage::ListPlaceholders()
+	{
+		s32 count = 0;
+		ASSERT_OK(ncmContentStorageGetPlaceHolderCount(&m_contentStorage, &count), "Failed to count placeholders");
+
+		std::vector<NcmPlaceHolderId> placeholderIds(count);
+		if (count > 0)
+		{
+			ASSERT_OK(ncmContentStorageListPlaceHolder(&m_contentStorage, placeholderIds.data(), count, &count), "Failed to list placeholders");
+			placeholderIds.resize(count);
+		}
+		return placeholderIds;
+	}
+
+	s64 ContentStorage::GetPlaceholderSize(const NcmPlaceHolderId& placeholderId)
+	{
+		s64 size = 0;
+		ASSERT_OK(ncmContentStorageGetSizeFromPlaceHolderId(&m_contentStorage, &size, &placeholderId), "Failed to get placeholder size");
+		return size;
+	}
+
 	void ContentStorage::Register(const NcmPlaceHolderId& placeholderId, const NcmContentId& registeredId)
 	{
 		ASSERT_OK(ncmContentStorageRegister(&m_contentStorage, &registeredId, &placeholderId), "Failed to register placeholder NCA");
@@ -67,10 +97,75 @@ namespace nx::ncm
 		return hasNCA;
 	}
 
+	s64 ContentStorage::GetSize(const NcmContentId& registeredId)
+	{
+		s64 size = 0;
+		ASSERT_OK(ncmContentStorageGetSizeFromContentId(&m_contentStorage, &size, &registeredId), "Failed to get installed NCA size");
+		return size;
+	}
+
+	void ContentStorage::Read(const NcmContentId& registeredId, s64 offset, void* buffer, size_t bufSize)
+	{
+		ASSERT_OK(ncmContentStorageReadContentIdFile(&m_contentStorage, buffer, bufSize, &registeredId, offset), "Failed to read installed NCA");
+	}
+
 	std::string ContentStorage::GetPath(const NcmContentId& registeredId)
 	{
 		char pathBuf[FS_MAX_PATH] = { 0 };
 		ASSERT_OK(ncmContentStorageGetPath(&m_contentStorage, pathBuf, FS_MAX_PATH, &registeredId), "Failed to get installed NCA path");
 		return std::string(pathBuf);
 	}
-}
\ No newline at end of file
+
+	ContentMetaDatabase::ContentMetaDatabase(NcmStorageId storageId)
+	{
+		ASSERT_OK(ncmOpenContentMetaDatabase(&m_contentMetaDatabase, storageId), "Failed to open content meta database");
+	}
+
+	ContentMetaDatabase::~ContentMetaDatabase()
+	{
+		serviceClose(&m_contentMetaDatabase.s);
+	}
+
+	void ContentMetaDatabase::Set(const NcmContentMetaKey& key, const void* data, size_t size)
+	{
+		ASSERT_OK(ncmContentMetaDatabaseSet(&m_contentMetaDatabase, &key, data, size), "Failed to set content records");
+	}
+
+	void ContentMetaDatabase::Commit()
+	{
+		ASSERT_OK(ncmContentMetaDatabaseCommit(&m_contentMetaDatabase), "Failed to commit content records");
+	}
+
+	namespace
+	{
+		std::mutex sessionMutex;
+		std::map<NcmStorageId, std::shared_ptr<ContentStorage>> contentStorages;
+		std::map<NcmStorageId, std::shared_ptr<ContentMetaDatabase>> contentMetaDatabases;
+	}
+
+	std::shared_ptr<ContentStorage> GetContentStorage(NcmStorageId storageId)
+	{
+		std::lock_guard<std::mutex> lock(sessionMutex);
+		auto& contentStorage = contentStorages[storageId];
+		if (!contentStorage)
+			contentStorage = std::make_shared<ContentStorage>(storageId);
+		return contentStorage;
+	}
+
+	std::shared_ptr<ContentMetaDatabase> GetContentMetaDatabase(NcmStorageId storageId)
+	{
+		std::lock_guard<std::mutex> lock(sessionMutex);
+		auto& contentMetaDatabase = contentMetaDatabases[storageId];
+		if (!contentMetaDatabase)
+			contentMetaDatabase = std::make_shared<ContentMetaDatabase>(storageId);
+		return contentMetaDatabase;
+	}
+
+	void CloseSessions()
+	{
+		std::lock_guard<std::mutex> lock(sessionMutex);
+		// Anything still holding a session keeps it open until it lets go
+		contentStorages.clear();
+		contentMetaDatabases.clear();
+	}
+}
@@ -30,8 +30,10 @@ SOFTWARE.
 #include "sdInstall.hpp"
 #include "install/install_nsp.hpp"
 #include "install/install_xci.hpp"
+#include "install/install_queue.hpp"
 #include "install/sdmc_xci.hpp"
 #include "install/sdmc_nsp.hpp"
+#include "nx/content_sink.hpp"
 #include "nx/fs.hpp"
 #include "util/file_util.hpp"
 #include "util/title_util.hpp"
@@ -39,6 +41,7 @@ SOFTWARE.
 #include "util/config.hpp"
 #include "util/util.hpp"
 #include "util/lang.hpp"
+#include "util/telemetry.hpp"
 #include "ui/MainApplication.hpp"
 #include "ui/instPage.hpp"
 #include "util/theme.hpp"
@@ -47,13 +50,41 @@ namespace inst::ui {
 	extern MainApplication* mainApp;
 }
 
-namespace inst::ui {
-	std::string sdi_root = inst::config::appDir + "/theme";
-	bool sdi_theme = util::themeit(sdi_root); //check if we have a previous theme directory first.
-}
-
 namespace nspInstStuff {
 
+	namespace {
+		std::shared_ptr<nx::ncm::ContentSink> makeBenchmarkSink(const std::string& sinkType)
+		{
+			if (sinkType == "memory") return std::make_shared<nx::ncm::MemorySink>();
+			if (sinkType == "file") return std::make_shared<nx::ncm::FileSink>(inst::config::appDir + "/benchmark");
+			return std::make_shared<nx::ncm::NullSink>();
+		}
+
+		// Streams every NCA of an NSP or XCI, nothing else (tickets, records) is installed
+		template<typename Container>
+		u64 benchmarkContainer(const std::shared_ptr<Container>& container, const std::string& sinkType)
+		{
+			container->RetrieveHeader();
+			auto entries = container->GetFileEntriesByExtension("nca");
+			for (auto extension : { "cnmt.nca", "ncz", "cnmt.ncz" }) {
+				auto more = container->GetFileEntriesByExtension(extension);
+				entries.insert(entries.end(), more.begin(), more.end());
+			}
+
+			u64 bytes = 0;
+			for (auto entry : entries) {
+				std::string name = container->GetFileEntryName(entry);
+				NcmContentId ncaId = tin::util::GetNcaIdFromString(name.substr(0, 32));
+				// A sink per NCA so the memory sink never holds more than one
+				auto sink = makeBenchmarkSink(sinkType);
+				inst::telemetry::NcaScope scope(name, entry->fileSize);
+				container->StreamToPlaceholder(sink, ncaId);
+				bytes += entry->fileSize;
+			}
+			return bytes;
+		}
+	}
+
 	void installNspFromFile(std::vector<std::filesystem::path> ourTitleList, int whereToInstall)
 	{
 		inst::util::initInstallServices();
@@ -71,32 +102,31 @@ namespace nspInstStuff {
 			previousClockValues.push_back(inst::util::setClockSpeed(2, 1600000000)[0]);
 		}
 
+		u64 bytesSkipped = 0;
+		inst::telemetry::BeginReport("sdmc", m_destStorageId);
 		try
 		{
 			int togo = ourTitleList.size();
-			for (titleItr = 0; titleItr < ourTitleList.size(); titleItr++) {
+			tin::install::InstallQueue installQueue(ourTitleList.size(), [&](size_t i) -> std::unique_ptr<tin::install::Install> {
+				if (ourTitleList[i].extension() == ".xci" || ourTitleList[i].extension() == ".xcz") {
+					auto sdmcXCI = std::make_shared<tin::install::xci::SDMCXCI>(ourTitleList[i]);
+					return std::make_unique<tin::install::xci::XCIInstallTask>(m_destStorageId, inst::config::ignoreReqVers, sdmcXCI);
+				}
+				auto sdmcNSP = std::make_shared<tin::install::nsp::SDMCNSP>(ourTitleList[i]);
+				return std::make_unique<tin::install::nsp::NSPInstall>(m_destStorageId, inst::config::ignoreReqVers, sdmcNSP);
+			}, true);
+
+			installQueue.Run([&](size_t i) {
+				titleItr = i;
 				auto s = std::to_string(togo);
 				inst::ui::instPage::filecount("inst.info_page.queue"_lang + s);
 				inst::ui::instPage::setTopInstInfoText("inst.info_page.top_info0"_lang + inst::util::shortenString(ourTitleList[titleItr].filename().string(), 40, true) + "inst.sd.source_string"_lang);
-				std::unique_ptr<tin::install::Install> installTask;
-
-				if (ourTitleList[titleItr].extension() == ".xci" || ourTitleList[titleItr].extension() == ".xcz") {
-					auto sdmcXCI = std::make_shared<tin::install::xci::SDMCXCI>(ourTitleList[titleItr]);
-					installTask = std::make_unique<tin::install::xci::XCIInstallTask>(m_destStorageId, inst::config::ignoreReqVers, sdmcXCI);
-				}
-				else {
-					auto sdmcNSP = std::make_shared<tin::install::nsp::SDMCNSP>(ourTitleList[titleItr]);
-					installTask = std::make_unique<tin::install::nsp::NSPInstall>(m_destStorageId, inst::config::ignoreReqVers, sdmcNSP);
-				}
-
-				LOG_DEBUG("%s\n", "Preparing installation");
 				inst::ui::instPage::setInstInfoText("inst.info_page.preparing"_lang);
 				inst::ui::instPage::setInstBarPerc(0);
-				installTask->Prepare();
-				installTask->InstallTicketCert();
-				installTask->Begin(); //install nca files
 				togo = (togo - 1);
-			}
+			});
+			bytesSkipped = installQueue.GetBytesSkipped();
+			inst::telemetry::EndReport(true);
 
 			inst::ui::instPage::filecount("inst.info_page.queue"_lang + "0");
 		}
@@ -104,6 +134,7 @@ namespace nspInstStuff {
 		{
 			LOG_DEBUG("Failed to install");
 			LOG_DEBUG("%s", e.what());
+			inst::telemetry::EndReport(false, e.what());
 			fprintf(stdout, "%s", e.what());
 			inst::ui::instPage::setInstInfoText("inst.info_page.failed"_lang + inst::util::shortenString(ourTitleList[titleItr].filename().string(), 42, true));
 			inst::ui::instPage::setInstBarPerc(0);
@@ -111,16 +142,13 @@ namespace nspInstStuff {
 			if (inst::config::useSound) {
 				std::string audioPath = "";
 				std::string fail = inst::config::appDir + "audio.fail"_theme;
-				if (inst::ui::sdi_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json") && std::filesystem::exists(fail)) audioPath = (fail);
+				if (Theme::HasAsset("audio.fail")) audioPath = (fail);
 				else audioPath = "romfs:/audio/fail.mp3";
 				std::thread audioThread(inst::util::playAudio, audioPath);
 				audioThread.join();
 			}
 
-			std::string fail = "romfs:/images/icons/fail.png";
-			if (inst::ui::sdi_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json") && std::filesystem::exists(inst::config::appDir + "icons_others.fail"_theme)) {
-				fail = inst::config::appDir + "icons_others.fail"_theme;
-			}
+			std::string fail = Theme::Asset("icons_others.fail", "romfs:/images/icons/fail.png");
 
 			inst::ui::mainApp->CreateShowDialog("inst.info_page.failed"_lang + inst::util::shortenString(ourTitleList[titleItr].filename().string(), 42, true) + "!\n", "inst.info_page.failed_desc"_lang + "\n\n" + (std::string)e.what(), { "common.ok"_lang }, true, fail);
 			nspInstalled = false;
@@ -133,26 +161,19 @@ namespace nspInstStuff {
 		}
 
 		if (nspInstalled) {
-			inst::ui::instPage::setInstInfoText("inst.info_page.complete"_lang);
+			std::string completeText = "inst.info_page.complete"_lang;
+			if (bytesSkipped > 0) completeText += "inst.info_page.skipped"_lang + std::to_string(bytesSkipped / 1000000) + " MB";
+			inst::ui::instPage::setInstInfoText(completeText);
 			inst::ui::instPage::setInstBarPerc(100);
 
-			std::string bin = "romfs:/images/icons/bin.png";
-			if (inst::ui::sdi_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json") && std::filesystem::exists(inst::config::appDir + "icons_others.bin"_theme)) {
-				bin = inst::config::appDir + "icons_others.bin"_theme;
-			}
-			std::string info = "romfs:/images/icons/information.png";
-			if (inst::ui::sdi_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json") && std::filesystem::exists(inst::config::appDir + "icons_others.information"_theme)) {
-				info = inst::config::appDir + "icons_others.information"_theme;
-			}
-			std::string good = "romfs:/images/icons/good.png";
-			if (inst::ui::sdi_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json") && std::filesystem::exists(inst::config::appDir + "icons_others.good"_theme)) {
-				good = inst::config::appDir + "icons_others.good"_theme;
-			}
+			std::string bin = Theme::Asset("icons_others.bin", "romfs:/images/icons/bin.png");
+			std::string info = Theme::Asset("icons_others.information", "romfs:/images/icons/information.png");
+			std::string good = Theme::Asset("icons_others.good", "romfs:/images/icons/good.png");
 
 			if (inst::config::useSound) {
 				std::string audioPath = "";
 				std::string pass = inst::config::appDir + "audio.pass"_theme;
-				if (inst::ui::sdi_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json") && std::filesystem::exists(pass)) {
+				if (Theme::HasAsset("audio.pass")) {
 					audioPath = (pass);
 				}
 				else {
@@ -189,4 +210,43 @@ namespace nspInstStuff {
 		inst::util::deinitInstallServices();
 		return;
 	}
+
+	void benchmarkNspFromFile(std::vector<std::filesystem::path> ourTitleList, std::string sinkType)
+	{
+		inst::ui::instPage::loadInstallScreen();
+		u64 totalBytes = 0;
+		u64 startTick = armGetSystemTick();
+
+		inst::telemetry::BeginReport("sdmc", "benchmark-" + sinkType);
+		try
+		{
+			for (auto& path : ourTitleList) {
+				inst::ui::instPage::setTopInstInfoText("inst.sd.bench_title"_lang + " (" + sinkType + "): " + inst::util::shortenString(path.filename().string(), 40, true));
+				if (path.extension() == ".xci" || path.extension() == ".xcz") {
+					auto sdmcXCI = std::make_shared<tin::install::xci::SDMCXCI>(path);
+					totalBytes += benchmarkContainer(sdmcXCI, sinkType);
+				}
+				else {
+					auto sdmcNSP = std::make_shared<tin::install::nsp::SDMCNSP>(path);
+					totalBytes += benchmarkContainer(sdmcNSP, sinkType);
+				}
+			}
+			inst::telemetry::EndReport(true);
+		}
+		catch (std::exception& e)
+		{
+			LOG_DEBUG("Benchmark failed: %s\n", e.what());
+			inst::telemetry::EndReport(false, e.what());
+			inst::ui::mainApp->CreateShowDialog("inst.sd.bench_failed"_lang, e.what(), { "common.ok"_lang }, true);
+			inst::ui::instPage::loadMainMenu();
+			return;
+		}
+
+		double seconds = armTicksToNs(armGetSystemTick() - startTick) / 1000000000.0;
+		char result[128];
+		snprintf(result, sizeof(result), "%.1f MB in %.2f s, %.2f MB/s", totalBytes / 1000000.0, seconds, seconds > 0 ? (totalBytes / 1000000.0) / seconds : 0.0);
+		inst::ui::instPage::setInstBarPerc(100);
+		inst::ui::mainApp->CreateShowDialog("inst.sd.bench_complete"_lang + " (" + sinkType + ")", std::string(result) + "\n\n" + inst::config::appDir + "/install_report.json", { "common.ok"_lang }, true);
+		inst::ui::instPage::loadMainMenu();
+	}
 }
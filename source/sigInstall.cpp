@@ -12,30 +12,13 @@ namespace inst::ui {
 	extern MainApplication* mainApp;
 }
 
-namespace inst::ui {
-	std::string sigi_root = inst::config::appDir + "/theme";
-	bool sigi_theme = util::themeit(sigi_root); //check if we have a previous theme directory first.
-}
-
 namespace sig {
 	void installSigPatches() {
 		bpcInitialize();
-		std::string fail = "romfs:/images/icons/fail.png";
-		if (inst::ui::sigi_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json") && std::filesystem::exists(inst::config::appDir + "icons_others.fail"_theme)) {
-			fail = inst::config::appDir + "icons_others.fail"_theme;
-		}
-		std::string patches = "romfs:/images/icons/patches.png";
-		if (inst::ui::sigi_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json") && std::filesystem::exists(inst::config::appDir + "icons_others.patches"_theme)) {
-			patches = inst::config::appDir + "icons_others.patches"_theme;
-		}
-		std::string update = "romfs:/images/icons/update.png";
-		if (inst::ui::sigi_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json") && std::filesystem::exists(inst::config::appDir + "icons_others.update"_theme)) {
-			update = inst::config::appDir + "icons_others.update"_theme;
-		}
-		std::string good = "romfs:/images/icons/good.png";
-		if (inst::ui::sigi_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json") && std::filesystem::exists(inst::config::appDir + "icons_others.good"_theme)) {
-			good = inst::config::appDir + "icons_others.good"_theme;
-		}
+		std::string fail = Theme::Asset("icons_others.fail", "romfs:/images/icons/fail.png");
+		std::string patches = Theme::Asset("icons_others.patches", "romfs:/images/icons/patches.png");
+		std::string update = Theme::Asset("icons_others.update", "romfs:/images/icons/update.png");
+		std::string good = Theme::Asset("icons_others.good", "romfs:/images/icons/good.png");
 
 		try {
 			std::string patchesVersion = inst::util::readTextFromFile("sdmc:/atmosphere/exefs_patches/es_patches/patches.txt");
@@ -54,16 +37,12 @@ namespace sig {
 				if (!inst::util::copyFile("sdmc:/bootloader/patches.ini", inst::config::appDir + "/patches.ini.old")) {
 					if (inst::ui::mainApp->CreateShowDialog("sig.backup_failed"_lang, "sig.backup_failed_desc"_lang, { "common.yes"_lang, "common.no"_lang }, false, fail)) return;
 				}
-				std::string ourPath = inst::config::appDir + "/patches.zip";
-				bool didDownload = inst::curl::downloadFile(inst::config::sigPatchesUrl, ourPath.c_str());
-				bool didExtract = false;
-				if (didDownload) didExtract = inst::zip::extractFile(ourPath, "sdmc:/");
-				else {
+				inst::zip::StreamResult result = inst::zip::extractFromUrl(inst::config::sigPatchesUrl, "sdmc:/");
+				if (result == inst::zip::StreamResult::DownloadFailed) {
 					inst::ui::mainApp->CreateShowDialog("sig.download_failed"_lang, "sig.download_failed_desc"_lang, { "common.ok"_lang }, true, fail);
 					return;
 				}
-				std::filesystem::remove(ourPath);
-				if (didExtract) {
+				if (result == inst::zip::StreamResult::Ok) {
 					patchesVersion = inst::util::readTextFromFile("sdmc:/atmosphere/exefs_patches/es_patches/patches.txt");
 					versionText = "";
 					if (patchesVersion != "") versionText = "sig.version_text2"_lang + patchesVersion + "! ";
@@ -92,10 +71,7 @@ namespace sig {
 			LOG_DEBUG("Failed to install Signature Patches");
 			LOG_DEBUG("%s", e.what());
 			fprintf(stdout, "%s", e.what());
-			std::string fail = "romfs:/images/icons/fail.png";
-			if (inst::ui::sigi_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json") && std::filesystem::exists(inst::config::appDir + "icons_others.fail"_theme)) {
-				fail = inst::config::appDir + "icons_others.fail"_theme;
-			}
+			std::string fail = Theme::Asset("icons_others.fail", "romfs:/images/icons/fail.png");
 			inst::ui::mainApp->CreateShowDialog("sig.generic_error"_lang, (std::string)e.what(), { "common.ok"_lang }, true, fail);
 		}
 		bpcExit();
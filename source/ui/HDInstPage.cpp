@@ -1,4 +1,6 @@
+#include <algorithm>
 #include <filesystem>
+#include <set>
 #include "ui/MainApplication.hpp"
 #include "ui/mainPage.hpp"
 #include "ui/HDInstPage.hpp"
@@ -8,12 +10,8 @@
 #include "util/lang.hpp"
 #include "util/theme.hpp"
 
-#define COLOR(hex) pu::ui::Color::FromHex(hex)
-
 namespace inst::ui {
 	extern MainApplication* mainApp;
-	std::string hd_root = inst::config::appDir + "/theme";
-	bool hd_theme = util::themeit(hd_root); //check if we have a previous theme directory first.
 	s32 zzz = 0; //touchscreen variable
 	bool show_file_ext;
 
@@ -21,63 +19,44 @@ namespace inst::ui {
 	std::string unchecked_hdd = "romfs:/images/icons/checkbox-blank-outline.png";
 
 	void checkbox_hdd() {
-		if (hd_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json") && std::filesystem::exists(inst::config::appDir + "icons_others.checkbox-checked"_theme)) {
+		if (Theme::HasAsset("icons_others.checkbox-checked")) {
 			checked_hdd = inst::config::appDir + "icons_others.checkbox-checked"_theme;
 		}
-		if (hd_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json") && std::filesystem::exists(inst::config::appDir + "icons_others.checkbox-empty"_theme)) {
+		if (Theme::HasAsset("icons_others.checkbox-empty")) {
 			unchecked_hdd = inst::config::appDir + "icons_others.checkbox-empty"_theme;
 		}
 	}
 
 	HDInstPage::HDInstPage() : Layout::Layout() {
-		std::string infoRect_colour = "colour.inforect"_theme;
-		std::string bg_colour = "colour.background"_theme;
-		std::string tbar_colour = "colour.topbar"_theme;
-		std::string bbar_colour = "colour.bottombar"_theme;
 		std::string hd_top = inst::config::appDir + "bg_images.hd_top"_theme;
 		std::string default_background = inst::config::appDir + "bg_images.default_background"_theme;
-		std::string pageinfo_colour = "colour.pageinfo_text"_theme;
-		std::string bottombar_text = "colour.bottombar_text"_theme;
-		std::string background_overlay1 = "colour.background_overlay1"_theme;
-		std::string background_overlay2 = "colour.background_overlay2"_theme;
-		std::string focus = "colour.focus"_theme;
-		std::string scrollbar = "colour.scrollbar"_theme;
 
-		if (hd_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json")) this->infoRect = Rectangle::New(0, 95, 1280, 60, COLOR(infoRect_colour));
-		else this->infoRect = Rectangle::New(0, 95, 1280, 60, COLOR("#00000080"));
+		this->infoRect = Rectangle::New(0, 95, 1280, 60, Theme::Colour("colour.inforect", "#00000080"));
 
-		if (hd_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json")) this->SetBackgroundColor(COLOR(bg_colour));
-		else this->SetBackgroundColor(COLOR("#000000FF"));
+		this->SetBackgroundColor(Theme::Colour("colour.background", "#000000FF"));
 
-		if (hd_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json")) this->topRect = Rectangle::New(0, 0, 1280, 94, COLOR(tbar_colour));
-		else this->topRect = Rectangle::New(0, 0, 1280, 94, COLOR("#000000FF"));
+		this->topRect = Rectangle::New(0, 0, 1280, 94, Theme::Colour("colour.topbar", "#000000FF"));
 
-		if (hd_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json")) this->botRect = Rectangle::New(0, 659, 1280, 61, COLOR(bbar_colour));
-		else this->botRect = Rectangle::New(0, 659, 1280, 61, COLOR("#000000FF"));
+		this->botRect = Rectangle::New(0, 659, 1280, 61, Theme::Colour("colour.bottombar", "#000000FF"));
 
-		if (hd_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json") && std::filesystem::exists(hd_top)) this->titleImage = Image::New(0, 0, (hd_top));
+		if (Theme::HasAsset("bg_images.hd_top")) this->titleImage = Image::New(0, 0, (hd_top));
 		else this->titleImage = Image::New(0, 0, "romfs:/images/Hd.png");
 
-		if (hd_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json") && std::filesystem::exists(default_background)) this->SetBackgroundImage(default_background);
+		if (Theme::HasAsset("bg_images.default_background")) this->SetBackgroundImage(default_background);
 		else this->SetBackgroundImage("romfs:/images/Background.png");
 
 		this->pageInfoText = TextBlock::New(10, 109, "inst.hd.top_info"_lang);
 		this->pageInfoText->SetFont(pu::ui::MakeDefaultFontName(30));
-		if (hd_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json")) this->pageInfoText->SetColor(COLOR(pageinfo_colour));
-		else this->pageInfoText->SetColor(COLOR("#FFFFFFFF"));
+		this->pageInfoText->SetColor(Theme::Colour("colour.pageinfo_text", "#FFFFFFFF"));
 
 		this->butText = TextBlock::New(10, 678, "inst.hd.buttons"_lang);
-		if (hd_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json")) this->butText->SetColor(COLOR(bottombar_text));
-		else this->butText->SetColor(COLOR("#FFFFFFFF"));
+		this->butText->SetColor(Theme::Colour("colour.bottombar_text", "#FFFFFFFF"));
 
-		if (hd_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json")) this->menu = pu::ui::elm::Menu::New(0, 156, 1280, COLOR(background_overlay1), COLOR(background_overlay2), 84, (506 / 84));
-		else this->menu = pu::ui::elm::Menu::New(0, 156, 1280, COLOR("#FFFFFF00"), COLOR("#4f4f4d33"), 84, (506 / 84));
+		this->menu = pu::ui::elm::Menu::New(0, 156, 1280, Theme::Colour("colour.background_overlay1", "#FFFFFF00"), Theme::Colour("colour.background_overlay2", "#4f4f4d33"), 84, (506 / 84));
 
-		if (hd_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json")) this->menu->SetItemsFocusColor(COLOR(focus));
-		else this->menu->SetItemsFocusColor(COLOR("#4f4f4dAA"));
+		this->menu->SetItemsFocusColor(Theme::Colour("colour.focus", "#4f4f4dAA"));
 
-		if (hd_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json")) this->menu->SetScrollbarColor(COLOR(scrollbar));
-		else this->menu->SetScrollbarColor(COLOR("#1A1919FF"));
+		this->menu->SetScrollbarColor(Theme::Colour("colour.scrollbar", "#1A1919FF"));
 
 		this->Add(this->topRect);
 		this->Add(this->infoRect);
@@ -91,11 +70,12 @@ namespace inst::ui {
 
 	void HDInstPage::drawMenuItems(bool clearItems, std::filesystem::path ourPath) {
 		int myindex = this->menu->GetSelectedIndex(); //store index so when page redraws we can get the last item we checked.
+
 		if (clearItems) this->selectedTitles = {};
-		std::string text_colour = "colour.main_text"_theme;
 		this->currentDir = ourPath;
 
 		auto pathStr = this->currentDir.string();
+
 		if (pathStr.length())
 		{
 			if (pathStr[pathStr.length() - 1] == ':')
@@ -109,58 +89,46 @@ namespace inst::ui {
 			this->ourDirectories = util::getDirsAtPath(this->currentDir);
 			this->ourFiles = util::getDirectoryFiles(this->currentDir, { ".nsp", ".nsz", ".xci", ".xcz" });
 		}
+
 		catch (std::exception& e) {
 			this->drawMenuItems(false, this->currentDir.parent_path());
 			return;
 		}
 
-		std::string itm = "..";
-		auto ourEntry = pu::ui::elm::MenuItem::New(itm);
-		if (hd_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json")) ourEntry->SetColor(COLOR(text_colour));
-		else ourEntry->SetColor(COLOR("#FFFFFFFF"));
-
-		std::string folder_up = "romfs:/images/icons/folder-upload.png";
-		if (hd_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json") && std::filesystem::exists(inst::config::appDir + "icons_others.folder_up"_theme)) {
-			folder_up = inst::config::appDir + "icons_others.folder_up"_theme;
-		}
-
-		ourEntry->SetIcon(folder_up);
-		this->menu->AddItem(ourEntry);
+		// Rows are only built for the visible part of the list, see makeMenuItem
+		this->menu->SetItemSource(1 + this->ourDirectories.size() + this->ourFiles.size(), std::bind(&HDInstPage::makeMenuItem, this, std::placeholders::_1));
+		if (this->ourFiles.size()) this->menu->SetSelectedIndex(myindex); //jump to the index we saved from above
+	}
 
-		for (auto& file : this->ourDirectories) {
-			if (file == "..") break;
-			std::string itm = file.filename().string();
-			auto ourEntry = pu::ui::elm::MenuItem::New(itm);
-			if (hd_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json")) ourEntry->SetColor(COLOR(text_colour));
-			else ourEntry->SetColor(COLOR("#FFFFFFFF"));
+	pu::ui::elm::MenuItem::Ref HDInstPage::makeMenuItem(u32 index) {
+		u32 dirListSize = this->ourDirectories.size();
+		std::string itm;
+		std::string icon;
 
-			std::string folder = "romfs:/images/icons/folder.png";
-			if (hd_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json") && std::filesystem::exists(inst::config::appDir + "icons_others.folder"_theme)) {
-				folder = inst::config::appDir + "icons_others.folder"_theme;
-			}
-			ourEntry->SetIcon(folder);
-			this->menu->AddItem(ourEntry);
+		if (index == 0) {
+			itm = "..";
+			icon = Theme::Asset("icons_others.folder_up", "romfs:/images/icons/folder-upload.png");
+		}
+		else if (index <= dirListSize) {
+			itm = this->ourDirectories[index - 1].filename().string();
+			icon = Theme::Asset("icons_others.folder", "romfs:/images/icons/folder.png");
 		}
-		for (auto& file : this->ourFiles) {
-			std::string itm;
+		else {
+			auto& file = this->ourFiles[index - dirListSize - 1];
 			if (show_file_ext == false) {
 				itm = inst::util::SplitFilename(file);
 			}
 			else {
 				itm = file.filename().string();
 			}
-			auto ourEntry = pu::ui::elm::MenuItem::New(itm);
-			if (hd_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json")) ourEntry->SetColor(COLOR(text_colour));
-			else ourEntry->SetColor(COLOR("#FFFFFFFF"));
-			ourEntry->SetIcon(unchecked_hdd);
-			for (long unsigned int i = 0; i < this->selectedTitles.size(); i++) {
-				if (this->selectedTitles[i] == file) {
-					ourEntry->SetIcon(checked_hdd);
-				}
-			}
-			this->menu->AddItem(ourEntry);
-			this->menu->SetSelectedIndex(myindex); //jump to the index we saved from above
+			icon = unchecked_hdd;
+			if (std::find(this->selectedTitles.begin(), this->selectedTitles.end(), file) != this->selectedTitles.end()) icon = checked_hdd;
 		}
+
+		auto ourEntry = pu::ui::elm::MenuItem::New(itm);
+		ourEntry->SetColor(Theme::Colour("colour.main_text", "#FFFFFFFF"));
+		ourEntry->SetIcon(icon);
+		return ourEntry;
 	}
 
 	void HDInstPage::followDirectory() {
@@ -171,7 +139,7 @@ namespace inst::ui {
 		selectedIndex--;
 
 		if (selectedIndex < dirListSize) {
-			if (this->menu->GetItems()[this->menu->GetSelectedIndex()]->GetName() == ".." && this->menu->GetSelectedIndex() == 0) {
+			if (this->menu->GetSelectedIndex() == 0) {
 				this->drawMenuItems(true, this->currentDir.parent_path());
 			}
 			else {
@@ -185,25 +153,21 @@ namespace inst::ui {
 		int dirListSize = this->ourDirectories.size();
 		dirListSize++;
 
-		if (this->menu->GetItems()[selectedIndex]->GetIconPath() == checked_hdd) {
-			for (long unsigned int i = 0; i < this->selectedTitles.size(); i++) {
-				if (this->selectedTitles[i] == this->ourFiles[selectedIndex - dirListSize]) this->selectedTitles.erase(this->selectedTitles.begin() + i);
-			}
-		}
-		else if (this->menu->GetItems()[selectedIndex]->GetIconPath() == unchecked_hdd) this->selectedTitles.push_back(this->ourFiles[selectedIndex - dirListSize]);
-		else {
+		if (selectedIndex < dirListSize) {
 			this->followDirectory();
 			return;
 		}
-		this->drawMenuItems(false, currentDir);
+
+		auto& file = this->ourFiles[selectedIndex - dirListSize];
+		auto selected = std::find(this->selectedTitles.begin(), this->selectedTitles.end(), file);
+		if (selected != this->selectedTitles.end()) this->selectedTitles.erase(selected);
+		else this->selectedTitles.push_back(file);
+		this->menu->InvalidateItems();
 	}
 
 	void HDInstPage::startInstall() {
 		int dialogResult = -1;
-		std::string install = "romfs:/images/icons/install.png";
-		if (hd_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json") && std::filesystem::exists(inst::config::appDir + "icons_others.install"_theme)) {
-			install = inst::config::appDir + "icons_others.install"_theme;
-		}
+		std::string install = Theme::Asset("icons_others.install", "romfs:/images/icons/install.png");
 		if (this->selectedTitles.size() == 1) {
 			dialogResult = mainApp->CreateShowDialog("inst.target.desc0"_lang + ":\n\n" + inst::util::shortenString(std::filesystem::path(this->selectedTitles[0]).filename().string(), 32, true) + "\n\n" + "inst.target.desc1"_lang, "\n\n\n\n\n\n\n" + "common.cancel_desc"_lang, { "inst.target.opt0"_lang, "inst.target.opt1"_lang }, false, install);
 		}
@@ -238,26 +202,21 @@ namespace inst::ui {
 		if ((Down & HidNpadButton_Y)) {
 			if (this->selectedTitles.size() == this->ourFiles.size()) this->drawMenuItems(true, currentDir);
 			else {
-				int topDir = 0;
-				topDir++;
-				for (long unsigned int i = this->ourDirectories.size() + topDir; i < this->menu->GetItems().size(); i++) {
-					if (this->menu->GetItems()[i]->GetIconPath() == checked_hdd) continue;
-					else this->selectNsp(i);
+				std::set<std::filesystem::path> selected(this->selectedTitles.begin(), this->selectedTitles.end());
+				for (auto& file : this->ourFiles) {
+					if (selected.insert(file).second) this->selectedTitles.push_back(file);
 				}
-				this->drawMenuItems(false, currentDir);
+				this->menu->InvalidateItems();
 			}
 		}
 
 		if ((Down & HidNpadButton_X)) {
-			std::string information = "romfs:/images/icons/information.png";
-			if (hd_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json") && std::filesystem::exists(inst::config::appDir + "icons_others.information"_theme)) {
-				information = inst::config::appDir + "icons_others.information"_theme;
-			}
+			std::string information = Theme::Asset("icons_others.information", "romfs:/images/icons/information.png");
 			inst::ui::mainApp->CreateShowDialog("inst.hd.help.title"_lang, "inst.hd.help.desc"_lang, { "common.ok"_lang }, true, information);
 		}
 
 		if (Down & HidNpadButton_Plus) {
-			if (this->selectedTitles.size() == 0 && this->menu->GetItems()[this->menu->GetSelectedIndex()]->GetIconPath() == unchecked_hdd) {
+			if (this->selectedTitles.size() == 0 && this->menu->GetSelectedIndex() > (int)this->ourDirectories.size()) {
 				this->selectNsp(this->menu->GetSelectedIndex());
 			}
 			if (this->selectedTitles.size() > 0) this->startInstall();
@@ -267,18 +226,18 @@ namespace inst::ui {
 			this->menu->SetSelectedIndex(std::max(0, this->menu->GetSelectedIndex() - 6));
 
 		if (Down & HidNpadButton_ZR)
-			this->menu->SetSelectedIndex(std::min((s32)this->menu->GetItems().size() - 1, this->menu->GetSelectedIndex() + 6));
+			this->menu->SetSelectedIndex(std::min((s32)this->menu->GetTotalItemCount() - 1, this->menu->GetSelectedIndex() + 6));
 
 		//goto top of list	
 		if (Down & HidNpadButton_L) {
-			int x = this->menu->GetItems().size() - 1;
+			int x = this->menu->GetTotalItemCount() - 1;
 			this->menu->SetSelectedIndex(std::max(0, this->menu->GetSelectedIndex() - x));
 		}
 
 		//goto bottom of list
 		if (Down & HidNpadButton_R) {
-			int x = this->menu->GetItems().size() - 1;
-			this->menu->SetSelectedIndex(std::min((s32)this->menu->GetItems().size() - 1, this->menu->GetSelectedIndex() + x));
+			int x = this->menu->GetTotalItemCount() - 1;
+			this->menu->SetSelectedIndex(std::min((s32)this->menu->GetTotalItemCount() - 1, this->menu->GetSelectedIndex() + x));
 		}
 
 		//don't show file extensions - refresh page
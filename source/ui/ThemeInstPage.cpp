@@ -16,25 +16,22 @@
 #include <iostream>
 #include <thread>
 
-#define COLOR(hex) pu::ui::Color::FromHex(hex)
-
 namespace inst::ui {
 	extern MainApplication* mainApp;
 	s32 xxxx = 0;
 	int myindex;
 	int installing = 0;
 	std::string root = inst::config::appDir + "/theme";
-	bool istheme = util::themeit(root); //check if we have a previous theme directory first.
 	
 
 	std::string checked_theme = "romfs:/images/icons/check-box-outline.png";
 	std::string unchecked_theme = "romfs:/images/icons/checkbox-blank-outline.png";
 
 	void checkbox_theme() {
-		if (istheme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json") && std::filesystem::exists(inst::config::appDir + "icons_others.checkbox-checked"_theme)) {
+		if (Theme::HasAsset("icons_others.checkbox-checked")) {
 			checked_theme = inst::config::appDir + "icons_others.checkbox-checked"_theme;
 		}
-		if (istheme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json") && std::filesystem::exists(inst::config::appDir + "icons_others.checkbox-empty"_theme)) {
+		if (Theme::HasAsset("icons_others.checkbox-empty")) {
 			unchecked_theme = inst::config::appDir + "icons_others.checkbox-empty"_theme;
 		}
 	}
@@ -42,63 +39,41 @@ namespace inst::ui {
 	std::string httplastUrl2 = "http://";
 	std::string lastFileID2 = "";
 	std::string sourceString2 = "";
-	std::string ourPath = inst::config::appDir + "/temp_download.zip";
 
 	ThemeInstPage::ThemeInstPage() : Layout::Layout() {
 		std::string default_background = inst::config::appDir + "bg_images.default_background"_theme;
 		std::string theme_top = inst::config::appDir + "bg_images.theme_top"_theme;
-		std::string bg_colour = "colour.background"_theme;
-		std::string tbar_colour = "colour.topbar"_theme;
-		std::string bbar_colour = "colour.bottombar"_theme;
-		std::string infoRect_colour = "colour.inforect"_theme;
-		std::string pageinfo_colour = "colour.pageinfo_text"_theme;
-		std::string bottombar_text = "colour.bottombar_text"_theme;
-		std::string background_overlay1 = "colour.background_overlay1"_theme;
-		std::string background_overlay2 = "colour.background_overlay2"_theme;
-		std::string focus = "colour.focus"_theme;
-		std::string scrollbar = "colour.scrollbar"_theme;
 		std::string waiting = inst::config::appDir + "icons_others.waiting_lan"_theme;
-		std::string progress_bg_colour = "colour.progress_bg"_theme;
-		std::string progress_fg_colour = "colour.progress_fg"_theme;
 
-		if (istheme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json")) this->infoRect = Rectangle::New(0, 95, 1280, 60, COLOR(infoRect_colour));
-		else this->infoRect = Rectangle::New(0, 95, 1280, 60, COLOR("#00000080"));
+		this->infoRect = Rectangle::New(0, 95, 1280, 60, Theme::Colour("colour.inforect", "#00000080"));
 
-		if (istheme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json")) this->SetBackgroundColor(COLOR(bg_colour));
-		else this->SetBackgroundColor(COLOR("#000000FF"));
+		this->SetBackgroundColor(Theme::Colour("colour.background", "#000000FF"));
 
-		if (istheme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json")) this->topRect = Rectangle::New(0, 0, 1280, 94, COLOR(tbar_colour));
-		else this->topRect = Rectangle::New(0, 0, 1280, 94, COLOR("#000000FF"));
+		this->topRect = Rectangle::New(0, 0, 1280, 94, Theme::Colour("colour.topbar", "#000000FF"));
 
-		if (istheme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json")) this->botRect = Rectangle::New(0, 659, 1280, 61, COLOR(bbar_colour));
-		else this->botRect = Rectangle::New(0, 659, 1280, 61, COLOR("#000000FF"));
+		this->botRect = Rectangle::New(0, 659, 1280, 61, Theme::Colour("colour.bottombar", "#000000FF"));
 
-		if (istheme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json") && std::filesystem::exists(theme_top)) this->titleImage = Image::New(0, 0, (theme_top));
+		if (Theme::HasAsset("bg_images.theme_top")) this->titleImage = Image::New(0, 0, (theme_top));
 		else this->titleImage = Image::New(0, 0, "romfs:/images/Net.png");
 
-		if (istheme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json") && std::filesystem::exists(default_background)) this->SetBackgroundImage(default_background);
+		if (Theme::HasAsset("bg_images.default_background")) this->SetBackgroundImage(default_background);
 		else this->SetBackgroundImage("romfs:/images/Background.png");
 
 		this->pageInfoText = TextBlock::New(10, 109, "inst.hd.top_info"_lang);
 		this->pageInfoText->SetFont(pu::ui::MakeDefaultFontName(30));
 
-		if (istheme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json")) this->pageInfoText->SetColor(COLOR(pageinfo_colour));
-		else this->pageInfoText->SetColor(COLOR("#FFFFFFFF"));
+		this->pageInfoText->SetColor(Theme::Colour("colour.pageinfo_text", "#FFFFFFFF"));
 
 		this->butText = TextBlock::New(10, 678, "inst.hd.buttons"_lang);
-		if (istheme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json")) this->butText->SetColor(COLOR(bottombar_text));
-		else this->butText->SetColor(COLOR("#FFFFFFFF"));
+		this->butText->SetColor(Theme::Colour("colour.bottombar_text", "#FFFFFFFF"));
 
-		if (istheme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json")) this->menu = pu::ui::elm::Menu::New(0, 156, 1280, COLOR(background_overlay1), COLOR(background_overlay2), 84, (506 / 84));
-		else this->menu = pu::ui::elm::Menu::New(0, 156, 1280, COLOR("#FFFFFF00"), COLOR("#4f4f4d33"), 84, (506 / 84));
+		this->menu = pu::ui::elm::Menu::New(0, 156, 1280, Theme::Colour("colour.background_overlay1", "#FFFFFF00"), Theme::Colour("colour.background_overlay2", "#4f4f4d33"), 84, (506 / 84));
 
-		if (istheme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json")) this->menu->SetItemsFocusColor(COLOR(focus));
-		else this->menu->SetItemsFocusColor(COLOR("#4f4f4dAA"));
+		this->menu->SetItemsFocusColor(Theme::Colour("colour.focus", "#4f4f4dAA"));
 
-		if (istheme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json")) this->menu->SetScrollbarColor(COLOR(scrollbar));
-		else this->menu->SetScrollbarColor(COLOR("#1A1919FF"));
+		this->menu->SetScrollbarColor(Theme::Colour("colour.scrollbar", "#1A1919FF"));
 
-		if (istheme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json") && std::filesystem::exists(waiting)) this->infoImage = Image::New(453, 292, waiting);
+		if (Theme::HasAsset("icons_others.waiting_lan")) this->infoImage = Image::New(453, 292, waiting);
 		else this->infoImage = Image::New(453, 292, "romfs:/images/icons/lan-connection-waiting.png");
 
 		this->Add(this->topRect);
@@ -112,10 +87,8 @@ namespace inst::ui {
 
 		this->installBar = pu::ui::elm::ProgressBar::New(10, 675, 1260, 35, 100.0f);
 
-		if (istheme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json")) this->installBar->SetBackgroundColor(COLOR(progress_bg_colour));
-		else this->installBar->SetBackgroundColor(COLOR("#000000FF"));
-		if (istheme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json")) this->installBar->SetProgressColor(COLOR(progress_fg_colour));
-		else this->installBar->SetProgressColor(COLOR("#565759FF"));
+		this->installBar->SetBackgroundColor(Theme::Colour("colour.progress_bg", "#000000FF"));
+		this->installBar->SetProgressColor(Theme::Colour("colour.progress_fg", "#565759FF"));
 
 		this->Add(this->installBar);
 		checkbox_theme();
@@ -126,7 +99,6 @@ namespace inst::ui {
 		if (clearItems) this->selectedUrls = {};
 		if (clearItems) this->alternativeNames = {};
 		std::string itm;
-		std::string text_colour = "colour.main_text"_theme;
 		mainApp->ThemeinstPage->installBar->SetProgress(0);
 		mainApp->ThemeinstPage->installBar->SetVisible(false);
 
@@ -139,8 +111,7 @@ namespace inst::ui {
 			itm = inst::util::shortenString(inst::util::formatUrlString(file_without_extension), 56, true);
 			//itm = inst::util::shortenString(inst::util::formatUrlString(urls), 56, true); 
 			auto ourEntry = pu::ui::elm::MenuItem::New(itm);
-			if (istheme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json")) ourEntry->SetColor(COLOR(text_colour));
-			else ourEntry->SetColor(COLOR("#FFFFFFFF"));
+			ourEntry->SetColor(Theme::Colour("colour.main_text", "#FFFFFFFF"));
 			ourEntry->SetIcon(unchecked_theme);
 
 			long unsigned int i;
@@ -211,29 +182,19 @@ namespace inst::ui {
 		if (installing != 1) {
 			for (long unsigned int i = 0; i < this->selectedUrls.size(); i++) {
 				inst::ui::mainApp->ThemeinstPage->setInstBarPerc(0);
-				ourPath = inst::config::appDir + "/temp_download.zip";
 				installing = 1;
-				bool didDownload = inst::curl::downloadFile(selectedUrls[0], ourPath.c_str(), 0, true);
-				bool didExtract = false;
-				if (didDownload) {
-					//remove the previous theme first before installing if it exists
-					if (istheme == true) {
-						util::remove_theme(root);
-					}
-					inst::ui::mainApp->ThemeinstPage->pageInfoText->SetText("theme.complete"_lang);
-					try {
-						didExtract = inst::zip::extractFile(ourPath, "sdmc:/");
-					}
-					catch (...) {
-						//https://www.geeksforgeeks.org/multithreading-in-cpp/
-						//extraction failed: still to do - put check in zip function...
-					}
-				}
-				else {
+				bool replaced = false;
+				inst::zip::StreamResult result = inst::zip::extractFromUrl(selectedUrls[0], "sdmc:/", 0, true, [&]() {
+					//the new theme extracted fine, remove the previous one before it's moved into place
+					if (std::filesystem::exists(root)) util::remove_theme(root);
+					replaced = true;
+				});
+				if (replaced) Theme::Load();
+				if (result == inst::zip::StreamResult::DownloadFailed) {
 					if (inst::config::useSound) {
 						std::string audioPath = "romfs:/audio/fail.mp3";
 						std::string fail = inst::config::appDir + "audio.fail"_theme;
-						if (istheme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json") && std::filesystem::exists(fail)) audioPath = (fail);
+						if (Theme::HasAsset("audio.fail")) audioPath = (fail);
 						std::thread audioThread(inst::util::playAudio, audioPath);
 						audioThread.join();
 					}
@@ -242,27 +203,21 @@ namespace inst::ui {
 					inst::ui::mainApp->ThemeinstPage->setInstBarPerc(0);
 					mainApp->ThemeinstPage->installBar->SetVisible(false);
 
-					std::string fail = "romfs:/images/icons/fail.png";
-					if (istheme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json") && std::filesystem::exists(inst::config::appDir + "icons_others.fail"_theme)) {
-						fail = inst::config::appDir + "icons_others.fail"_theme;
-					}
+					std::string fail = Theme::Asset("icons_others.fail", "romfs:/images/icons/fail.png");
 					inst::ui::mainApp->CreateShowDialog("theme.theme_error"_lang, "theme.theme_error_info"_lang, { "common.ok"_lang }, true, fail);
 					return;
 				}
-				std::filesystem::remove(ourPath);
-				if (didExtract) {
+				if (result == inst::zip::StreamResult::Ok) {
+					inst::ui::mainApp->ThemeinstPage->pageInfoText->SetText("theme.complete"_lang);
 					if (inst::config::useSound) {
 						std::string audioPath = "romfs:/audio/pass.mp3";
 						std::string pass = inst::config::appDir + "audio.pass"_theme;
-						if (istheme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json") && std::filesystem::exists(pass)) audioPath = (pass);
+						if (Theme::HasAsset("audio.pass")) audioPath = (pass);
 						std::thread audioThread(inst::util::playAudio, audioPath);
 						audioThread.join();
 					}
 					inst::ui::mainApp->ThemeinstPage->pageInfoText->SetText("theme.extracted"_lang);
-					std::string good = "romfs:/images/icons/good.png";
-					if (istheme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json") && std::filesystem::exists(inst::config::appDir + "icons_others.good"_theme)) {
-						good = inst::config::appDir + "icons_others.good"_theme;
-					}
+					std::string good = Theme::Asset("icons_others.good", "romfs:/images/icons/good.png");
 					int close = inst::ui::mainApp->CreateShowDialog("theme.installed"_lang, "theme.restart"_lang, { "sig.later"_lang, "sig.restart"_lang }, true, good);
 					inst::ui::mainApp->ThemeinstPage->setInstBarPerc(0);
 					mainApp->ThemeinstPage->installBar->SetVisible(false);
@@ -292,7 +247,7 @@ namespace inst::ui {
 		}
 		else {
 			std::string information = "romfs:/images/icons/information.png";
-			if (istheme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json") && std::filesystem::exists(inst::config::appDir + "icons_others.information"_theme)) {
+			if (Theme::HasAsset("icons_others.information")) {
 				information = inst::config::appDir + "icons_others.good"_theme;
 			}
 			inst::ui::mainApp->CreateShowDialog("theme.wait"_lang, "theme.trying"_lang, { "common.ok"_lang }, true, information);
@@ -308,7 +263,7 @@ namespace inst::ui {
 			}
 			else {
 				std::string information = "romfs:/images/icons/information.png";
-				if (istheme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json") && std::filesystem::exists(inst::config::appDir + "icons_others.information"_theme)) {
+				if (Theme::HasAsset("icons_others.information")) {
 					information = inst::config::appDir + "icons_others.good"_theme;
 				}
 				inst::ui::mainApp->CreateShowDialog("theme.wait"_lang, "theme.trying"_lang, { "common.ok"_lang }, true, information);
@@ -316,10 +271,7 @@ namespace inst::ui {
 		}
 
 		if (Down & HidNpadButton_X) {
-			std::string theme = "romfs:/images/icons/theme.png";
-			if (istheme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json") && std::filesystem::exists(inst::config::appDir + "icons_others.theme"_theme)) {
-				theme = inst::config::appDir + "icons_others.theme"_theme;
-			}
+			std::string theme = Theme::Asset("icons_others.theme", "romfs:/images/icons/theme.png");
 
 			int ourResult = 0;
 			std::filesystem::path rootdir = root;
@@ -337,6 +289,7 @@ namespace inst::ui {
 			if (ourResult != 0) {
 				try {
 					bool done = util::remove_theme(root);
+					Theme::Load();
 					if (done == true) {
 						theme = "romfs:/images/icons/theme.png"; //if the theme was removed the icon will be missing so show this instead.
 						inst::ui::mainApp->CreateShowDialog("theme.notice"_lang, "theme.success"_lang, { "common.ok"_lang }, false, theme);
@@ -349,10 +302,7 @@ namespace inst::ui {
 
 				}
 				catch (...) {
-					std::string fail = "romfs:/images/icons/fail.png";
-					if (istheme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json") && std::filesystem::exists(inst::config::appDir + "icons_others.fail"_theme)) {
-						fail = inst::config::appDir + "icons_others.fail"_theme;
-					}
+					std::string fail = Theme::Asset("icons_others.fail", "romfs:/images/icons/fail.png");
 					inst::ui::mainApp->CreateShowDialog("theme.warning"_lang, "theme.error"_lang, { "common.ok"_lang }, false, fail);
 				}
 			}
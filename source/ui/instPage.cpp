@@ -1,4 +1,6 @@
+#include <atomic>
 #include <filesystem>
+#include <thread>
 #include "ui/MainApplication.hpp"
 #include "ui/instPage.hpp"
 #include "util/config.hpp"
@@ -20,75 +22,51 @@ double GetSpace(const char* path)
 	return stat.f_bsize * stat.f_bavail;
 }
 
-#define COLOR(hex) pu::ui::Color::FromHex(hex)
-
 //using namespace std;
 
 namespace inst::ui {
 	extern MainApplication* mainApp;
-	std::string inst_root = inst::config::appDir + "/theme";
-	bool inst_theme = util::themeit(inst_root); //check if we have a previous theme directory first.
 
 	instPage::instPage() : Layout::Layout() {
-		std::string infoRect_colour = "colour.inforect"_theme;
-		std::string bg_colour = "colour.background"_theme;
-		std::string tbar_colour = "colour.topbar"_theme;
 		std::string install_top = inst::config::appDir + "bg_images.install_top"_theme;
 		std::string default_background = inst::config::appDir + "bg_images.default_background"_theme;
-		std::string pageinfo_colour = "colour.pageinfo_text"_theme;
-		std::string installinfo_colour = "colour.installinfo_text"_theme;
-		std::string sdinfo_colour = "colour.sdinfo_text"_theme;
-		std::string nandinfo_colour = "colour.nandinfo_text"_theme;
-		std::string count_colour = "colour.count_text"_theme;
-		std::string progress_bg_colour = "colour.progress_bg"_theme;
-		std::string progress_fg_colour = "colour.progress_fg"_theme;
 
-		if (inst::ui::inst_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json")) this->infoRect = Rectangle::New(0, 95, 1280, 60, COLOR(infoRect_colour));
-		else this->infoRect = Rectangle::New(0, 95, 1280, 60, COLOR("#00000080"));
+		this->infoRect = Rectangle::New(0, 95, 1280, 60, Theme::Colour("colour.inforect", "#00000080"));
 
-		if (inst::ui::inst_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json")) this->SetBackgroundColor(COLOR(bg_colour));
-		else this->SetBackgroundColor(COLOR("#000000FF"));
+		this->SetBackgroundColor(Theme::Colour("colour.background", "#000000FF"));
 
-		if (inst::ui::inst_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json")) this->topRect = Rectangle::New(0, 0, 1280, 94, COLOR(tbar_colour));
-		else this->topRect = Rectangle::New(0, 0, 1280, 94, COLOR("#000000FF"));
+		this->topRect = Rectangle::New(0, 0, 1280, 94, Theme::Colour("colour.topbar", "#000000FF"));
 
-		if (inst::ui::inst_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json") && std::filesystem::exists(install_top)) this->titleImage = Image::New(0, 0, (install_top));
+		if (Theme::HasAsset("bg_images.install_top")) this->titleImage = Image::New(0, 0, (install_top));
 		else this->titleImage = Image::New(0, 0, "romfs:/images/Install.png");
 
-		if (inst::ui::inst_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json") && std::filesystem::exists(default_background)) this->SetBackgroundImage(default_background);
+		if (Theme::HasAsset("bg_images.default_background")) this->SetBackgroundImage(default_background);
 		else this->SetBackgroundImage("romfs:/images/Background.png");
 
 		this->pageInfoText = TextBlock::New(10, 109, "");
 		this->pageInfoText->SetFont(pu::ui::MakeDefaultFontName(30));
-		if (inst::ui::inst_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json")) this->pageInfoText->SetColor(COLOR(pageinfo_colour));
-		else this->pageInfoText->SetColor(COLOR("#FFFFFFFF"));
+		this->pageInfoText->SetColor(Theme::Colour("colour.pageinfo_text", "#FFFFFFFF"));
 
 		this->installInfoText = TextBlock::New(10, 640, "");
 		this->installInfoText->SetFont(pu::ui::MakeDefaultFontName(30));
-		if (inst::ui::inst_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json")) this->installInfoText->SetColor(COLOR(installinfo_colour));
-		else this->installInfoText->SetColor(COLOR("#FFFFFFFF"));
+		this->installInfoText->SetColor(Theme::Colour("colour.installinfo_text", "#FFFFFFFF"));
 
 		this->sdInfoText = TextBlock::New(10, 600, "");
 		this->sdInfoText->SetFont(pu::ui::MakeDefaultFontName(30));
-		if (inst::ui::inst_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json")) this->sdInfoText->SetColor(COLOR(sdinfo_colour));
-		else this->sdInfoText->SetColor(COLOR("#FFFFFFFF"));
+		this->sdInfoText->SetColor(Theme::Colour("colour.sdinfo_text", "#FFFFFFFF"));
 
 		this->nandInfoText = TextBlock::New(10, 560, "");
 		this->nandInfoText->SetFont(pu::ui::MakeDefaultFontName(30));
-		if (inst::ui::inst_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json")) this->nandInfoText->SetColor(COLOR(nandinfo_colour));
-		else this->nandInfoText->SetColor(COLOR("#FFFFFFFF"));
+		this->nandInfoText->SetColor(Theme::Colour("colour.nandinfo_text", "#FFFFFFFF"));
 
 		this->countText = TextBlock::New(10, 520, "");
 		this->countText->SetFont(pu::ui::MakeDefaultFontName(30));
-		if (inst::ui::inst_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json")) this->countText->SetColor(COLOR(count_colour));
-		else this->countText->SetColor(COLOR("#FFFFFFFF"));
+		this->countText->SetColor(Theme::Colour("colour.count_text", "#FFFFFFFF"));
 
 		//this->installBar = pu::ui::elm::ProgressBar::New(10, 680, 1260, 30, 100.0f);
 		this->installBar = pu::ui::elm::ProgressBar::New(10, 675, 1260, 35, 100.0f);
-		if (inst::ui::inst_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json")) this->installBar->SetBackgroundColor(COLOR(progress_bg_colour));
-		else this->installBar->SetBackgroundColor(COLOR("#000000FF"));
-		if (inst::ui::inst_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json")) this->installBar->SetProgressColor(COLOR(progress_fg_colour));
-		else this->installBar->SetProgressColor(COLOR("#565759FF"));
+		this->installBar->SetBackgroundColor(Theme::Colour("colour.progress_bg", "#000000FF"));
+		this->installBar->SetProgressColor(Theme::Colour("colour.progress_fg", "#565759FF"));
 
 		this->Add(this->topRect);
 		this->Add(this->infoRect);
@@ -160,11 +138,135 @@ namespace inst::ui {
 		mainApp->CallForRender();
 	}
 
+	namespace {
+		const u64 progressFps = 30;
+
+		std::atomic<u64> progressBuffered(0);
+		std::atomic<u64> progressWritten(0);
+		std::atomic<u64> progressTotal(0);
+
+		// Only touched by the thread that pumps progress
+		bool progressDownloading = false;
+		std::string progressName;
+		std::string progressPrefix;
+		u64 progressLastFrame = 0;
+		u64 progressSpeedTime = 0;
+		u64 progressSpeedSize = 0;
+		int progressLastPercent = -1;
+		std::string progressSpeedText;
+
+		// Only the UI thread draws. NCAs installed on worker threads beside the one on screen stay quiet.
+		std::thread::id progressThread;
+		thread_local bool progressMuted = false;
+	}
+
+	void instPage::beginProgress(bool downloading, std::string ncaName, u64 totalSize) {
+		progressMuted = progressThread != std::thread::id() && std::this_thread::get_id() != progressThread;
+		if (progressMuted) return;
+
+		progressBuffered = 0;
+		progressWritten = 0;
+		progressTotal = totalSize;
+		progressName = ncaName;
+
+		if (downloading) {
+			progressDownloading = true;
+			progressPrefix = "inst.info_page.downloading"_lang + inst::util::formatUrlString(ncaName) + "inst.info_page.at"_lang;
+			progressSpeedTime = armGetSystemTick();
+			progressSpeedSize = 0;
+			progressLastFrame = 0;
+			progressLastPercent = -1;
+			progressSpeedText = "";
+			setInstInfoText(progressPrefix + "0.00MB/s");
+			setInstBarPerc(0);
+		}
+		else beginInstallStage();
+	}
+
+	void instPage::beginInstallStage() {
+		if (progressMuted) return;
+		progressDownloading = false;
+		progressPrefix = "inst.info_page.top_info0"_lang + progressName + " ";
+		progressLastFrame = 0;
+		progressLastPercent = -1;
+		// Free space is only refreshed here, not on every progress update
+		setInstInfoText(progressPrefix + "0%");
+		setInstBarPerc(0);
+	}
+
+	void instPage::beginCheckProgress(std::string ncaName, u64 totalSize) {
+		beginProgress(false, ncaName, totalSize);
+		if (progressMuted) return;
+		progressPrefix = "inst.info_page.checking"_lang + ncaName + " ";
+		setInstInfoText(progressPrefix + "0%");
+	}
+
+	void instPage::publishBuffered(u64 sizeBuffered) {
+		if (progressMuted) return;
+		progressBuffered.store(sizeBuffered, std::memory_order_relaxed);
+	}
+
+	void instPage::publishWritten(u64 sizeWritten) {
+		if (progressMuted) return;
+		progressWritten.store(sizeWritten, std::memory_order_relaxed);
+	}
+
+	void instPage::pumpProgress(bool idle) {
+		if (progressMuted) return;
+		u64 freq = armGetSystemTickFreq();
+		u64 now = armGetSystemTick();
+
+		if (now - progressLastFrame < freq / progressFps) {
+			// Don't steal CPU from the transfer threads while waiting for the next frame
+			if (idle) svcSleepThread(1000000);
+			return;
+		}
+		progressLastFrame = now;
+
+		u64 total = progressTotal.load(std::memory_order_relaxed);
+		u64 done = progressDownloading ? progressBuffered.load(std::memory_order_relaxed) : progressWritten.load(std::memory_order_relaxed);
+		int percent = total ? (int)((double)done / (double)total * 100.0) : 0;
+		bool changed = false;
+
+		if (progressDownloading) {
+			if (now - progressSpeedTime >= freq) {
+				double speed = ((done - progressSpeedSize) / 1000000.0) / ((double)(now - progressSpeedTime) / (double)freq);
+				std::string speedText = std::to_string(speed).substr(0, std::to_string(speed).size() - 4);
+				progressSpeedTime = now;
+				progressSpeedSize = done;
+
+				if (speedText != progressSpeedText) {
+					progressSpeedText = speedText;
+					mainApp->instpage->installInfoText->SetText(progressPrefix + progressSpeedText + "MB/s");
+					changed = true;
+				}
+			}
+		}
+		else if (percent != progressLastPercent) {
+			mainApp->instpage->installInfoText->SetText(progressPrefix + std::to_string(percent) + "%");
+			changed = true;
+		}
+
+		if (percent != progressLastPercent) {
+			progressLastPercent = percent;
+			mainApp->instpage->installBar->SetProgress((double)percent);
+			changed = true;
+		}
+
+		if (changed) mainApp->CallForRender();
+	}
+
+	void instPage::endProgress() {
+		if (progressMuted) return;
+		setInstBarPerc(100);
+	}
+
 	void instPage::loadMainMenu() {
 		mainApp->LoadLayout(mainApp->mainPage);
 	}
 
 	void instPage::loadInstallScreen() {
+		progressThread = std::this_thread::get_id();
 		mainApp->instpage->pageInfoText->SetText("");
 		mainApp->instpage->installInfoText->SetText("");
 		mainApp->instpage->sdInfoText->SetText("");
@@ -21,8 +21,6 @@
 #include <SDL2/SDL_mixer.h>
 Mix_Music* audio = NULL;
 
-#define COLOR(hex) pu::ui::Color::FromHex(hex)
-
 int statvfs(const char* path, struct statvfs* buf);
 s32 prev_touchcount = 0;
 
@@ -70,8 +68,6 @@ namespace inst::ui {
 	extern MainApplication* mainApp;
 	bool appletFinished = false;
 	bool updateFinished = false;
-	std::string maini_root = inst::config::appDir + "/theme";
-	bool maini_theme = util::themeit(maini_root); //check if we have a previous theme directory first.
 
 	void mathstuff() {
 		double math = (GetAvailableSpace("./") / 1024) / 1024; //megabytes
@@ -135,20 +131,14 @@ namespace inst::ui {
 
 		std::string Info = ("usage.system_size"_lang + sdsize2 + "usage.gb"_lang + "usage.freespace"_lang + freespace2 + "usage.gb"_lang + "usage.percent_used"_lang + percent2 + "usage.percent"_lang + "usage.sd_size"_lang + sdsize + "usage.gb"_lang + "usage.sd_space"_lang + freespace + "usage.gb"_lang + "usage.sd_used"_lang + percent + "usage.percent_symbol"_lang);
 
-		std::string drive = "romfs:/images/icons/drive.png";
-		if (inst::ui::maini_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json") && std::filesystem::exists(inst::config::appDir + "icons_others.drive"_theme)) {
-			drive = inst::config::appDir + "icons_others.drive"_theme;
-		}
+		std::string drive = Theme::Asset("icons_others.drive", "romfs:/images/icons/drive.png");
 		inst::ui::mainApp->CreateShowDialog("usage.space_info"_lang, Info, { "common.ok"_lang }, true, "romfs:/images/icons/drive.png");
 	}
 
 	void playmusic() {
 		SDL_Init(SDL_INIT_AUDIO);
 		Mix_OpenAudio(44100, MIX_DEFAULT_FORMAT, MIX_DEFAULT_CHANNELS, 4096);
-		std::string loadsound = "romfs:/bluesong.mod";
-		if (inst::ui::maini_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json") && std::filesystem::exists(inst::config::appDir + "audio.music"_theme)) {
-			loadsound = inst::config::appDir + "audio.music"_theme;
-		}
+		std::string loadsound = Theme::Asset("audio.music", "romfs:/bluesong.mod");
 		const char* x = loadsound.c_str();
 		audio = Mix_LoadMUS(x);
 		if (audio != NULL) {
@@ -162,10 +152,7 @@ namespace inst::ui {
 			tin::data::NUM_BUFFER_SEGMENTS = 2;
 			if (menuLoaded) {
 				inst::ui::appletFinished = true;
-				std::string information = "romfs:/images/icons/information.png";
-				if (inst::ui::maini_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json") && std::filesystem::exists(inst::config::appDir + "icons_others.information"_theme)) {
-					information = inst::config::appDir + "icons_others.information"_theme;
-				}
+				std::string information = Theme::Asset("icons_others.information", "romfs:/images/icons/information.png");
 				mainApp->CreateShowDialog("main.applet.title"_lang, "main.applet.desc"_lang, { "common.ok"_lang }, true, information);
 			}
 		}
@@ -193,79 +180,57 @@ namespace inst::ui {
 		std::string icons_settings = inst::config::appDir + "icons_mainmenu.settings"_theme;
 		std::string icons_exit = inst::config::appDir + "icons_mainmenu.exit"_theme;
 
-		std::string bg_colour = "colour.background"_theme;
-		std::string tbar_colour = "colour.topbar"_theme;
-		std::string bbar_colour = "colour.bottombar"_theme;
-		std::string bottombar_text = "colour.bottombar_text"_theme;
-		std::string text_colour = "colour.main_text"_theme;
-		std::string background_overlay1 = "colour.background_overlay1"_theme;
-		std::string background_overlay2 = "colour.background_overlay2"_theme;
-		std::string focus = "colour.focus"_theme;
-		std::string scrollbar = "colour.scrollbar"_theme;
 
 
-		if (inst::ui::maini_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json")) this->SetBackgroundColor(COLOR(bg_colour));
-		else this->SetBackgroundColor(COLOR("#000000FF"));
+		this->SetBackgroundColor(Theme::Colour("colour.background", "#000000FF"));
 
-		if (inst::ui::maini_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json")) this->topRect = Rectangle::New(0, 0, 1280, 94, COLOR(tbar_colour));
-		else this->topRect = Rectangle::New(0, 0, 1280, 94, COLOR("#000000FF"));
+		this->topRect = Rectangle::New(0, 0, 1280, 94, Theme::Colour("colour.topbar", "#000000FF"));
 
-		if (inst::ui::maini_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json")) this->botRect = Rectangle::New(0, 659, 1280, 61, COLOR(bbar_colour));
-		else this->botRect = Rectangle::New(0, 659, 1280, 61, COLOR("#000000FF"));
+		this->botRect = Rectangle::New(0, 659, 1280, 61, Theme::Colour("colour.bottombar", "#000000FF"));
 
-		if (inst::ui::maini_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json") && std::filesystem::exists(main_top)) this->titleImage = Image::New(0, 0, (main_top));
+		if (Theme::HasAsset("bg_images.main_top")) this->titleImage = Image::New(0, 0, (main_top));
 		else this->titleImage = Image::New(0, 0, "romfs:/images/Main.png");
 
-		if (inst::ui::maini_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json") && std::filesystem::exists(default_background)) this->SetBackgroundImage(default_background);
+		if (Theme::HasAsset("bg_images.default_background")) this->SetBackgroundImage(default_background);
 		else this->SetBackgroundImage("romfs:/images/Background.png");
 
 		this->butText = TextBlock::New(10, 678, "main.buttons"_lang);
-		if (inst::ui::maini_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json")) this->butText->SetColor(COLOR(bottombar_text));
-		else this->butText->SetColor(COLOR("#FFFFFFFF"));
+		this->butText->SetColor(Theme::Colour("colour.bottombar_text", "#FFFFFFFF"));
 
-		if (inst::ui::maini_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json")) this->optionMenu = pu::ui::elm::Menu::New(0, 95, 1280, COLOR(background_overlay1), COLOR(background_overlay2), 94, 6);
-		else this->optionMenu = pu::ui::elm::Menu::New(0, 95, 1280, COLOR("#FFFFFF00"), COLOR("#4f4f4d33"), 94, 6);
+		this->optionMenu = pu::ui::elm::Menu::New(0, 95, 1280, Theme::Colour("colour.background_overlay1", "#FFFFFF00"), Theme::Colour("colour.background_overlay2", "#4f4f4d33"), 94, 6);
 
-		if (inst::ui::maini_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json")) this->optionMenu->SetItemsFocusColor(COLOR(focus));
-		else this->optionMenu->SetItemsFocusColor(COLOR("#4f4f4dAA"));
+		this->optionMenu->SetItemsFocusColor(Theme::Colour("colour.focus", "#4f4f4dAA"));
 
-		if (inst::ui::maini_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json")) this->optionMenu->SetScrollbarColor(COLOR(scrollbar));
-		else this->optionMenu->SetScrollbarColor(COLOR("#1A1919FF"));
+		this->optionMenu->SetScrollbarColor(Theme::Colour("colour.scrollbar", "#1A1919FF"));
 
 		this->installMenuItem = pu::ui::elm::MenuItem::New("main.menu.sd"_lang);
-		if (inst::ui::maini_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json")) this->installMenuItem->SetColor(COLOR(text_colour));
-		else this->installMenuItem->SetColor(COLOR("#FFFFFFFF"));
-		if (inst::ui::maini_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json") && std::filesystem::exists(icons_sd)) this->installMenuItem->SetIcon(icons_sd);
+		this->installMenuItem->SetColor(Theme::Colour("colour.main_text", "#FFFFFFFF"));
+		if (Theme::HasAsset("icons_mainmenu.sd")) this->installMenuItem->SetIcon(icons_sd);
 		else this->installMenuItem->SetIcon("romfs:/images/icons/micro-sd.png");
 
 		this->netInstallMenuItem = pu::ui::elm::MenuItem::New("main.menu.net"_lang);
-		if (inst::ui::maini_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json")) this->netInstallMenuItem->SetColor(COLOR(text_colour));
-		else this->netInstallMenuItem->SetColor(COLOR("#FFFFFFFF"));
-		if (inst::ui::maini_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json") && std::filesystem::exists(icons_net)) this->netInstallMenuItem->SetIcon(icons_net);
+		this->netInstallMenuItem->SetColor(Theme::Colour("colour.main_text", "#FFFFFFFF"));
+		if (Theme::HasAsset("icons_mainmenu.net")) this->netInstallMenuItem->SetIcon(icons_net);
 		else this->netInstallMenuItem->SetIcon("romfs:/images/icons/cloud-download.png");
 
 		this->usbInstallMenuItem = pu::ui::elm::MenuItem::New("main.menu.usb"_lang);
-		if (inst::ui::maini_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json")) this->usbInstallMenuItem->SetColor(COLOR(text_colour));
-		else this->usbInstallMenuItem->SetColor(COLOR("#FFFFFFFF"));
-		if (inst::ui::maini_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json") && std::filesystem::exists(icons_usb)) this->usbInstallMenuItem->SetIcon(icons_usb);
+		this->usbInstallMenuItem->SetColor(Theme::Colour("colour.main_text", "#FFFFFFFF"));
+		if (Theme::HasAsset("icons_mainmenu.usb")) this->usbInstallMenuItem->SetIcon(icons_usb);
 		else this->usbInstallMenuItem->SetIcon("romfs:/images/icons/usb-port.png");
 
 		this->HdInstallMenuItem = pu::ui::elm::MenuItem::New("main.menu.hdd"_lang);
-		if (inst::ui::maini_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json")) this->HdInstallMenuItem->SetColor(COLOR(text_colour));
-		else this->HdInstallMenuItem->SetColor(COLOR("#FFFFFFFF"));
-		if (inst::ui::maini_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json") && std::filesystem::exists(icons_hdd)) this->HdInstallMenuItem->SetIcon(icons_hdd);
+		this->HdInstallMenuItem->SetColor(Theme::Colour("colour.main_text", "#FFFFFFFF"));
+		if (Theme::HasAsset("icons_mainmenu.hdd")) this->HdInstallMenuItem->SetIcon(icons_hdd);
 		else this->HdInstallMenuItem->SetIcon("romfs:/images/icons/usb-hd.png");
 
 		this->settingsMenuItem = pu::ui::elm::MenuItem::New("main.menu.set"_lang);
-		if (inst::ui::maini_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json")) this->settingsMenuItem->SetColor(COLOR(text_colour));
-		else this->settingsMenuItem->SetColor(COLOR("#FFFFFFFF"));
-		if (inst::ui::maini_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json") && std::filesystem::exists(icons_settings)) this->settingsMenuItem->SetIcon(icons_settings);
+		this->settingsMenuItem->SetColor(Theme::Colour("colour.main_text", "#FFFFFFFF"));
+		if (Theme::HasAsset("icons_mainmenu.settings")) this->settingsMenuItem->SetIcon(icons_settings);
 		else this->settingsMenuItem->SetIcon("romfs:/images/icons/settings.png");
 
 		this->exitMenuItem = pu::ui::elm::MenuItem::New("main.menu.exit"_lang);
-		if (inst::ui::maini_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json")) this->exitMenuItem->SetColor(COLOR(text_colour));
-		else this->exitMenuItem->SetColor(COLOR("#FFFFFFFF"));
-		if (inst::ui::maini_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json") && std::filesystem::exists(icons_exit)) this->exitMenuItem->SetIcon(icons_exit);
+		this->exitMenuItem->SetColor(Theme::Colour("colour.main_text", "#FFFFFFFF"));
+		if (Theme::HasAsset("icons_mainmenu.exit")) this->exitMenuItem->SetIcon(icons_exit);
 		else this->exitMenuItem->SetIcon("romfs:/images/icons/exit-run.png");
 
 		this->Add(this->topRect);
@@ -279,7 +244,7 @@ namespace inst::ui {
 		this->optionMenu->AddItem(this->settingsMenuItem);
 		this->optionMenu->AddItem(this->exitMenuItem);
 		if (nx::hdd::count() && nx::hdd::rootPath()) {
-			if (inst::ui::maini_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json") && std::filesystem::exists(icons_hdd_connected)) this->hdd = Image::New(1156, 669, icons_hdd_connected);
+			if (Theme::HasAsset("icons_mainmenu.hdd_connected")) this->hdd = Image::New(1156, 669, icons_hdd_connected);
 			else this->hdd = Image::New(1156, 669, "romfs:/images/icons/usb-hd-connected.png");
 			this->Add(this->hdd);
 		}
@@ -299,7 +264,7 @@ namespace inst::ui {
 
 	void MainPage::netInstallMenuItem_Click() {
 		if (inst::util::getIPAddress() == "1.0.0.127") {
-			if (inst::ui::maini_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json") && std::filesystem::exists(inst::config::appDir + "icons_others.information"_theme)) {
+			if (Theme::HasAsset("icons_others.information")) {
 				inst::ui::mainApp->CreateShowDialog("main.net.title"_lang, "main.net.desc"_lang, { "common.ok"_lang }, true, inst::config::appDir + "icons_others.information"_theme);
 			}
 			else inst::ui::mainApp->CreateShowDialog("main.net.title"_lang, "main.net.desc"_lang, { "common.ok"_lang }, true, "romfs:/images/icons/information.png");
@@ -309,10 +274,7 @@ namespace inst::ui {
 	}
 
 	void MainPage::usbInstallMenuItem_Click() {
-		std::string usb = "romfs:/images/icons/usb.png";
-		if (inst::ui::maini_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json") && std::filesystem::exists(inst::config::appDir + "icons_others.usb"_theme)) {
-			usb = inst::config::appDir + "icons_others.usb"_theme;
-		}
+		std::string usb = Theme::Asset("icons_others.usb", "romfs:/images/icons/usb.png");
 		if (!inst::config::usbAck) {
 			if (mainApp->CreateShowDialog("main.usb.warn.title"_lang, "main.usb.warn.desc"_lang, { "common.ok"_lang, "main.usb.warn.opt1"_lang }, false, usb) == 1) {
 				inst::config::usbAck = true;
@@ -330,10 +292,7 @@ namespace inst::ui {
 			mainApp->LoadLayout(mainApp->HDinstPage);
 		}
 		else {
-			std::string drive = "romfs:/images/icons/drive.png";
-			if (inst::ui::maini_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json") && std::filesystem::exists(inst::config::appDir + "icons_others.drive"_theme)) {
-				drive = inst::config::appDir + "icons_others.drive"_theme;
-			}
+			std::string drive = Theme::Asset("icons_others.drive", "romfs:/images/icons/drive.png");
 			inst::ui::mainApp->CreateShowDialog("main.hdd.title"_lang, "main.hdd.notfound"_lang, { "common.ok"_lang }, true, drive);
 		}
 	}
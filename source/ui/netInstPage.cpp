@@ -1,4 +1,6 @@
+#include <algorithm>
 #include <filesystem>
+#include <set>
 #include <switch.h>
 #include "ui/MainApplication.hpp"
 #include "ui/mainPage.hpp"
@@ -11,21 +13,17 @@
 #include "util/theme.hpp"
 #include <sstream>
 
-#define COLOR(hex) pu::ui::Color::FromHex(hex)
-
 namespace inst::ui {
 	extern MainApplication* mainApp;
-	std::string net_root = inst::config::appDir + "/theme";
-	bool net_theme = util::themeit(net_root); //check if we have a previous theme directory first.
 	s32 xxx = 0;
 	std::string checked_net = "romfs:/images/icons/check-box-outline.png";
 	std::string unchecked_net = "romfs:/images/icons/checkbox-blank-outline.png";
 
 	void checkbox_net() {
-		if (net_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json") && std::filesystem::exists(inst::config::appDir + "icons_others.checkbox-checked"_theme)) {
+		if (Theme::HasAsset("icons_others.checkbox-checked")) {
 			checked_net = inst::config::appDir + "icons_others.checkbox-checked"_theme;
 		}
-		if (net_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json") && std::filesystem::exists(inst::config::appDir + "icons_others.checkbox-empty"_theme)) {
+		if (Theme::HasAsset("icons_others.checkbox-empty")) {
 			unchecked_net = inst::config::appDir + "icons_others.checkbox-empty"_theme;
 		}
 	}
@@ -35,60 +33,41 @@ namespace inst::ui {
 	std::string sourceString = "";
 
 	netInstPage::netInstPage() : Layout::Layout() {
-		std::string infoRect_colour = "colour.inforect"_theme;
-		std::string bg_colour = "colour.background"_theme;
-		std::string tbar_colour = "colour.topbar"_theme;
-		std::string bbar_colour = "colour.bottombar"_theme;
 		std::string net_top = inst::config::appDir + "bg_images.net_top"_theme;
 		std::string default_background = inst::config::appDir + "bg_images.default_background"_theme;
-		std::string pageinfo_colour = "colour.pageinfo_text"_theme;
-		std::string bottombar_text = "colour.bottombar_text"_theme;
-		std::string background_overlay1 = "colour.background_overlay1"_theme;
-		std::string background_overlay2 = "colour.background_overlay2"_theme;
-		std::string focus = "colour.focus"_theme;
-		std::string scrollbar = "colour.scrollbar"_theme;
 		std::string waiting = inst::config::appDir + "icons_others.waiting_lan"_theme;
 
 
-		if (net_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json")) this->infoRect = Rectangle::New(0, 95, 1280, 60, COLOR(infoRect_colour));
-		else this->infoRect = Rectangle::New(0, 95, 1280, 60, COLOR("#00000080"));
+		this->infoRect = Rectangle::New(0, 95, 1280, 60, Theme::Colour("colour.inforect", "#00000080"));
 
-		if (net_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json")) this->SetBackgroundColor(COLOR(bg_colour));
-		else this->SetBackgroundColor(COLOR("#000000FF"));
+		this->SetBackgroundColor(Theme::Colour("colour.background", "#000000FF"));
 
-		if (net_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json")) this->topRect = Rectangle::New(0, 0, 1280, 94, COLOR(tbar_colour));
-		else this->topRect = Rectangle::New(0, 0, 1280, 94, COLOR("#000000FF"));
+		this->topRect = Rectangle::New(0, 0, 1280, 94, Theme::Colour("colour.topbar", "#000000FF"));
 
-		if (net_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json")) this->botRect = Rectangle::New(0, 659, 1280, 61, COLOR(bbar_colour));
-		else this->botRect = Rectangle::New(0, 659, 1280, 61, COLOR("#000000FF"));
+		this->botRect = Rectangle::New(0, 659, 1280, 61, Theme::Colour("colour.bottombar", "#000000FF"));
 
-		if (net_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json") && std::filesystem::exists(net_top)) this->titleImage = Image::New(0, 0, (net_top));
+		if (Theme::HasAsset("bg_images.net_top")) this->titleImage = Image::New(0, 0, (net_top));
 		else this->titleImage = Image::New(0, 0, "romfs:/images/Net.png");
 
-		if (net_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json") && std::filesystem::exists(default_background)) this->SetBackgroundImage(default_background);
+		if (Theme::HasAsset("bg_images.default_background")) this->SetBackgroundImage(default_background);
 		else this->SetBackgroundImage("romfs:/images/Background.png");
 
 		this->pageInfoText = TextBlock::New(10, 109, "inst.hd.top_info"_lang);
 		this->pageInfoText->SetFont(pu::ui::MakeDefaultFontName(30));
 
-		if (net_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json")) this->pageInfoText->SetColor(COLOR(pageinfo_colour));
-		else this->pageInfoText->SetColor(COLOR("#FFFFFFFF"));
+		this->pageInfoText->SetColor(Theme::Colour("colour.pageinfo_text", "#FFFFFFFF"));
 
 		this->butText = TextBlock::New(10, 678, "inst.hd.buttons"_lang);
 
-		if (net_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json")) this->butText->SetColor(COLOR(bottombar_text));
-		else this->butText->SetColor(COLOR("#FFFFFFFF"));
+		this->butText->SetColor(Theme::Colour("colour.bottombar_text", "#FFFFFFFF"));
 
-		if (net_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json")) this->menu = pu::ui::elm::Menu::New(0, 156, 1280, COLOR(background_overlay1), COLOR(background_overlay2), 84, (506 / 84));
-		else this->menu = pu::ui::elm::Menu::New(0, 156, 1280, COLOR("#FFFFFF00"), COLOR("#4f4f4d33"), 84, (506 / 84));
+		this->menu = pu::ui::elm::Menu::New(0, 156, 1280, Theme::Colour("colour.background_overlay1", "#FFFFFF00"), Theme::Colour("colour.background_overlay2", "#4f4f4d33"), 84, (506 / 84));
 
-		if (net_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json")) this->menu->SetItemsFocusColor(COLOR(focus));
-		else this->menu->SetItemsFocusColor(COLOR("#4f4f4dAA"));
+		this->menu->SetItemsFocusColor(Theme::Colour("colour.focus", "#4f4f4dAA"));
 
-		if (net_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json")) this->menu->SetScrollbarColor(COLOR(scrollbar));
-		else this->menu->SetScrollbarColor(COLOR("#1A1919FF"));
+		this->menu->SetScrollbarColor(Theme::Colour("colour.scrollbar", "#1A1919FF"));
 
-		if (net_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json") && std::filesystem::exists(waiting)) this->infoImage = Image::New(453, 292, waiting);
+		if (Theme::HasAsset("icons_others.waiting_lan")) this->infoImage = Image::New(453, 292, waiting);
 		else this->infoImage = Image::New(453, 292, "romfs:/images/icons/lan-connection-waiting.png");
 
 		this->Add(this->topRect);
@@ -103,93 +82,49 @@ namespace inst::ui {
 	}
 
 	void netInstPage::drawMenuItems_withext(bool clearItems) {
-		int myindex = this->menu->GetSelectedIndex(); //store index so when page redraws we can get the last item we checked.
-		if (clearItems) this->selectedUrls = {};
-		if (clearItems) this->alternativeNames = {};
-		std::string itm;
-		std::string text_colour = "colour.main_text"_theme;
-
-		this->menu->ClearItems();
-		for (auto& urls : this->ourUrls) {
-			itm = inst::util::shortenString(inst::util::formatUrlString(urls), 56, true);
-			auto ourEntry = pu::ui::elm::MenuItem::New(itm);
-
-			if (net_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json")) ourEntry->SetColor(COLOR(text_colour));
-			else ourEntry->SetColor(COLOR("#FFFFFFFF"));
-
-			ourEntry->SetIcon(unchecked_net);
-			long unsigned int i;
-			for (i = 0; i < this->selectedUrls.size(); i++) {
-				if (this->selectedUrls[i] == urls) {
-					ourEntry->SetIcon(checked_net);
-				}
-			}
-			this->menu->AddItem(ourEntry);
-			this->menu->SetSelectedIndex(myindex); //jump to the index we saved from above
-		}
+		this->showExtension = true;
+		this->setMenuSource(clearItems);
 	}
 
 	void netInstPage::drawMenuItems(bool clearItems) {
+		this->showExtension = false;
+		this->setMenuSource(clearItems);
+	}
+
+	void netInstPage::setMenuSource(bool clearItems) {
 		int myindex = this->menu->GetSelectedIndex(); //store index so when page redraws we can get the last item we checked.
 		if (clearItems) this->selectedUrls = {};
 		if (clearItems) this->alternativeNames = {};
-		std::string itm;
-		std::string text_colour = "colour.main_text"_theme;
+		// Rows are only built for the visible part of the list, see makeMenuItem
+		this->menu->SetItemSource(this->ourUrls.size(), std::bind(&netInstPage::makeMenuItem, this, std::placeholders::_1));
+		if (this->ourUrls.size()) this->menu->SetSelectedIndex(myindex); //jump to the index we saved from above
+	}
 
-		//Degug code to print out and sort a list of the files on the http server.
-		/*
-		for (auto& xy: this->ourUrls) {
-			std::string base_filename = xy.substr(xy.find_last_of("/") + 1); //just get the filename
+	pu::ui::elm::MenuItem::Ref netInstPage::makeMenuItem(u32 index) {
+		auto& url = this->ourUrls[index];
+		std::string itm;
+		if (this->showExtension) itm = inst::util::shortenString(inst::util::formatUrlString(url), 56, true);
+		else {
+			std::string base_filename = url.substr(url.find_last_of("/") + 1); //just get the filename
 			std::string::size_type const p(base_filename.find_last_of('.'));
 			std::string file_without_extension = base_filename.substr(0, p); //strip of file extension
 			itm = inst::util::shortenString(inst::util::formatUrlString(file_without_extension), 56, true);
-			modded.push_back(itm);
-			std::sort(modded.begin(), modded.end());
 		}
 
-		for (auto& yz: this->modded) {
-			FILE * fp;
-			fp = fopen ("gamelist.txt", "a+");
-			auto *info = yz.c_str();
-			fprintf(fp, "%s\n", info);
-			fclose(fp);
-		}
-		*/
-
-		this->menu->ClearItems();
-		for (auto& urls : this->ourUrls) {
-			//Alt code to remove file extension from the item shown on the screen
-			std::string base_filename = urls.substr(urls.find_last_of("/") + 1); //just get the filename
-			std::string::size_type const p(base_filename.find_last_of('.'));
-			std::string file_without_extension = base_filename.substr(0, p); //strip of file extension
-			itm = inst::util::shortenString(inst::util::formatUrlString(file_without_extension), 56, true);
-			//itm = inst::util::shortenString(inst::util::formatUrlString(urls), 56, true); 
-			auto ourEntry = pu::ui::elm::MenuItem::New(itm);
+		auto ourEntry = pu::ui::elm::MenuItem::New(itm);
+		ourEntry->SetColor(Theme::Colour("colour.main_text", "#FFFFFFFF"));
 
-			if (net_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json")) ourEntry->SetColor(COLOR(text_colour));
-			else ourEntry->SetColor(COLOR("#FFFFFFFF"));
-
-			ourEntry->SetIcon(unchecked_net);
-			long unsigned int i;
-			for (i = 0; i < this->selectedUrls.size(); i++) {
-				if (this->selectedUrls[i] == urls) {
-					ourEntry->SetIcon(checked_net);
-				}
-			}
-			this->menu->AddItem(ourEntry);
-			this->menu->SetSelectedIndex(myindex); //jump to the index we saved from above
-		}
+		if (std::find(this->selectedUrls.begin(), this->selectedUrls.end(), url) != this->selectedUrls.end()) ourEntry->SetIcon(checked_net);
+		else ourEntry->SetIcon(unchecked_net);
+		return ourEntry;
 	}
 
 	void netInstPage::selectTitle(int selectedIndex) {
-		if (this->menu->GetItems()[selectedIndex]->GetIconPath() == checked_net) {
-			for (long unsigned int i = 0; i < this->selectedUrls.size(); i++) {
-				if (this->selectedUrls[i] == this->ourUrls[selectedIndex]) this->selectedUrls.erase(this->selectedUrls.begin() + i);
-			}
-		}
-
-		else this->selectedUrls.push_back(this->ourUrls[selectedIndex]);
-		this->drawMenuItems(false);
+		auto& url = this->ourUrls[selectedIndex];
+		auto selected = std::find(this->selectedUrls.begin(), this->selectedUrls.end(), url);
+		if (selected != this->selectedUrls.end()) this->selectedUrls.erase(selected);
+		else this->selectedUrls.push_back(url);
+		this->menu->InvalidateItems();
 	}
 
 	void netInstPage::startNetwork() {
@@ -207,10 +142,7 @@ namespace inst::ui {
 
 		else if (this->ourUrls[0] == "supplyUrl") {
 			std::string keyboardResult;
-			std::string update = "romfs:/images/icons/update.png";
-			if (net_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json") && std::filesystem::exists(inst::config::appDir + "icons_others.update"_theme)) {
-				update = inst::config::appDir + "icons_others.update"_theme;
-			}
+			std::string update = Theme::Asset("icons_others.update", "romfs:/images/icons/update.png");
 			switch (mainApp->CreateShowDialog("inst.net.src.title"_lang, "common.cancel_desc"_lang, { "inst.net.src.opt0"_lang, "inst.net.src.opt1"_lang }, false, update)) {
 			case 0:
 				keyboardResult = inst::util::softwareKeyboard("inst.net.url.hint"_lang, inst::config::httplastUrl, 500);
@@ -226,10 +158,7 @@ namespace inst::ui {
 					}
 
 					if (inst::util::formatUrlString(keyboardResult) == "" || keyboardResult == "https://" || keyboardResult == "http://") {
-						std::string fail = "romfs:/images/icons/fail.png";
-						if (net_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json") && std::filesystem::exists(inst::config::appDir + "icons_others.fail"_theme)) {
-							fail = inst::config::appDir + "icons_others.fail"_theme;
-						}
+						std::string fail = Theme::Asset("icons_others.fail", "romfs:/images/icons/fail.png");
 						mainApp->CreateShowDialog("inst.net.url.invalid"_lang, "", { "common.ok"_lang }, false, fail);
 						break;
 					}
@@ -273,10 +202,7 @@ namespace inst::ui {
 
 	void netInstPage::startInstall(bool urlMode) {
 		int dialogResult = -1;
-		std::string install = "romfs:/images/icons/install.png";
-		if (net_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json") && std::filesystem::exists(inst::config::appDir + "icons_others.install"_theme)) {
-			install = inst::config::appDir + "icons_others.install"_theme;
-		}
+		std::string install = Theme::Asset("icons_others.install", "romfs:/images/icons/install.png");
 
 		if (this->selectedUrls.size() == 1) {
 			std::string ourUrlString;
@@ -313,11 +239,11 @@ namespace inst::ui {
 					xxx = state.count;
 
 					if (xxx != 1) {
-						int var = this->menu->GetItems().size();
+						int var = this->menu->GetTotalItemCount();
 						auto s = std::to_string(var);
 						if (s != "0") {
 							this->selectTitle(this->menu->GetSelectedIndex());
-							if (this->menu->GetItems().size() == 1 && this->selectedUrls.size() == 1) {
+							if (this->menu->GetTotalItemCount() == 1 && this->selectedUrls.size() == 1) {
 								this->startInstall(false);
 							}
 						}
@@ -330,11 +256,11 @@ namespace inst::ui {
 				xxx = state.count;
 
 				if (xxx != 1) {
-					int var = this->menu->GetItems().size();
+					int var = this->menu->GetTotalItemCount();
 					auto s = std::to_string(var);
 					if (s != "0") {
 						this->selectTitle(this->menu->GetSelectedIndex());
-						if (this->menu->GetItems().size() == 1 && this->selectedUrls.size() == 1) {
+						if (this->menu->GetTotalItemCount() == 1 && this->selectedUrls.size() == 1) {
 							this->startInstall(false);
 						}
 					}
@@ -344,18 +270,18 @@ namespace inst::ui {
 
 
 		if ((Down & HidNpadButton_Y)) {
-			if (this->selectedUrls.size() == this->menu->GetItems().size()) this->drawMenuItems(true);
+			if (this->selectedUrls.size() == this->ourUrls.size()) this->drawMenuItems(true);
 			else {
-				for (long unsigned int i = 0; i < this->menu->GetItems().size(); i++) {
-					if (this->menu->GetItems()[i]->GetIconPath() == checked_net) continue;
-					else this->selectTitle(i);
+				std::set<std::string> selected(this->selectedUrls.begin(), this->selectedUrls.end());
+				for (auto& url : this->ourUrls) {
+					if (selected.insert(url).second) this->selectedUrls.push_back(url);
 				}
-				this->drawMenuItems(false);
+				this->menu->InvalidateItems();
 			}
 		}
 
 		if (Down & HidNpadButton_Plus) {
-			int var = this->menu->GetItems().size();
+			int var = this->menu->GetTotalItemCount();
 			auto s = std::to_string(var);
 
 			if (s != "0") {
@@ -372,18 +298,18 @@ namespace inst::ui {
 			this->menu->SetSelectedIndex(std::max(0, this->menu->GetSelectedIndex() - 6));
 
 		if (Down & HidNpadButton_ZR)
-			this->menu->SetSelectedIndex(std::min((s32)this->menu->GetItems().size() - 1, this->menu->GetSelectedIndex() + 6));
+			this->menu->SetSelectedIndex(std::min((s32)this->menu->GetTotalItemCount() - 1, this->menu->GetSelectedIndex() + 6));
 
 		//goto top of list	
 		if (Down & HidNpadButton_L) {
-			int x = this->menu->GetItems().size() - 1;
+			int x = this->menu->GetTotalItemCount() - 1;
 			this->menu->SetSelectedIndex(std::max(0, this->menu->GetSelectedIndex() - x));
 		}
 
 		//goto bottom of list
 		if (Down & HidNpadButton_R) {
-			int x = this->menu->GetItems().size() - 1;
-			this->menu->SetSelectedIndex(std::min((s32)this->menu->GetItems().size() - 1, this->menu->GetSelectedIndex() + x));
+			int x = this->menu->GetTotalItemCount() - 1;
+			this->menu->SetSelectedIndex(std::min((s32)this->menu->GetTotalItemCount() - 1, this->menu->GetSelectedIndex() + x));
 		}
 
 		//don't show file extensions
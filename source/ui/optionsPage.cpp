@@ -12,75 +12,52 @@
 #include "util/curl.hpp"
 #include "util/unzip.hpp"
 #include "util/lang.hpp"
+#include "util/placeholder_gc.hpp"
 #include "ui/instPage.hpp"
 #include "sigInstall.hpp"
 #include "util/theme.hpp"
 
-#define COLOR(hex) pu::ui::Color::FromHex(hex)
-
 namespace inst::ui {
 	extern MainApplication* mainApp;
 	std::string op_root = inst::config::appDir + "/theme";
-	bool op_theme = util::themeit(op_root); //check if we have a previous theme directory first.
 	s32 prev_touchcount = 0;
 	std::string flag = "romfs:/images/flags/en.png";
 	std::vector<std::string> languageStrings = { "Sys", "En", "Jpn", "Fr", "De", "It", "Ru", "Es", "Tw", "Cn" };
 
 	optionsPage::optionsPage() : Layout::Layout() {
-		std::string infoRect_colour = "colour.inforect"_theme;
-		std::string bg_colour = "colour.background"_theme;
-		std::string tbar_colour = "colour.topbar"_theme;
-		std::string bbar_colour = "colour.bottombar"_theme;
 		std::string settings_top = inst::config::appDir + "bg_images.settings_top"_theme;
 		std::string default_background = inst::config::appDir + "bg_images.default_background"_theme;
-		std::string version = "colour.version"_theme;
-		std::string pageinfo_colour = "colour.pageinfo_text"_theme;
-		std::string bottombar_text = "colour.bottombar_text"_theme;
-		std::string background_overlay1 = "colour.background_overlay1"_theme;
-		std::string background_overlay2 = "colour.background_overlay2"_theme;
-		std::string focus = "colour.focus"_theme;
-		std::string scrollbar = "colour.scrollbar"_theme;
 
-		if (op_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json")) this->infoRect = Rectangle::New(0, 95, 1280, 60, COLOR(infoRect_colour));
-		else this->infoRect = Rectangle::New(0, 95, 1280, 60, COLOR("#00000080"));
+		this->infoRect = Rectangle::New(0, 95, 1280, 60, Theme::Colour("colour.inforect", "#00000080"));
 
-		if (op_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json")) this->SetBackgroundColor(COLOR(bg_colour));
-		else this->SetBackgroundColor(COLOR("#000000FF"));
+		this->SetBackgroundColor(Theme::Colour("colour.background", "#000000FF"));
 
-		if (op_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json")) this->topRect = Rectangle::New(0, 0, 1280, 94, COLOR(tbar_colour));
-		else this->topRect = Rectangle::New(0, 0, 1280, 94, COLOR("#000000FF"));
+		this->topRect = Rectangle::New(0, 0, 1280, 94, Theme::Colour("colour.topbar", "#000000FF"));
 
-		if (op_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json")) this->botRect = Rectangle::New(0, 659, 1280, 61, COLOR(bbar_colour));
-		else this->botRect = Rectangle::New(0, 659, 1280, 61, COLOR("#000000FF"));
+		this->botRect = Rectangle::New(0, 659, 1280, 61, Theme::Colour("colour.bottombar", "#000000FF"));
 
-		if (op_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json") && std::filesystem::exists(settings_top)) this->titleImage = Image::New(0, 0, (settings_top));
+		if (Theme::HasAsset("bg_images.settings_top")) this->titleImage = Image::New(0, 0, (settings_top));
 		else this->titleImage = Image::New(0, 0, "romfs:/images/Settings.png");
 
-		if (op_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json") && std::filesystem::exists(default_background)) this->SetBackgroundImage(default_background);
+		if (Theme::HasAsset("bg_images.default_background")) this->SetBackgroundImage(default_background);
 		else this->SetBackgroundImage("romfs:/images/Background.png");
 
 		this->appVersionText = TextBlock::New(1200, 680, "v" + inst::config::appVersion);
-		if (op_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json")) this->appVersionText->SetColor(COLOR(version));
-		else this->appVersionText->SetColor(COLOR("#FFFFFFFF"));
+		this->appVersionText->SetColor(Theme::Colour("colour.version", "#FFFFFFFF"));
 		this->appVersionText->SetFont(pu::ui::MakeDefaultFontName(20));
 
 		this->pageInfoText = TextBlock::New(10, 109, "options.title"_lang);
 		this->pageInfoText->SetFont(pu::ui::MakeDefaultFontName(30));
-		if (op_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json")) this->pageInfoText->SetColor(COLOR(pageinfo_colour));
-		else this->pageInfoText->SetColor(COLOR("#FFFFFFFF"));
+		this->pageInfoText->SetColor(Theme::Colour("colour.pageinfo_text", "#FFFFFFFF"));
 
 		this->butText = TextBlock::New(10, 678, "options.buttons"_lang);
-		if (op_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json")) this->butText->SetColor(COLOR(bottombar_text));
-		else this->butText->SetColor(COLOR("#FFFFFFFF"));
+		this->butText->SetColor(Theme::Colour("colour.bottombar_text", "#FFFFFFFF"));
 
-		if (op_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json")) this->menu = pu::ui::elm::Menu::New(0, 156, 1280, COLOR(background_overlay1), COLOR(background_overlay2), 84, (506 / 84));
-		else this->menu = pu::ui::elm::Menu::New(0, 156, 1280, COLOR("#FFFFFF00"), COLOR("#4f4f4d33"), 84, (506 / 84));
+		this->menu = pu::ui::elm::Menu::New(0, 156, 1280, Theme::Colour("colour.background_overlay1", "#FFFFFF00"), Theme::Colour("colour.background_overlay2", "#4f4f4d33"), 84, (506 / 84));
 
-		if (op_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json")) this->menu->SetItemsFocusColor(COLOR(focus));
-		else this->menu->SetItemsFocusColor(COLOR("#4f4f4dAA"));
+		this->menu->SetItemsFocusColor(Theme::Colour("colour.focus", "#4f4f4dAA"));
 
-		if (op_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json")) this->menu->SetScrollbarColor(COLOR(scrollbar));
-		else this->menu->SetScrollbarColor(COLOR("#1A1919FF"));
+		this->menu->SetScrollbarColor(Theme::Colour("colour.scrollbar", "#1A1919FF"));
 
 		this->Add(this->topRect);
 		this->Add(this->infoRect);
@@ -94,10 +71,7 @@ namespace inst::ui {
 	}
 	void optionsPage::askToUpdate(std::vector<std::string> updateInfo) {
 
-		std::string update = "romfs:/images/icons/update.png";
-		if (op_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json") && std::filesystem::exists(inst::config::appDir + "icons_others.update"_theme)) {
-			update = inst::config::appDir + "icons_others.update"_theme;
-		}
+		std::string update = Theme::Asset("icons_others.update", "romfs:/images/icons/update.png");
 
 		if (!mainApp->CreateShowDialog("options.update.title"_lang, "options.update.desc0"_lang + updateInfo[0] + "options.update.desc1"_lang, { "options.update.opt0"_lang, "common.cancel"_lang }, false, update)) {
 			inst::ui::instPage::loadInstallScreen();
@@ -113,16 +87,14 @@ namespace inst::ui {
 				std::filesystem::remove(downloadName);
 				//remove theme from tinwoo to prevent errors, users can download again after the update
 				util::remove_theme(op_root);
+				Theme::Load();
 				inst::ui::instPage::setInstInfoText("theme.warning2"_lang);
 				mainApp->CreateShowDialog("options.update.complete"_lang, "options.update.end_desc"_lang, { "common.ok"_lang }, false, "romfs:/images/icons/update.png");
 				mainApp->FadeOut();
 				mainApp->Close();
 			}
 			catch (...) {
-				std::string fail = "romfs:/images/icons/fail.png";
-				if (op_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json") && std::filesystem::exists(inst::config::appDir + "icons_others.fail"_theme)) {
-					fail = inst::config::appDir + "icons_others.fail"_theme;
-				}
+				std::string fail = Theme::Asset("icons_others.fail", "romfs:/images/icons/fail.png");
 				mainApp->CreateShowDialog("options.update.failed"_lang, "options.update.end_desc"_lang, { "common.ok"_lang }, false, fail);
 				return;
 			}
@@ -131,14 +103,8 @@ namespace inst::ui {
 	}
 
 	std::string optionsPage::getMenuOptionIcon(bool ourBool) {
-		std::string checked = "romfs:/images/icons/checked.png";
-		if (op_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json") && std::filesystem::exists(inst::config::appDir + "icons_settings.check_on"_theme)) {
-			checked = inst::config::appDir + "icons_settings.check_on"_theme;
-		}
-		std::string unchecked = "romfs:/images/icons/unchecked.png";
-		if (op_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json") && std::filesystem::exists(inst::config::appDir + "icons_settings.check_off"_theme)) {
-			unchecked = inst::config::appDir + "icons_settings.check_off"_theme;
-		}
+		std::string checked = Theme::Asset("icons_settings.check_on", "romfs:/images/icons/checked.png");
+		std::string unchecked = Theme::Asset("icons_settings.check_off", "romfs:/images/icons/unchecked.png");
 		if (ourBool) return checked;
 		else return unchecked;
 	}
@@ -155,35 +121,35 @@ namespace inst::ui {
 		std::string tw = "romfs:/images/flags/tw.png";
 		std::string cn = "romfs:/images/flags/cn.png";
 		//
-		if (op_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json") && std::filesystem::exists(inst::config::appDir + "icons_flags.sys"_theme)) {
+		if (Theme::HasAsset("icons_flags.sys")) {
 			sys = inst::config::appDir + "icons_flags.sys"_theme;
 		}
-		if (op_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json") && std::filesystem::exists(inst::config::appDir + "icons_flags.en"_theme)) {
+		if (Theme::HasAsset("icons_flags.en")) {
 			en = inst::config::appDir + "icons_flags.en"_theme;
 		}
-		if (op_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json") && std::filesystem::exists(inst::config::appDir + "icons_flags.jpn"_theme)) {
+		if (Theme::HasAsset("icons_flags.jpn")) {
 			jpn = inst::config::appDir + "icons_flags.jpn"_theme;
 		}
-		if (op_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json") && std::filesystem::exists(inst::config::appDir + "icons_flags.fr"_theme)) {
+		if (Theme::HasAsset("icons_flags.fr")) {
 			fr = inst::config::appDir + "icons_flags.fr"_theme;
 		}
-		if (op_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json") && std::filesystem::exists(inst::config::appDir + "icons_flags.de"_theme)) {
+		if (Theme::HasAsset("icons_flags.de")) {
 			de = inst::config::appDir + "icons_flags.de"_theme;
 		}
-		if (op_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json") && std::filesystem::exists(inst::config::appDir + "icons_flags.it"_theme)) {
+		if (Theme::HasAsset("icons_flags.it")) {
 			it = inst::config::appDir + "icons_flags.it"_theme;
 		}
-		if (op_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json") && std::filesystem::exists(inst::config::appDir + "icons_flags.ru"_theme)) {
+		if (Theme::HasAsset("icons_flags.ru")) {
 			ru = inst::config::appDir + "icons_flags.ru"_theme;
 		}
-		if (op_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json") && std::filesystem::exists(inst::config::appDir + "icons_flags.es"_theme)) {
+		if (Theme::HasAsset("icons_flags.es")) {
 			es = inst::config::appDir + "icons_flags.es"_theme;
 		}
-		if (op_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json") && std::filesystem::exists(inst::config::appDir + "icons_flags.tw"_theme)) {
+		if (Theme::HasAsset("icons_flags.tw")) {
 			tw = inst::config::appDir + "icons_flags.tw"_theme;
 		}
 		/* temp comment out until next update
-		if (op_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json") && std::filesystem::exists(inst::config::appDir + "icons_flags.cn"_theme)) {
+		if (Theme::HasAsset("icons_flags.cn")) {
 			cn = inst::config::appDir + "icons_flags.cn"_theme;
 		}
 		*/
@@ -211,10 +177,7 @@ namespace inst::ui {
 	}
 
 	void thememessage() {
-		std::string theme = "romfs:/images/icons/theme.png";
-		if (op_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json") && std::filesystem::exists(inst::config::appDir + "icons_others.theme"_theme)) {
-			theme = inst::config::appDir + "icons_others.theme"_theme;
-		}
+		std::string theme = Theme::Asset("icons_others.theme", "romfs:/images/icons/theme.png");
 		int ourResult = inst::ui::mainApp->CreateShowDialog("theme.title"_lang, "theme.desc"_lang, { "common.no"_lang, "common.yes"_lang }, true, theme);
 		if (ourResult != 0) {
 			if (!inst::config::useTheme) {
@@ -233,10 +196,7 @@ namespace inst::ui {
 	}
 
 	void lang_message() {
-		std::string flag = "romfs:/images/icons/flags/sys.png";
-		if (op_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json") && std::filesystem::exists(inst::config::appDir + "icons_flags.sys"_theme)) {
-			flag = inst::config::appDir + "icons_flags.sys"_theme;
-		}
+		std::string flag = Theme::Asset("icons_flags.sys", "romfs:/images/icons/flags/sys.png");
 		int ourResult = inst::ui::mainApp->CreateShowDialog("sig.restart"_lang, "theme.restart"_lang, { "common.no"_lang, "common.yes"_lang }, true, flag);
 		if (ourResult != 0) {
 			mainApp->FadeOut();
@@ -244,153 +204,135 @@ namespace inst::ui {
 		}
 	}
 
+	void placeholderCleanup() {
+		std::string bin = Theme::Asset("icons_others.bin", "romfs:/images/icons/bin.png");
+		inst::placeholder_gc::WaitForBackgroundCollect();
+		auto report = inst::placeholder_gc::Scan();
+		if (!report.stale.count && !report.resumable.count && !report.foreign.count) {
+			mainApp->CreateShowDialog("options.cleanup.title"_lang, "options.cleanup.none"_lang, { "common.ok"_lang }, true, bin);
+			return;
+		}
+
+		std::string desc = "options.cleanup.stale"_lang + std::to_string(report.stale.bytes / 1000000) + " MB\n";
+		desc += "options.cleanup.resumable"_lang + std::to_string(report.resumable.bytes / 1000000) + " MB\n";
+		desc += "options.cleanup.foreign"_lang + std::to_string(report.foreign.bytes / 1000000) + " MB\n\n";
+		desc += "options.cleanup.desc"_lang;
+		int ourResult = mainApp->CreateShowDialog("options.cleanup.title"_lang, desc, { "common.cancel"_lang, "options.cleanup.opt0"_lang, "options.cleanup.opt1"_lang }, false, bin);
+		if (ourResult != 1 && ourResult != 2) return;
+
+		u64 freed = inst::placeholder_gc::Collect(ourResult == 2, ourResult == 2);
+		mainApp->CreateShowDialog("options.cleanup.title"_lang, "options.cleanup.done"_lang + std::to_string(freed / 1000000) + " MB", { "common.ok"_lang }, true, bin);
+	}
+
 	void optionsPage::setMenuText() {
-		std::string text_colour = "colour.main_text"_theme;
 		this->menu->ClearItems();
 
 		auto ignoreFirmOption = pu::ui::elm::MenuItem::New("options.menu_items.ignore_firm"_lang);
-		if (op_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json")) ignoreFirmOption->SetColor(COLOR(text_colour));
-		else ignoreFirmOption->SetColor(COLOR("#FFFFFFFF"));
+		ignoreFirmOption->SetColor(Theme::Colour("colour.main_text", "#FFFFFFFF"));
 		ignoreFirmOption->SetIcon(this->getMenuOptionIcon(inst::config::ignoreReqVers));
 		this->menu->AddItem(ignoreFirmOption);
 
 		auto validateOption = pu::ui::elm::MenuItem::New("options.menu_items.nca_verify"_lang);
-		if (op_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json")) validateOption->SetColor(COLOR(text_colour));
-		else validateOption->SetColor(COLOR("#FFFFFFFF"));
+		validateOption->SetColor(Theme::Colour("colour.main_text", "#FFFFFFFF"));
 		validateOption->SetIcon(this->getMenuOptionIcon(inst::config::validateNCAs));
 		this->menu->AddItem(validateOption);
 
 		auto overclockOption = pu::ui::elm::MenuItem::New("options.menu_items.boost_mode"_lang);
-		if (op_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json")) overclockOption->SetColor(COLOR(text_colour));
-		else overclockOption->SetColor(COLOR("#FFFFFFFF"));
+		overclockOption->SetColor(Theme::Colour("colour.main_text", "#FFFFFFFF"));
 		overclockOption->SetIcon(this->getMenuOptionIcon(inst::config::overClock));
 		this->menu->AddItem(overclockOption);
 
 		auto deletePromptOption = pu::ui::elm::MenuItem::New("options.menu_items.ask_delete"_lang);
-		if (op_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json")) deletePromptOption->SetColor(COLOR(text_colour));
-		else deletePromptOption->SetColor(COLOR("#FFFFFFFF"));
+		deletePromptOption->SetColor(Theme::Colour("colour.main_text", "#FFFFFFFF"));
 		deletePromptOption->SetIcon(this->getMenuOptionIcon(inst::config::deletePrompt));
 		this->menu->AddItem(deletePromptOption);
 
 		auto autoUpdateOption = pu::ui::elm::MenuItem::New("options.menu_items.auto_update"_lang);
-		if (op_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json")) autoUpdateOption->SetColor(COLOR(text_colour));
-		else autoUpdateOption->SetColor(COLOR("#FFFFFFFF"));
+		autoUpdateOption->SetColor(Theme::Colour("colour.main_text", "#FFFFFFFF"));
 		autoUpdateOption->SetIcon(this->getMenuOptionIcon(inst::config::autoUpdate));
 		this->menu->AddItem(autoUpdateOption);
 
 		auto useSoundOption = pu::ui::elm::MenuItem::New("options.menu_items.useSound"_lang);
-		if (op_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json")) useSoundOption->SetColor(COLOR(text_colour));
-		else useSoundOption->SetColor(COLOR("#FFFFFFFF"));
+		useSoundOption->SetColor(Theme::Colour("colour.main_text", "#FFFFFFFF"));
 		useSoundOption->SetIcon(this->getMenuOptionIcon(inst::config::useSound));
 		this->menu->AddItem(useSoundOption);
 
 		auto useMusicOption = pu::ui::elm::MenuItem::New("options.menu_items.useMusic"_lang);
-		if (op_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json")) useMusicOption->SetColor(COLOR(text_colour));
-		else useMusicOption->SetColor(COLOR("#FFFFFFFF"));
+		useMusicOption->SetColor(Theme::Colour("colour.main_text", "#FFFFFFFF"));
 		useMusicOption->SetIcon(this->getMenuOptionIcon(inst::config::useMusic));
 		this->menu->AddItem(useMusicOption);
 
 		auto fixticket = pu::ui::elm::MenuItem::New("options.menu_items.fixticket"_lang);
-		if (op_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json")) fixticket->SetColor(COLOR(text_colour));
-		else fixticket->SetColor(COLOR("#FFFFFFFF"));
+		fixticket->SetColor(Theme::Colour("colour.main_text", "#FFFFFFFF"));
 		fixticket->SetIcon(this->getMenuOptionIcon(inst::config::fixticket));
 		this->menu->AddItem(fixticket);
 
 		auto listoveride = pu::ui::elm::MenuItem::New("options.menu_items.listoveride"_lang);
-		if (op_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json")) listoveride->SetColor(COLOR(text_colour));
-		else listoveride->SetColor(COLOR("#FFFFFFFF"));
+		listoveride->SetColor(Theme::Colour("colour.main_text", "#FFFFFFFF"));
 		listoveride->SetIcon(this->getMenuOptionIcon(inst::config::listoveride));
 		this->menu->AddItem(listoveride);
 
 		auto httpkeyboard = pu::ui::elm::MenuItem::New("options.menu_items.usehttpkeyboard"_lang);
-		if (op_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json")) httpkeyboard->SetColor(COLOR(text_colour));
-		else httpkeyboard->SetColor(COLOR("#FFFFFFFF"));
+		httpkeyboard->SetColor(Theme::Colour("colour.main_text", "#FFFFFFFF"));
 		httpkeyboard->SetIcon(this->getMenuOptionIcon(inst::config::httpkeyboard));
 		this->menu->AddItem(httpkeyboard);
 
 		auto useThemeOption = pu::ui::elm::MenuItem::New("theme.theme_option"_lang);
-		if (op_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json")) useThemeOption->SetColor(COLOR(text_colour));
-		else useThemeOption->SetColor(COLOR("#FFFFFFFF"));
+		useThemeOption->SetColor(Theme::Colour("colour.main_text", "#FFFFFFFF"));
 		useThemeOption->SetIcon(this->getMenuOptionIcon(inst::config::useTheme));
 		this->menu->AddItem(useThemeOption);
 
 		auto ThemeMenuOption = pu::ui::elm::MenuItem::New("theme.theme_menu"_lang);
-		if (op_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json")) ThemeMenuOption->SetColor(COLOR(text_colour));
-		else ThemeMenuOption->SetColor(COLOR("#FFFFFFFF"));
-		std::string thememenu = "romfs:/images/icons/thememenu.png";
-		if (op_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json") && std::filesystem::exists(inst::config::appDir + "icons_settings.theme_dl"_theme)) {
-			thememenu = inst::config::appDir + "icons_settings.theme_dl"_theme;
-		}
+		ThemeMenuOption->SetColor(Theme::Colour("colour.main_text", "#FFFFFFFF"));
+		std::string thememenu = Theme::Asset("icons_settings.theme_dl", "romfs:/images/icons/thememenu.png");
 		ThemeMenuOption->SetIcon(thememenu);
 		this->menu->AddItem(ThemeMenuOption);
 
 		auto ThemeUrlOption = pu::ui::elm::MenuItem::New("theme.theme_url"_lang + inst::util::shortenString(inst::config::httplastUrl2, 42, false));
-		if (op_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json")) ThemeUrlOption->SetColor(COLOR(text_colour));
-		else ThemeUrlOption->SetColor(COLOR("#FFFFFFFF"));
-		std::string themeurl = "romfs:/images/icons/themeurl.png";
-		if (op_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json") && std::filesystem::exists(inst::config::appDir + "icons_settings.theme_server"_theme)) {
-			themeurl = inst::config::appDir + "icons_settings.theme_server"_theme;
-		}
+		ThemeUrlOption->SetColor(Theme::Colour("colour.main_text", "#FFFFFFFF"));
+		std::string themeurl = Theme::Asset("icons_settings.theme_server", "romfs:/images/icons/themeurl.png");
 		ThemeUrlOption->SetIcon(themeurl);
 		this->menu->AddItem(ThemeUrlOption);
 
 		auto SigPatch = pu::ui::elm::MenuItem::New("main.menu.sig"_lang);
-		if (op_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json")) SigPatch->SetColor(COLOR(text_colour));
-		else SigPatch->SetColor(COLOR("#FFFFFFFF"));
-		std::string sigs = "romfs:/images/icons/plaster.png";
-		if (op_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json") && std::filesystem::exists(inst::config::appDir + "icons_settings.patches"_theme)) {
-			sigs = inst::config::appDir + "icons_settings.patches"_theme;
-		}
+		SigPatch->SetColor(Theme::Colour("colour.main_text", "#FFFFFFFF"));
+		std::string sigs = Theme::Asset("icons_settings.patches", "romfs:/images/icons/plaster.png");
 		SigPatch->SetIcon(sigs);
 		this->menu->AddItem(SigPatch);
 
 		auto sigPatchesUrlOption = pu::ui::elm::MenuItem::New("options.menu_items.sig_url"_lang + inst::util::shortenString(inst::config::sigPatchesUrl, 42, false));
-		if (op_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json")) sigPatchesUrlOption->SetColor(COLOR(text_colour));
-		else sigPatchesUrlOption->SetColor(COLOR("#FFFFFFFF"));
-		std::string sigsurl = "romfs:/images/icons/keyboard.png";
-		if (op_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json") && std::filesystem::exists(inst::config::appDir + "icons_settings.patches_server"_theme)) {
-			sigsurl = inst::config::appDir + "icons_settings.patches_server"_theme;
-		}
+		sigPatchesUrlOption->SetColor(Theme::Colour("colour.main_text", "#FFFFFFFF"));
+		std::string sigsurl = Theme::Asset("icons_settings.patches_server", "romfs:/images/icons/keyboard.png");
 		sigPatchesUrlOption->SetIcon(sigsurl);
 		this->menu->AddItem(sigPatchesUrlOption);
 
 		auto httpServerUrlOption = pu::ui::elm::MenuItem::New("options.menu_items.http_url"_lang + inst::util::shortenString(inst::config::httpIndexUrl, 42, false));
-		if (op_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json")) httpServerUrlOption->SetColor(COLOR(text_colour));
-		else httpServerUrlOption->SetColor(COLOR("#FFFFFFFF"));
-		std::string neturl = "romfs:/images/icons/url.png";
-		if (op_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json") && std::filesystem::exists(inst::config::appDir + "icons_settings.net_source"_theme)) {
-			neturl = inst::config::appDir + "icons_settings.net_source"_theme;
-		}
+		httpServerUrlOption->SetColor(Theme::Colour("colour.main_text", "#FFFFFFFF"));
+		std::string neturl = Theme::Asset("icons_settings.net_source", "romfs:/images/icons/url.png");
 		httpServerUrlOption->SetIcon(neturl);
 		this->menu->AddItem(httpServerUrlOption);
 
 		auto languageOption = pu::ui::elm::MenuItem::New("options.menu_items.language"_lang + this->getMenuLanguage(inst::config::languageSetting));
-		if (op_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json")) languageOption->SetColor(COLOR(text_colour));
-		else languageOption->SetColor(COLOR("#FFFFFFFF"));
-		std::string lang = "romfs:/images/icons/speak.png";
-		if (op_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json") && std::filesystem::exists(inst::config::appDir + "icons_settings.language"_theme)) {
-			lang = inst::config::appDir + "icons_settings.language"_theme;
-		}
+		languageOption->SetColor(Theme::Colour("colour.main_text", "#FFFFFFFF"));
+		std::string lang = Theme::Asset("icons_settings.language", "romfs:/images/icons/speak.png");
 		languageOption->SetIcon(lang);
 		this->menu->AddItem(languageOption);
 
+		auto cleanupOption = pu::ui::elm::MenuItem::New("options.menu_items.cleanup"_lang);
+		cleanupOption->SetColor(Theme::Colour("colour.main_text", "#FFFFFFFF"));
+		std::string cleanup = Theme::Asset("icons_others.bin", "romfs:/images/icons/bin.png");
+		cleanupOption->SetIcon(cleanup);
+		this->menu->AddItem(cleanupOption);
+
 		auto updateOption = pu::ui::elm::MenuItem::New("options.menu_items.check_update"_lang);
-		if (op_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json")) updateOption->SetColor(COLOR(text_colour));
-		else updateOption->SetColor(COLOR("#FFFFFFFF"));
-		std::string upd = "romfs:/images/icons/update2.png";
-		if (op_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json") && std::filesystem::exists(inst::config::appDir + "icons_settings.update"_theme)) {
-			upd = inst::config::appDir + "icons_settings.update"_theme;
-		}
+		updateOption->SetColor(Theme::Colour("colour.main_text", "#FFFFFFFF"));
+		std::string upd = Theme::Asset("icons_settings.update", "romfs:/images/icons/update2.png");
 		updateOption->SetIcon(upd);
 		this->menu->AddItem(updateOption);
 
 		auto creditsOption = pu::ui::elm::MenuItem::New("options.menu_items.credits"_lang);
-		if (op_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json")) creditsOption->SetColor(COLOR(text_colour));
-		else creditsOption->SetColor(COLOR("#FFFFFFFF"));
-		std::string credit = "romfs:/images/icons/credits2.png";
-		if (op_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json") && std::filesystem::exists(inst::config::appDir + "icons_settings.credits"_theme)) {
-			credit = inst::config::appDir + "icons_settings.credits"_theme;
-		}
+		creditsOption->SetColor(Theme::Colour("colour.main_text", "#FFFFFFFF"));
+		std::string credit = Theme::Asset("icons_settings.credits", "romfs:/images/icons/credits2.png");
 		creditsOption->SetIcon(credit);
 		this->menu->AddItem(creditsOption);
 	}
@@ -445,10 +387,7 @@ namespace inst::ui {
 						break;
 					case 1:
 						if (inst::config::validateNCAs) {
-							std::string info = "romfs:/images/icons/information.png";
-							if (op_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json") && std::filesystem::exists(inst::config::appDir + "icons_others.information"_theme)) {
-								info = inst::config::appDir + "icons_others.information"_theme;
-							}
+							std::string info = Theme::Asset("icons_others.information", "romfs:/images/icons/information.png");
 							if (inst::ui::mainApp->CreateShowDialog("options.nca_warn.title"_lang, "options.nca_warn.desc"_lang, { "common.cancel"_lang, "options.nca_warn.opt1"_lang }, false, info) == 1) inst::config::validateNCAs = false;
 						}
 						else inst::config::validateNCAs = true;
@@ -537,10 +476,7 @@ namespace inst::ui {
 						break;
 					case 11:
 						if (inst::util::getIPAddress() == "1.0.0.127") {
-							std::string info = "romfs:/images/icons/information.png";
-							if (op_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json") && std::filesystem::exists(inst::config::appDir + "icons_others.information"_theme)) {
-								info = inst::config::appDir + "icons_others.information"_theme;
-							}
+							std::string info = Theme::Asset("icons_others.information", "romfs:/images/icons/information.png");
 							inst::ui::mainApp->CreateShowDialog("main.net.title"_lang, "main.net.desc"_lang, { "common.ok"_lang }, true, info);
 							break;
 						}
@@ -619,27 +555,24 @@ namespace inst::ui {
 						lang_message();
 						break;
 					case 17:
+						placeholderCleanup();
+						break;
+					case 18:
 						if (inst::util::getIPAddress() == "1.0.0.127") {
-							std::string update = "romfs:/images/icons/update.png";
-							if (op_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json") && std::filesystem::exists(inst::config::appDir + "icons_others.update"_theme)) {
-								update = inst::config::appDir + "icons_others.update"_theme;
-							}
+							std::string update = Theme::Asset("icons_others.update", "romfs:/images/icons/update.png");
 							inst::ui::mainApp->CreateShowDialog("main.net.title"_lang, "main.net.desc"_lang, { "common.ok"_lang }, true, update);
 							break;
 						}
 						downloadUrl = inst::util::checkForAppUpdate();
 						if (!downloadUrl.size()) {
-							std::string fail = "romfs:/images/icons/fail.png";
-							if (op_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json") && std::filesystem::exists(inst::config::appDir + "icons_others.fail"_theme)) {
-								fail = inst::config::appDir + "icons_others.fail"_theme;
-							}
+							std::string fail = Theme::Asset("icons_others.fail", "romfs:/images/icons/fail.png");
 							mainApp->CreateShowDialog("options.update.title_check_fail"_lang, "options.update.desc_check_fail"_lang, { "common.ok"_lang }, false, fail);
 							break;
 						}
 						this->askToUpdate(downloadUrl);
 						break;
-					case 18:
-						if (op_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json") && std::filesystem::exists(inst::config::appDir + "icons_others.credits"_theme)) {
+					case 19:
+						if (Theme::HasAsset("icons_others.credits")) {
 							inst::ui::mainApp->CreateShowDialog("options.credits.title"_lang, "options.credits.desc"_lang, { "common.close"_lang }, true, inst::config::appDir + "icons_others.credits"_theme);
 						}
 						else {
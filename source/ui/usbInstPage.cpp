@@ -1,3 +1,5 @@
+#include <algorithm>
+#include <set>
 #include "ui/usbInstPage.hpp"
 #include "ui/MainApplication.hpp"
 #include "util/util.hpp"
@@ -7,81 +9,58 @@
 #include "util/theme.hpp"
 
 
-#define COLOR(hex) pu::ui::Color::FromHex(hex)
-
 namespace inst::ui {
 	extern MainApplication* mainApp;
 	s32 www = 0; //touchscreen variable
-	std::string usb_root = inst::config::appDir + "/theme";
-	bool usb_theme = util::themeit(usb_root); //check if we have a previous theme directory first.
 
 	std::string checked_usb = "romfs:/images/icons/check-box-outline.png";
 	std::string unchecked_usb = "romfs:/images/icons/checkbox-blank-outline.png";
 
 	void checkbox_usb() {
-		if (usb_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json") && std::filesystem::exists(inst::config::appDir + "icons_others.checkbox-checked"_theme)) {
+		if (Theme::HasAsset("icons_others.checkbox-checked")) {
 			checked_usb = inst::config::appDir + "icons_others.checkbox-checked"_theme;
 		}
-		if (usb_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json") && std::filesystem::exists(inst::config::appDir + "icons_others.checkbox-empty"_theme)) {
+		if (Theme::HasAsset("icons_others.checkbox-empty")) {
 			unchecked_usb = inst::config::appDir + "icons_others.checkbox-empty"_theme;
 		}
 	}
 
 	usbInstPage::usbInstPage() : Layout::Layout() {
-		std::string infoRect_colour = "colour.inforect"_theme;
-		std::string bg_colour = "colour.background"_theme;
-		std::string tbar_colour = "colour.topbar"_theme;
-		std::string bbar_colour = "colour.bottombar"_theme;
 		std::string usb_top = inst::config::appDir + "bg_images.usb_top"_theme;
 		std::string default_background = inst::config::appDir + "bg_images.default_background"_theme;
-		std::string pageinfo_colour = "colour.pageinfo_text"_theme;
-		std::string bottombar_text = "colour.bottombar_text"_theme;
-		std::string background_overlay1 = "colour.background_overlay1"_theme;
-		std::string background_overlay2 = "colour.background_overlay2"_theme;
-		std::string focus = "colour.focus"_theme;
-		std::string scrollbar = "colour.scrollbar"_theme;
 		std::string waiting = inst::config::appDir + "icons_others.waiting_usb"_theme;
 
 
-		if (usb_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json")) this->infoRect = Rectangle::New(0, 95, 1280, 60, COLOR(infoRect_colour));
-		else this->infoRect = Rectangle::New(0, 95, 1280, 60, COLOR("#00000080"));
+		this->infoRect = Rectangle::New(0, 95, 1280, 60, Theme::Colour("colour.inforect", "#00000080"));
 
-		if (usb_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json")) this->SetBackgroundColor(COLOR(bg_colour));
-		else this->SetBackgroundColor(COLOR("#000000FF"));
+		this->SetBackgroundColor(Theme::Colour("colour.background", "#000000FF"));
 
-		if (usb_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json")) this->topRect = Rectangle::New(0, 0, 1280, 94, COLOR(tbar_colour));
-		else this->topRect = Rectangle::New(0, 0, 1280, 94, COLOR("#000000FF"));
+		this->topRect = Rectangle::New(0, 0, 1280, 94, Theme::Colour("colour.topbar", "#000000FF"));
 
-		if (usb_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json")) this->botRect = Rectangle::New(0, 659, 1280, 61, COLOR(bbar_colour));
-		else this->botRect = Rectangle::New(0, 659, 1280, 61, COLOR("#000000FF"));
+		this->botRect = Rectangle::New(0, 659, 1280, 61, Theme::Colour("colour.bottombar", "#000000FF"));
 
-		if (usb_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json") && std::filesystem::exists(usb_top)) this->titleImage = Image::New(0, 0, (usb_top));
+		if (Theme::HasAsset("bg_images.usb_top")) this->titleImage = Image::New(0, 0, (usb_top));
 		else this->titleImage = Image::New(0, 0, "romfs:/images/Usb.png");
 
-		if (usb_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json") && std::filesystem::exists(default_background)) this->SetBackgroundImage(default_background);
+		if (Theme::HasAsset("bg_images.default_background")) this->SetBackgroundImage(default_background);
 		else this->SetBackgroundImage("romfs:/images/Background.png");
 
 		this->pageInfoText = TextBlock::New(10, 109, "inst.hd.top_info"_lang);
 		this->pageInfoText->SetFont(pu::ui::MakeDefaultFontName(30));
 
-		if (usb_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json")) this->pageInfoText->SetColor(COLOR(pageinfo_colour));
-		else this->pageInfoText->SetColor(COLOR("#FFFFFFFF"));
+		this->pageInfoText->SetColor(Theme::Colour("colour.pageinfo_text", "#FFFFFFFF"));
 
 		this->butText = TextBlock::New(10, 678, "inst.hd.buttons"_lang);
 
-		if (usb_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json")) this->butText->SetColor(COLOR(bottombar_text));
-		else this->butText->SetColor(COLOR("#FFFFFFFF"));
+		this->butText->SetColor(Theme::Colour("colour.bottombar_text", "#FFFFFFFF"));
 
-		if (usb_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json")) this->menu = pu::ui::elm::Menu::New(0, 156, 1280, COLOR(background_overlay1), COLOR(background_overlay2), 84, (506 / 84));
-		else this->menu = pu::ui::elm::Menu::New(0, 156, 1280, COLOR("#FFFFFF00"), COLOR("#4f4f4d33"), 84, (506 / 84));
+		this->menu = pu::ui::elm::Menu::New(0, 156, 1280, Theme::Colour("colour.background_overlay1", "#FFFFFF00"), Theme::Colour("colour.background_overlay2", "#4f4f4d33"), 84, (506 / 84));
 
-		if (usb_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json")) this->menu->SetItemsFocusColor(COLOR(focus));
-		else this->menu->SetItemsFocusColor(COLOR("#4f4f4dAA"));
+		this->menu->SetItemsFocusColor(Theme::Colour("colour.focus", "#4f4f4dAA"));
 
-		if (usb_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json")) this->menu->SetScrollbarColor(COLOR(scrollbar));
-		else this->menu->SetScrollbarColor(COLOR("#1A1919FF"));
+		this->menu->SetScrollbarColor(Theme::Colour("colour.scrollbar", "#1A1919FF"));
 
-		if (usb_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json") && std::filesystem::exists(waiting)) this->infoImage = Image::New(453, 292, waiting);
+		if (Theme::HasAsset("icons_others.waiting_usb")) this->infoImage = Image::New(453, 292, waiting);
 		else this->infoImage = Image::New(453, 292, "romfs:/images/icons/usb-connection-waiting.png");
 
 		this->Add(this->topRect);
@@ -96,65 +75,48 @@ namespace inst::ui {
 	}
 
 	void usbInstPage::drawMenuItems_withext(bool clearItems) {
-		int myindex = this->menu->GetSelectedIndex(); //store index so when page redraws we can get the last item we checked.
-		if (clearItems) this->selectedTitles = {};
-		std::string text_colour = "colour.main_text"_theme;
-		this->menu->ClearItems();
-		for (auto& url : this->ourTitles) {
-			std::string itm = inst::util::shortenString(inst::util::formatUrlString(url), 56, true);
-			auto ourEntry = pu::ui::elm::MenuItem::New(itm);
-
-			if (usb_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json")) ourEntry->SetColor(COLOR(text_colour));
-			else ourEntry->SetColor(COLOR("#FFFFFFFF"));
-
-			ourEntry->SetIcon(unchecked_usb);
-			for (long unsigned int i = 0; i < this->selectedTitles.size(); i++) {
-				if (this->selectedTitles[i] == url) {
-					ourEntry->SetIcon(checked_usb);
-				}
-			}
-			this->menu->AddItem(ourEntry);
-			this->menu->SetSelectedIndex(myindex); //jump to the index we saved from above
-		}
+		this->showExtension = true;
+		this->setMenuSource(clearItems);
 	}
 
 	void usbInstPage::drawMenuItems(bool clearItems) {
+		this->showExtension = false;
+		this->setMenuSource(clearItems);
+	}
+
+	void usbInstPage::setMenuSource(bool clearItems) {
 		int myindex = this->menu->GetSelectedIndex(); //store index so when page redraws we can get the last item we checked.
 		if (clearItems) this->selectedTitles = {};
-		std::string text_colour = "colour.main_text"_theme;
-		this->menu->ClearItems();
-		for (auto& url : this->ourTitles) {
+		// Rows are only built for the visible part of the list, see makeMenuItem
+		this->menu->SetItemSource(this->ourTitles.size(), std::bind(&usbInstPage::makeMenuItem, this, std::placeholders::_1));
+		if (this->ourTitles.size()) this->menu->SetSelectedIndex(myindex); //jump to the index we saved from above
+	}
 
+	pu::ui::elm::MenuItem::Ref usbInstPage::makeMenuItem(u32 index) {
+		auto& url = this->ourTitles[index];
+		std::string itm;
+		if (this->showExtension) itm = inst::util::shortenString(inst::util::formatUrlString(url), 56, true);
+		else {
 			std::string base_filename = url.substr(url.find_last_of("/") + 1); //just get the filename
 			std::string::size_type const p(base_filename.find_last_of('.'));
 			std::string file_without_extension = base_filename.substr(0, p); //strip of file extension
-			std::string itm = inst::util::shortenString(inst::util::formatUrlString(file_without_extension), 56, true);
-
-			//std::string itm = inst::util::shortenString(inst::util::formatUrlString(url), 56, true);
-			auto ourEntry = pu::ui::elm::MenuItem::New(itm);
+			itm = inst::util::shortenString(inst::util::formatUrlString(file_without_extension), 56, true);
+		}
 
-			if (usb_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json")) ourEntry->SetColor(COLOR(text_colour));
-			else ourEntry->SetColor(COLOR("#FFFFFFFF"));
-			ourEntry->SetIcon(unchecked_usb);
+		auto ourEntry = pu::ui::elm::MenuItem::New(itm);
+		ourEntry->SetColor(Theme::Colour("colour.main_text", "#FFFFFFFF"));
 
-			for (long unsigned int i = 0; i < this->selectedTitles.size(); i++) {
-				if (this->selectedTitles[i] == url) {
-					ourEntry->SetIcon(checked_usb);
-				}
-			}
-			this->menu->AddItem(ourEntry);
-			this->menu->SetSelectedIndex(myindex); //jump to the index we saved from above
-		}
+		if (std::find(this->selectedTitles.begin(), this->selectedTitles.end(), url) != this->selectedTitles.end()) ourEntry->SetIcon(checked_usb);
+		else ourEntry->SetIcon(unchecked_usb);
+		return ourEntry;
 	}
 
 	void usbInstPage::selectTitle(int selectedIndex) {
-		if (this->menu->GetItems()[selectedIndex]->GetIconPath() == checked_usb) {
-			for (long unsigned int i = 0; i < this->selectedTitles.size(); i++) {
-				if (this->selectedTitles[i] == this->ourTitles[selectedIndex]) this->selectedTitles.erase(this->selectedTitles.begin() + i);
-			}
-		}
-		else this->selectedTitles.push_back(this->ourTitles[selectedIndex]);
-		this->drawMenuItems(false);
+		auto& url = this->ourTitles[selectedIndex];
+		auto selected = std::find(this->selectedTitles.begin(), this->selectedTitles.end(), url);
+		if (selected != this->selectedTitles.end()) this->selectedTitles.erase(selected);
+		else this->selectedTitles.push_back(url);
+		this->menu->InvalidateItems();
 	}
 
 	void usbInstPage::startUsb() {
@@ -186,10 +148,7 @@ namespace inst::ui {
 	void usbInstPage::startInstall() {
 		int dialogResult = -1;
 
-		std::string install = "romfs:/images/icons/install.png";
-		if (usb_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json") && std::filesystem::exists(inst::config::appDir + "icons_others.install"_theme)) {
-			install = inst::config::appDir + "icons_others.install"_theme;
-		}
+		std::string install = Theme::Asset("icons_others.install", "romfs:/images/icons/install.png");
 
 		if (this->selectedTitles.size() == 1) {
 			dialogResult = mainApp->CreateShowDialog("inst.target.desc0"_lang + ":\n\n" + inst::util::shortenString(std::filesystem::path(this->selectedTitles[0]).filename().string(), 32, true) + "\n\n" + "inst.target.desc1"_lang, "\n\n\n\n\n\n\n" + "common.cancel_desc"_lang, { "inst.target.opt0"_lang, "inst.target.opt1"_lang }, false, install);
@@ -215,14 +174,14 @@ namespace inst::ui {
 				www = state.count;
 
 				if (www != 1) {
-					int var = this->menu->GetItems().size();
+					int var = this->menu->GetTotalItemCount();
 					auto s = std::to_string(var);
 					if (s == "0") {
 						//do nothing here because there's no items in the list, that way the app won't freeze
 					}
 					else {
 						this->selectTitle(this->menu->GetSelectedIndex());
-						if (this->menu->GetItems().size() == 1 && this->selectedTitles.size() == 1) {
+						if (this->menu->GetTotalItemCount() == 1 && this->selectedTitles.size() == 1) {
 							this->startInstall();
 						}
 					}
@@ -231,18 +190,18 @@ namespace inst::ui {
 		}
 
 		if ((Down & HidNpadButton_Y)) {
-			if (this->selectedTitles.size() == this->menu->GetItems().size()) this->drawMenuItems(true);
+			if (this->selectedTitles.size() == this->ourTitles.size()) this->drawMenuItems(true);
 			else {
-				for (long unsigned int i = 0; i < this->menu->GetItems().size(); i++) {
-					if (this->menu->GetItems()[i]->GetIconPath() == checked_usb) continue;
-					else this->selectTitle(i);
+				std::set<std::string> selected(this->selectedTitles.begin(), this->selectedTitles.end());
+				for (auto& url : this->ourTitles) {
+					if (selected.insert(url).second) this->selectedTitles.push_back(url);
 				}
-				this->drawMenuItems(false);
+				this->menu->InvalidateItems();
 			}
 		}
 
 		if (Down & HidNpadButton_Plus) {
-			int var = this->menu->GetItems().size();
+			int var = this->menu->GetTotalItemCount();
 			auto s = std::to_string(var);
 
 			if (s != "0") {
@@ -259,18 +218,18 @@ namespace inst::ui {
 			this->menu->SetSelectedIndex(std::max(0, this->menu->GetSelectedIndex() - 6));
 
 		if (Down & HidNpadButton_ZR)
-			this->menu->SetSelectedIndex(std::min((s32)this->menu->GetItems().size() - 1, this->menu->GetSelectedIndex() + 6));
+			this->menu->SetSelectedIndex(std::min((s32)this->menu->GetTotalItemCount() - 1, this->menu->GetSelectedIndex() + 6));
 
 		//goto top of list	
 		if (Down & HidNpadButton_L) {
-			int x = this->menu->GetItems().size() - 1;
+			int x = this->menu->GetTotalItemCount() - 1;
 			this->menu->SetSelectedIndex(std::max(0, this->menu->GetSelectedIndex() - x));
 		}
 
 		//goto bottom of list
 		if (Down & HidNpadButton_R) {
-			int x = this->menu->GetItems().size() - 1;
-			this->menu->SetSelectedIndex(std::min((s32)this->menu->GetItems().size() - 1, this->menu->GetSelectedIndex() + x));
+			int x = this->menu->GetTotalItemCount() - 1;
+			this->menu->SetSelectedIndex(std::min((s32)this->menu->GetTotalItemCount() - 1, this->menu->GetSelectedIndex() + x));
 		}
 
 		//don't show file extensions
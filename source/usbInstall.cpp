@@ -28,11 +28,13 @@ SOFTWARE.
 #include "install/install_nsp.hpp"
 #include "install/usb_xci.hpp"
 #include "install/install_xci.hpp"
+#include "install/install_queue.hpp"
 #include "util/error.hpp"
 #include "util/usb_util.hpp"
 #include "util/util.hpp"
 #include "util/config.hpp"
 #include "util/lang.hpp"
+#include "util/telemetry.hpp"
 #include "ui/MainApplication.hpp"
 #include "ui/usbInstPage.hpp"
 #include "ui/instPage.hpp"
@@ -42,11 +44,6 @@ namespace inst::ui {
 	extern MainApplication* mainApp;
 }
 
-namespace inst::ui {
-	std::string usbi_root = inst::config::appDir + "/theme";
-	bool usbi_theme = util::themeit(usbi_root); //check if we have a previous theme directory first.
-}
-
 namespace usbInstStuff {
 	struct TUSHeader
 	{
@@ -70,10 +67,7 @@ namespace usbInstStuff {
 		padConfigureInput(8, HidNpadStyleSet_NpadStandard);
 		PadState pad;
 		padInitializeAny(&pad);
-		std::string info = "romfs:/images/icons/information.png";
-		if (inst::ui::usbi_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json") && std::filesystem::exists(inst::config::appDir + "icons_others.information"_theme)) {
-			info = inst::config::appDir + "icons_others.information"_theme;
-		}
+		std::string info = Theme::Asset("icons_others.information", "romfs:/images/icons/information.png");
 
 		while (true) {
 			if (bufferData(&header, sizeof(TUSHeader), 500000000) != 0) break;
@@ -111,14 +105,8 @@ namespace usbInstStuff {
 		bool nspInstalled = true;
 		NcmStorageId m_destStorageId = NcmStorageId_SdCard;
 
-		std::string good = "romfs:/images/icons/good.png";
-		if (inst::ui::usbi_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json") && std::filesystem::exists(inst::config::appDir + "icons_others.good"_theme)) {
-			good = inst::config::appDir + "icons_others.good"_theme;
-		}
-		std::string fail = "romfs:/images/icons/fail.png";
-		if (inst::ui::usbi_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json") && std::filesystem::exists(inst::config::appDir + "icons_others.fail"_theme)) {
-			fail = inst::config::appDir + "icons_others.fail"_theme;
-		}
+		std::string good = Theme::Asset("icons_others.good", "romfs:/images/icons/good.png");
+		std::string fail = Theme::Asset("icons_others.fail", "romfs:/images/icons/fail.png");
 
 		if (ourStorage) m_destStorageId = NcmStorageId_BuiltInUser;
 		unsigned int fileItr;
@@ -135,37 +123,38 @@ namespace usbInstStuff {
 			previousClockValues.push_back(inst::util::setClockSpeed(2, 1600000000)[0]);
 		}
 
+		u64 bytesSkipped = 0;
+		inst::telemetry::BeginReport("usb", m_destStorageId);
 		try {
 			int togo = ourTitleList.size();
-			for (fileItr = 0; fileItr < ourTitleList.size(); fileItr++) {
+			// The USB host serves one command stream, so titles can't be read ahead
+			tin::install::InstallQueue installQueue(ourTitleList.size(), [&](size_t i) -> std::unique_ptr<tin::install::Install> {
+				if (ourTitleList[i].compare(ourTitleList[i].size() - 3, 2, "xc") == 0) {
+					auto usbXCI = std::make_shared<tin::install::xci::USBXCI>(ourTitleList[i]);
+					return std::make_unique<tin::install::xci::XCIInstallTask>(m_destStorageId, inst::config::ignoreReqVers, usbXCI);
+				}
+				auto usbNSP = std::make_shared<tin::install::nsp::USBNSP>(ourTitleList[i]);
+				return std::make_unique<tin::install::nsp::NSPInstall>(m_destStorageId, inst::config::ignoreReqVers, usbNSP);
+			}, false);
+
+			installQueue.Run([&](size_t i) {
+				fileItr = i;
 				auto s = std::to_string(togo);
 				inst::ui::instPage::filecount("inst.info_page.queue"_lang + s);
 				inst::ui::instPage::setTopInstInfoText("inst.info_page.top_info0"_lang + fileNames[fileItr] + "inst.usb.source_string"_lang);
-				std::unique_ptr<tin::install::Install> installTask;
-
-				if (ourTitleList[fileItr].compare(ourTitleList[fileItr].size() - 3, 2, "xc") == 0) {
-					auto usbXCI = std::make_shared<tin::install::xci::USBXCI>(ourTitleList[fileItr]);
-					installTask = std::make_unique<tin::install::xci::XCIInstallTask>(m_destStorageId, inst::config::ignoreReqVers, usbXCI);
-				}
-				else {
-					auto usbNSP = std::make_shared<tin::install::nsp::USBNSP>(ourTitleList[fileItr]);
-					installTask = std::make_unique<tin::install::nsp::NSPInstall>(m_destStorageId, inst::config::ignoreReqVers, usbNSP);
-				}
-
-				LOG_DEBUG("%s\n", "Preparing installation");
 				inst::ui::instPage::setInstInfoText("inst.info_page.preparing"_lang);
 				inst::ui::instPage::setInstBarPerc(0);
-				installTask->Prepare();
-				installTask->InstallTicketCert();
-				installTask->Begin();
 				togo = (togo - 1);
-			}
+			});
+			bytesSkipped = installQueue.GetBytesSkipped();
+			inst::telemetry::EndReport(true);
 
 			inst::ui::instPage::filecount("inst.info_page.queue"_lang + "0");
 		}
 		catch (std::exception& e) {
 			LOG_DEBUG("Failed to install");
 			LOG_DEBUG("%s", e.what());
+			inst::telemetry::EndReport(false, e.what());
 			fprintf(stdout, "%s", e.what());
 			inst::ui::instPage::setInstInfoText("inst.info_page.failed"_lang + fileNames[fileItr]);
 			inst::ui::instPage::setInstBarPerc(0);
@@ -173,7 +162,7 @@ namespace usbInstStuff {
 			if (inst::config::useSound) {
 				std::string audioPath = "romfs:/audio/fail.mp3";
 				std::string fail = inst::config::appDir + "audio.fail"_theme;
-				if (inst::ui::usbi_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json") && std::filesystem::exists(fail)) audioPath = (fail);
+				if (Theme::HasAsset("audio.fail")) audioPath = (fail);
 				std::thread audioThread(inst::util::playAudio, audioPath);
 				audioThread.join();
 			}
@@ -190,13 +179,15 @@ namespace usbInstStuff {
 
 		if (nspInstalled) {
 			tin::util::USBCmdManager::SendExitCmd();
-			inst::ui::instPage::setInstInfoText("inst.info_page.complete"_lang);
+			std::string completeText = "inst.info_page.complete"_lang;
+			if (bytesSkipped > 0) completeText += "inst.info_page.skipped"_lang + std::to_string(bytesSkipped / 1000000) + " MB";
+			inst::ui::instPage::setInstInfoText(completeText);
 			inst::ui::instPage::setInstBarPerc(100);
 
 			if (inst::config::useSound) {
 				std::string audioPath = "romfs:/audio/pass.mp3";
 				std::string pass = inst::config::appDir + "audio.pass"_theme;
-				if (inst::ui::usbi_theme && inst::config::useTheme && std::filesystem::exists(inst::config::appDir + "/theme/theme.json") && std::filesystem::exists(pass)) audioPath = (pass);
+				if (Theme::HasAsset("audio.pass")) audioPath = (pass);
 				std::thread audioThread(inst::util::playAudio, audioPath);
 				audioThread.join();
 			}
@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <fstream>
 #include <iomanip>
 #include "util/config.hpp"
@@ -23,6 +24,9 @@ namespace inst::config {
 	bool fixticket;
 	bool listoveride;
 	bool httpkeyboard;
+	std::string benchmarkSink;
+	int writeBlockSd;
+	int writeBlockNand;
 
 	void setConfig() {
 		nlohmann::json j = {
@@ -43,7 +47,10 @@ namespace inst::config {
 			{"httplastUrl2", httplastUrl2},
 			{"fixticket", fixticket},
 			{"listoveride", listoveride},
-			{"httpkeyboard", httpkeyboard}
+			{"httpkeyboard", httpkeyboard},
+			{"benchmarkSink", benchmarkSink},
+			{"writeBlockSd", writeBlockSd},
+			{"writeBlockNand", writeBlockNand}
 		};
 		std::ofstream file(inst::config::configPath);
 		file << std::setw(4) << j << std::endl;
@@ -72,6 +79,11 @@ namespace inst::config {
 			httplastUrl2 = j["httplastUrl2"].get<std::string>();
 			usbAck = j["usbAck"].get<bool>();
 			validateNCAs = j["validateNCAs"].get<bool>();
+			// Developer option, not in older configs: "null", "memory" or "file" makes SD installs a pipeline benchmark
+			benchmarkSink = j.value("benchmarkSink", "");
+			// Placeholder write block size in KB, not in older configs. SD cards want bigger writes than NAND.
+			writeBlockSd = std::max(j.value("writeBlockSd", 4096), 16);
+			writeBlockNand = std::max(j.value("writeBlockNand", 1024), 16);
 		}
 		catch (...) {
 			// If loading values from the config fails, we just load the defaults and overwrite the old config
@@ -93,6 +105,9 @@ namespace inst::config {
 			overClock = true;
 			usbAck = false;
 			validateNCAs = true;
+			benchmarkSink = "";
+			writeBlockSd = 4096;
+			writeBlockNand = 1024;
 			setConfig();
 		}
 	}
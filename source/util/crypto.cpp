@@ -1,9 +1,79 @@
 #include "util/crypto.hpp"
 #include <string.h>
 #include <mbedtls/bignum.h>
+#include <memory>
 #include <stdexcept>
 #include "util/error.hpp"
 
+namespace {
+	std::mutex g_keysMutex;
+	std::unique_ptr<Crypto::Keys> g_keys;
+
+	std::mutex g_headerXtsMutex;
+	std::vector<std::unique_ptr<Crypto::AesXtr>> g_headerDecryptors;
+	std::vector<std::unique_ptr<Crypto::AesXtr>> g_headerEncryptors;
+}
+
+Crypto::Keys& Crypto::Keys::Get() {
+	std::lock_guard<std::mutex> lock(g_keysMutex);
+
+	// Only cache a successful derivation, so a call made before spl is up can be retried
+	if (!g_keys) {
+		auto keys = std::make_unique<Keys>();
+		if (!keys->valid) {
+			THROW_FORMAT("Failed to derive the NCA header key");
+		}
+		g_keys = std::move(keys);
+	}
+
+	return *g_keys;
+}
+
+void Crypto::Keys::GetKeyAreaKey(u8 kaekIndex, u8 keyGeneration, const u8* encryptedKey, u8* out) {
+	if (kaekIndex >= 3) {
+		THROW_FORMAT("Invalid key area key index %u", kaekIndex);
+	}
+
+	std::array<u8, 0x10> kek;
+	{
+		std::lock_guard<std::mutex> lock(m_keyAreaKekMutex);
+		u16 kekId = (kaekIndex << 8) | keyGeneration;
+		auto it = m_keyAreaKeks.find(kekId);
+
+		if (it == m_keyAreaKeks.end()) {
+			ASSERT_OK(splCryptoGenerateAesKek(keyAreaKeySources[kaekIndex], keyGeneration, 0, kek.data()), "Failed to generate key area kek");
+			m_keyAreaKeks[kekId] = kek;
+		}
+		else {
+			kek = it->second;
+		}
+	}
+
+	ASSERT_OK(splCryptoGenerateAesKey(kek.data(), encryptedKey, out), "Failed to unwrap key area key");
+}
+
+Crypto::HeaderXtsLease::HeaderXtsLease(bool is_encryptor) : m_isEncryptor(is_encryptor), m_xtr(nullptr) {
+	{
+		std::lock_guard<std::mutex> lock(g_headerXtsMutex);
+		auto& pool = is_encryptor ? g_headerEncryptors : g_headerDecryptors;
+
+		if (!pool.empty()) {
+			m_xtr = pool.back().release();
+			pool.pop_back();
+		}
+	}
+
+	if (!m_xtr) {
+		m_xtr = new AesXtr(Keys::Get().headerKey, is_encryptor);
+	}
+}
+
+Crypto::HeaderXtsLease::~HeaderXtsLease() {
+	std::lock_guard<std::mutex> lock(g_headerXtsMutex);
+	auto& pool = m_isEncryptor ? g_headerEncryptors : g_headerDecryptors;
+	pool.emplace_back(m_xtr);
+}
+
 void Crypto::calculateMGF1andXOR(unsigned char* data, size_t data_size, const void* source, size_t source_size) {
 	unsigned char h_buf[RSA_2048_BYTES] = { 0 };
 	memcpy(h_buf, source, source_size);
@@ -4,6 +4,7 @@
 #include <iostream>
 #include <fstream>
 #include <filesystem>
+#include <functional>
 #include "util/curl.hpp"
 #include "util/config.hpp"
 #include "util/error.hpp"
@@ -23,6 +24,13 @@ size_t writeDataBuffer(char* ptr, size_t size, size_t nmemb, void* userdata) {
 	return count;
 }
 
+static size_t writeDataCallback(char* ptr, size_t size, size_t nmemb, void* userdata) {
+	auto onData = (std::function<bool(const void*, size_t)>*)userdata;
+	size_t count = size * nmemb;
+	if (!(*onData)(ptr, count)) return 0; // curl treats a short write as CURLE_WRITE_ERROR
+	return count;
+}
+
 int progress_callback(void* clientp, curl_off_t dltotal, curl_off_t dlnow, curl_off_t ultotal, curl_off_t ulnow) {
 	if (ultotal) {
 		int uploadProgress = (int)(((double)ulnow / (double)ultotal) * 100.0);
@@ -91,6 +99,37 @@ namespace inst::curl {
 		}
 	}
 
+	bool downloadToCallback(const std::string ourUrl, std::function<bool(const void*, size_t)> onData, long timeout, bool writeProgress) {
+		CURL* curl_handle;
+		CURLcode result;
+
+		curl_global_init(CURL_GLOBAL_ALL);
+		curl_handle = curl_easy_init();
+
+		curl_easy_setopt(curl_handle, CURLOPT_URL, ourUrl.c_str());
+		curl_easy_setopt(curl_handle, CURLOPT_FOLLOWLOCATION, 1L);
+		curl_easy_setopt(curl_handle, CURLOPT_SSL_VERIFYPEER, 0L);
+		curl_easy_setopt(curl_handle, CURLOPT_USERAGENT, "Mozilla/5.0 (Linux; Android 13; Pixel 7 Pro) AppleWebKit/537.36 (KHTML, like Gecko) Chrome/112.0.0.0 Mobile Safari/537.36");
+		curl_easy_setopt(curl_handle, CURLOPT_SSL_VERIFYHOST, 0L);
+		curl_easy_setopt(curl_handle, CURLOPT_NOPROGRESS, 0L);
+		curl_easy_setopt(curl_handle, CURLOPT_TIMEOUT_MS, timeout);
+		curl_easy_setopt(curl_handle, CURLOPT_CONNECTTIMEOUT_MS, timeout);
+		curl_easy_setopt(curl_handle, CURLOPT_WRITEFUNCTION, writeDataCallback);
+		curl_easy_setopt(curl_handle, CURLOPT_WRITEDATA, &onData);
+		if (writeProgress) curl_easy_setopt(curl_handle, CURLOPT_XFERINFOFUNCTION, progress_callback);
+
+		result = curl_easy_perform(curl_handle);
+
+		curl_easy_cleanup(curl_handle);
+		curl_global_cleanup();
+
+		if (result == CURLE_OK) return true;
+		else {
+			LOG_DEBUG(curl_easy_strerror(result));
+			return false;
+		}
+	}
+
 	std::string downloadToBuffer(const std::string ourUrl, int firstRange, int secondRange, long timeout) {
 		//https://www.php.net/manual/en/function.curl-setopt.php
 		CURL* curl_handle;
@@ -22,16 +22,21 @@ SOFTWARE.
 
 #include "util/file_util.hpp"
 
+#include <algorithm>
 #include <memory>
 
+#include "install/nca.hpp"
+#include "install/pfs0.hpp"
 #include "install/simple_filesystem.hpp"
 #include "nx/fs.hpp"
 #include "data/byte_buffer.hpp"
 #include "util/title_util.hpp"
+#include "util/crypto.hpp"
+#include "util/error.hpp"
 
 namespace tin::util
 {
-	// TODO: do this manually so we don't have to "install" the cnmt's
+	// Reads the cnmt from an installed CNMT NCA
 	nx::ncm::ContentMeta GetContentMetaFromNCA(const std::string& ncaPath)
 	{
 		// Create the cnmt filesystem
@@ -50,4 +55,79 @@ namespace tin::util
 
 		return nx::ncm::ContentMeta(cnmtBuf.GetData(), cnmtBuf.GetSize());
 	}
+
+	// Parses the cnmt out of a CNMT NCA held in memory, so it doesn't need to be installed first
+	nx::ncm::ContentMeta GetContentMetaFromNCA(std::vector<u8>& ncaBytes)
+	{
+		if (ncaBytes.size() < sizeof(tin::install::NcaHeader))
+			THROW_FORMAT("CNMT NCA is too small");
+
+		tin::install::NcaHeader header;
+		Crypto::HeaderXtsLease headerCrypto(false);
+		headerCrypto->decrypt(&header, ncaBytes.data(), sizeof(tin::install::NcaHeader), 0, 0x200);
+
+		if (header.magic != MAGIC_NCA3)
+			THROW_FORMAT("Invalid CNMT NCA magic");
+
+		if (header.m_rightsId[0] || header.m_rightsId[1])
+			THROW_FORMAT("CNMT NCA uses titlekey crypto");
+
+		// The cnmt lives in a PFS0 in the first section
+		const tin::install::NcaFsHeader& fsHeader = header.fs_headers[0];
+		u64 sectionStart = (u64)header.section_entries[0].media_start_offset * 0x200;
+		u64 sectionEnd = (u64)header.section_entries[0].media_end_offset * 0x200;
+
+		if (fsHeader.fs_type != 2 || sectionStart >= sectionEnd || sectionEnd > ncaBytes.size())
+			THROW_FORMAT("Unexpected CNMT NCA section layout");
+
+		std::vector<u8> section(ncaBytes.begin() + sectionStart, ncaBytes.begin() + sectionEnd);
+
+		if (fsHeader.crypt_type == 3)
+		{
+			u8 key[0x10];
+			Crypto::Keys::Get().GetKeyAreaKey(header.m_kaekIndex, std::max(header.m_cryptoType, header.m_cryptoType2), header.m_keys + 0x20, key);
+
+			Crypto::Aes128Ctr crypto(key, Crypto::AesCtr(fsHeader.section_ctr));
+			crypto.seek(sectionStart);
+			crypto.decrypt(section.data(), section.data(), section.size());
+		}
+		else if (fsHeader.crypt_type != 1)
+		{
+			THROW_FORMAT("Unsupported CNMT NCA crypto type %u", fsHeader.crypt_type);
+		}
+
+		// PFS0 superblock: master hash, block size, always 2, hash table offset and size, then the PFS0 offset
+		u64 pfs0Offset = *(u64*)(fsHeader.superblock_data + 0x38);
+
+		if (pfs0Offset + sizeof(tin::install::PFS0BaseHeader) > section.size())
+			THROW_FORMAT("CNMT NCA PFS0 is out of bounds");
+
+		u8* pfs0 = section.data() + pfs0Offset;
+		auto baseHeader = (tin::install::PFS0BaseHeader*)pfs0;
+		u64 pfs0HeaderSize = sizeof(tin::install::PFS0BaseHeader) + (u64)baseHeader->numFiles * sizeof(tin::install::PFS0FileEntry) + baseHeader->stringTableSize;
+
+		if (baseHeader->magic != 0x30534650 || pfs0Offset + pfs0HeaderSize > section.size()) // "PFS0"
+			THROW_FORMAT("Invalid CNMT NCA PFS0 header");
+
+		auto fileEntries = (tin::install::PFS0FileEntry*)(pfs0 + sizeof(tin::install::PFS0BaseHeader));
+		const char* stringTable = (const char*)(fileEntries + baseHeader->numFiles);
+
+		for (u32 i = 0; i < baseHeader->numFiles; i++)
+		{
+			if (fileEntries[i].stringTableOffset >= baseHeader->stringTableSize)
+				continue;
+
+			std::string name(stringTable + fileEntries[i].stringTableOffset, strnlen(stringTable + fileEntries[i].stringTableOffset, baseHeader->stringTableSize - fileEntries[i].stringTableOffset));
+			if (name.size() < 5 || name.compare(name.size() - 5, 5, ".cnmt") != 0)
+				continue;
+
+			u64 cnmtOffset = pfs0Offset + pfs0HeaderSize + fileEntries[i].dataOffset;
+			if (cnmtOffset + fileEntries[i].fileSize > section.size())
+				THROW_FORMAT("CNMT is out of bounds");
+
+			return nx::ncm::ContentMeta(section.data() + cnmtOffset, fileEntries[i].fileSize);
+		}
+
+		THROW_FORMAT("No cnmt found in CNMT NCA");
+	}
 }
\ No newline at end of file
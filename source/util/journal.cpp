@@ -0,0 +1,156 @@
+#include <filesystem>
+#include <fstream>
+#include <cstdio>
+#include <mutex>
+#include "util/journal.hpp"
+#include "util/config.hpp"
+#include "util/error.hpp"
+#include "util/json.hpp"
+#include "util/title_util.hpp"
+
+namespace inst::journal {
+	namespace {
+		const std::string journalPath = inst::config::appDir + "/install_journal.json";
+		// Written and committed first, then renamed over the journal so a crash never leaves half a file
+		const std::string tempPath = journalPath + ".tmp";
+		// Redoing up to this much of an NCA after a crash is cheaper than rewriting the journal more often,
+		// and smaller NCAs aren't worth resuming at all
+		const u64 saveInterval = 0x4000000; // 64MB
+
+		std::mutex journalMutex;
+		bool loaded = false;
+		bool dirty = false;
+		nlohmann::json entries = nlohmann::json::object();
+		std::string lastSavedId;
+		u64 lastSaved = 0;
+
+		void load() {
+			if (loaded) return;
+			loaded = true;
+			try {
+				std::ifstream file(journalPath);
+				// Power was lost between removing the old journal and renaming the new one into place
+				if (!file) file = std::ifstream(tempPath);
+				if (!file) return;
+				nlohmann::json j;
+				file >> j;
+				if (j.is_object()) entries = j;
+			}
+			catch (...) {
+				entries = nlohmann::json::object();
+			}
+		}
+
+		u64 entryValue(const nlohmann::json& entry, const char* key) {
+			auto value = entry.find(key);
+			if (value == entry.end() || !value->is_number_unsigned()) return 0;
+			return value->get<u64>();
+		}
+
+		void save() {
+			dirty = false;
+			std::error_code ec;
+			if (entries.empty()) {
+				std::filesystem::remove(journalPath, ec);
+				std::filesystem::remove(tempPath, ec);
+				fsdevCommitDevice("sdmc");
+				return;
+			}
+
+			std::string text = entries.dump(4) + "\n";
+			FILE* file = fopen(tempPath.c_str(), "wb");
+			if (file == NULL) {
+				LOG_DEBUG("Failed to write install journal\n");
+				return;
+			}
+			bool written = fwrite(text.data(), 1, text.size(), file) == text.size() && fflush(file) == 0;
+			if (fclose(file) != 0 || !written) {
+				LOG_DEBUG("Failed to write install journal\n");
+				return;
+			}
+			fsdevCommitDevice("sdmc");
+
+			// FS won't rename over an existing file, load() falls back to the temp file if we stop in between
+			std::filesystem::remove(journalPath, ec);
+			std::filesystem::rename(tempPath, journalPath, ec);
+			if (ec) LOG_DEBUG("Failed to replace install journal\n");
+			fsdevCommitDevice("sdmc");
+		}
+	}
+
+	void Track(const NcmContentId& ncaId, u64 size) {
+		std::lock_guard<std::mutex> lock(journalMutex);
+		load();
+		lastSavedId = tin::util::GetNcaIdString(ncaId);
+		lastSaved = 0;
+		entries[lastSavedId] = { {"size", size}, {"written", 0} };
+		// Saved right away, a placeholder that dies before the next save would otherwise look like
+		// another program's and never be collected
+		save();
+	}
+
+	void Progress(const NcmContentId& ncaId, u64 written) {
+		std::lock_guard<std::mutex> lock(journalMutex);
+		load();
+		std::string id = tin::util::GetNcaIdString(ncaId);
+		auto entry = entries.find(id);
+		if (entry == entries.end()) return;
+
+		u64 size = entryValue(*entry, "size");
+		if (size < saveInterval) return;
+		if (id != lastSavedId) {
+			lastSavedId = id;
+			lastSaved = entryValue(*entry, "written");
+		}
+		if (written - lastSaved < saveInterval && written != size) return;
+
+		(*entry)["written"] = written;
+		lastSaved = written;
+		save();
+	}
+
+	void Remove(const NcmContentId& ncaId) {
+		std::lock_guard<std::mutex> lock(journalMutex);
+		load();
+		if (entries.erase(tin::util::GetNcaIdString(ncaId))) dirty = true;
+	}
+
+	void Flush() {
+		std::lock_guard<std::mutex> lock(journalMutex);
+		if (dirty) save();
+	}
+
+	u64 GetResumeOffset(const NcmContentId& ncaId, u64 size) {
+		std::lock_guard<std::mutex> lock(journalMutex);
+		load();
+		auto entry = entries.find(tin::util::GetNcaIdString(ncaId));
+		if (entry == entries.end() || entryValue(*entry, "size") != size) return 0;
+		return std::min(entryValue(*entry, "written"), size);
+	}
+
+	bool IsTracked(const NcmContentId& ncaId) {
+		std::lock_guard<std::mutex> lock(journalMutex);
+		load();
+		return entries.contains(tin::util::GetNcaIdString(ncaId));
+	}
+
+	bool IsResumable(const NcmContentId& ncaId) {
+		std::lock_guard<std::mutex> lock(journalMutex);
+		load();
+		auto entry = entries.find(tin::util::GetNcaIdString(ncaId));
+		return entry != entries.end() && entryValue(*entry, "written") > 0;
+	}
+
+	void Retain(const std::vector<NcmContentId>& ncaIds) {
+		std::lock_guard<std::mutex> lock(journalMutex);
+		load();
+		nlohmann::json retained = nlohmann::json::object();
+		for (auto& ncaId : ncaIds) {
+			auto entry = entries.find(tin::util::GetNcaIdString(ncaId));
+			if (entry != entries.end()) retained[entry.key()] = *entry;
+		}
+		if (retained.size() == entries.size()) return;
+		entries = retained;
+		save();
+	}
+}
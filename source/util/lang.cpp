@@ -8,6 +8,7 @@
 
 namespace Language {
 	json lang;
+	inst::util::StringTable langTable("didn't find: ", "");
 
 	void Load() {
 		//https://switchbrew.org/wiki/Settings_services#LanguageCode
@@ -128,14 +129,11 @@ namespace Language {
 		}
 		lang = json::parse(ifs);
 		ifs.close();
+		langTable.Build(lang);
 	}
 
-	std::string LanguageEntry(std::string key) {
-		json j = GetRelativeJson(lang, key);
-		if (j == nullptr) {
-			return "didn't find: " + key;
-		}
-		return j.get<std::string>();
+	const std::string& LanguageEntry(u64 hash, std::string_view key) {
+		return langTable.Get(hash, key);
 	}
 
 	std::string GetRandomMsg() {
@@ -0,0 +1,104 @@
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "util/placeholder_gc.hpp"
+#include "nx/ncm.hpp"
+#include "util/error.hpp"
+#include "util/journal.hpp"
+#include "util/threads.hpp"
+
+namespace inst::placeholder_gc {
+	namespace {
+		const NcmStorageId storageIds[] = { NcmStorageId_SdCard, NcmStorageId_BuiltInUser };
+
+		std::mutex gcMutex;
+		std::thread backgroundThread;
+
+		enum class Kind { Stale, Resumable, Foreign };
+
+		Kind classify(const NcmPlaceHolderId& placeholderId) {
+			// Installs use the content id as the placeholder id
+			const NcmContentId& ncaId = *(const NcmContentId*)&placeholderId;
+			if (!inst::journal::IsTracked(ncaId)) return Kind::Foreign;
+			return inst::journal::IsResumable(ncaId) ? Kind::Resumable : Kind::Stale;
+		}
+
+		// Walks every placeholder of every storage, visit returns true if it deleted the one it was given
+		template<typename Visit>
+		void forEachPlaceholder(Visit visit) {
+			ncmInitialize();
+			std::vector<NcmContentId> found;
+			bool listedAll = true;
+
+			for (auto storageId : storageIds) {
+				try {
+					nx::ncm::ContentStorage contentStorage(storageId);
+					for (auto& placeholderId : contentStorage.ListPlaceholders()) {
+						s64 size = 0;
+						try {
+							size = contentStorage.GetPlaceholderSize(placeholderId);
+						}
+						catch (...) {}
+						if (!visit(contentStorage, placeholderId, classify(placeholderId), (u64)size))
+							found.push_back(*(const NcmContentId*)&placeholderId);
+					}
+				}
+				catch (std::exception& e) {
+					LOG_DEBUG("Failed to list placeholders on storage %u: %s\n", storageId, e.what());
+					listedAll = false;
+				}
+			}
+
+			// Entries whose placeholder is gone can never be resumed
+			if (listedAll) inst::journal::Retain(found);
+			ncmExit();
+		}
+	}
+
+	Report Scan() {
+		std::lock_guard<std::mutex> lock(gcMutex);
+		Report report;
+		forEachPlaceholder([&](nx::ncm::ContentStorage&, const NcmPlaceHolderId&, Kind kind, u64 size) {
+			Usage& usage = kind == Kind::Stale ? report.stale : kind == Kind::Resumable ? report.resumable : report.foreign;
+			usage.count++;
+			usage.bytes += size;
+			return false;
+		});
+		return report;
+	}
+
+	u64 Collect(bool includeResumable, bool includeForeign) {
+		std::lock_guard<std::mutex> lock(gcMutex);
+		u64 freed = 0;
+		forEachPlaceholder([&](nx::ncm::ContentStorage& contentStorage, const NcmPlaceHolderId& placeholderId, Kind kind, u64 size) {
+			if (kind == Kind::Resumable && !includeResumable) return false;
+			if (kind == Kind::Foreign && !includeForeign) return false;
+
+			try {
+				contentStorage.DeletePlaceholder(placeholderId);
+			}
+			catch (std::exception& e) {
+				LOG_DEBUG("%s", e.what());
+				return false;
+			}
+			inst::journal::Remove(*(const NcmContentId*)&placeholderId);
+			freed += size;
+			return true;
+		});
+		inst::journal::Flush();
+		LOG_DEBUG("Freed %lu bytes of placeholders\n", freed);
+		return freed;
+	}
+
+	void StartBackgroundCollect() {
+		if (backgroundThread.joinable()) return;
+		backgroundThread = std::thread([]() {
+			inst::threads::Enter("placeholder-gc", inst::threads::Role::Background);
+			Collect();
+		});
+	}
+
+	void WaitForBackgroundCollect() {
+		if (backgroundThread.joinable()) backgroundThread.join();
+	}
+}
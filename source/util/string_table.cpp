@@ -0,0 +1,60 @@
+#include "util/string_table.hpp"
+
+namespace inst::util {
+	StringTable::StringTable(std::string missingPrefix, std::string missingSuffix) :
+		m_missingPrefix(missingPrefix), m_missingSuffix(missingSuffix)
+	{
+
+	}
+
+	void StringTable::Flatten(const nlohmann::json& j, const std::string& prefix, std::vector<std::pair<std::string, std::string>>& entries) {
+		for (auto& item : j.items()) {
+			std::string key = prefix.empty() ? item.key() : prefix + "." + item.key();
+			if (item.value().is_object()) Flatten(item.value(), key, entries);
+			else if (item.value().is_string()) entries.emplace_back(key, item.value().get<std::string>());
+		}
+	}
+
+	void StringTable::Build(const nlohmann::json& root) {
+		std::vector<std::pair<std::string, std::string>> entries;
+		if (root.is_object()) Flatten(root, "", entries);
+
+		// Keep the load factor at or below one half so probe runs stay short
+		size_t size = 16;
+		while (size < entries.size() * 2) size <<= 1;
+		auto table = std::make_unique<Table>();
+		std::vector<Slot>& slots = table->slots;
+		slots.resize(size);
+
+		for (auto& entry : entries) {
+			u64 hash = HashKey(entry.first.data(), entry.first.size());
+			size_t i = hash & (size - 1);
+			while (slots[i].used && slots[i].key != entry.first) i = (i + 1) & (size - 1);
+			slots[i].used = true;
+			slots[i].hash = hash;
+			slots[i].key = std::move(entry.first);
+			slots[i].value = std::move(entry.second);
+		}
+
+		// The previous table stays in m_tables, a reader may still hold a reference into it
+		std::lock_guard<std::mutex> lock(m_buildMutex);
+		m_tables.push_back(std::move(table));
+		m_table.store(m_tables.back().get(), std::memory_order_release);
+	}
+
+	const std::string& StringTable::Get(u64 hash, std::string_view key) {
+		const Table* table = m_table.load(std::memory_order_acquire);
+		if (table != nullptr) {
+			const std::vector<Slot>& slots = table->slots;
+			size_t mask = slots.size() - 1;
+			for (size_t i = hash & mask; slots[i].used; i = (i + 1) & mask) {
+				if (slots[i].hash == hash && slots[i].key == key) return slots[i].value;
+			}
+		}
+
+		std::lock_guard<std::mutex> lock(m_missMutex);
+		auto it = m_misses.try_emplace(std::string(key)).first;
+		if (it->second.empty()) it->second = m_missingPrefix + it->first + m_missingSuffix;
+		return it->second;
+	}
+}
@@ -0,0 +1,175 @@
+#include <atomic>
+#include <deque>
+#include <fstream>
+#include <iomanip>
+#include <mutex>
+#include "util/telemetry.hpp"
+#include "util/config.hpp"
+#include "util/error.hpp"
+#include "util/json.hpp"
+#include "util/threads.hpp"
+
+namespace inst::telemetry {
+	namespace {
+		const char* stageNames[(int)Stage::Count] = { "source", "buffer", "decompress", "encrypt", "placeholder" };
+
+		struct StageCounters
+		{
+			std::atomic<u64> bytes = 0;
+			std::atomic<u64> busyTicks = 0;
+			std::atomic<u64> waitTicks = 0;
+		};
+
+		struct NcaRecord
+		{
+			std::string name;
+			u64 size = 0;
+			u64 startTick = 0;
+			u64 endTick = 0;
+			StageCounters stages[(int)Stage::Count];
+		};
+
+		std::mutex reportMutex;
+		bool reportActive = false;
+		std::string reportSource;
+		std::string reportDestination;
+		u64 reportStartTick = 0;
+		// deque so records never move while transfer threads hold a pointer
+		std::deque<NcaRecord> records;
+		std::atomic<NcaRecord*> current = nullptr;
+		// Scope opened on this thread, NCAs installed concurrently each record into their own
+		thread_local NcaRecord* threadRecord = nullptr;
+
+		NcaRecord* recordFor() {
+			return threadRecord ? threadRecord : current.load(std::memory_order_acquire);
+		}
+
+		double ticksToMs(u64 ticks) {
+			return armTicksToNs(ticks) / 1000000.0;
+		}
+
+		nlohmann::json stageJson(u64 bytes, u64 busyTicks, u64 waitTicks) {
+			double busyMs = ticksToMs(busyTicks);
+			return {
+				{"bytes", bytes},
+				{"busy_ms", busyMs},
+				{"wait_ms", ticksToMs(waitTicks)},
+				{"mb_per_s", busyMs > 0 ? (bytes / 1000000.0) / (busyMs / 1000.0) : 0.0}
+			};
+		}
+	}
+
+	void AddBusy(Stage stage, u64 startTick, u64 bytes) {
+		NcaRecord* record = recordFor();
+		if (record == nullptr) return;
+		StageCounters& counters = record->stages[(int)stage];
+		counters.busyTicks.fetch_add(armGetSystemTick() - startTick, std::memory_order_relaxed);
+		counters.bytes.fetch_add(bytes, std::memory_order_relaxed);
+	}
+
+	void AddWait(Stage stage, u64 startTick) {
+		NcaRecord* record = recordFor();
+		if (record == nullptr) return;
+		record->stages[(int)stage].waitTicks.fetch_add(armGetSystemTick() - startTick, std::memory_order_relaxed);
+	}
+
+	void BeginReport(const std::string& source, NcmStorageId destStorageId) {
+		BeginReport(source, destStorageId == NcmStorageId_BuiltInUser ? "nand" : "sd");
+	}
+
+	void BeginReport(const std::string& source, const std::string& destination) {
+		std::lock_guard<std::mutex> lock(reportMutex);
+		records.clear();
+		reportActive = true;
+		reportSource = source;
+		reportDestination = destination;
+		reportStartTick = armGetSystemTick();
+	}
+
+	void EndReport(bool success, const std::string& error) {
+		std::lock_guard<std::mutex> lock(reportMutex);
+		if (!reportActive) return;
+		reportActive = false;
+		current = nullptr;
+
+		u64 totals[(int)Stage::Count][3] = {};
+		nlohmann::json ncas = nlohmann::json::array();
+		for (auto& record : records) {
+			nlohmann::json stages = nlohmann::json::object();
+			for (int i = 0; i < (int)Stage::Count; i++) {
+				u64 bytes = record.stages[i].bytes;
+				u64 busy = record.stages[i].busyTicks;
+				u64 wait = record.stages[i].waitTicks;
+				totals[i][0] += bytes;
+				totals[i][1] += busy;
+				totals[i][2] += wait;
+				if (bytes || busy || wait) stages[stageNames[i]] = stageJson(bytes, busy, wait);
+			}
+			u64 endTick = record.endTick ? record.endTick : armGetSystemTick();
+			ncas.push_back({
+				{"name", record.name},
+				{"size", record.size},
+				{"ms", ticksToMs(endTick - record.startTick)},
+				{"stages", stages}
+			});
+		}
+
+		nlohmann::json stageTotals = nlohmann::json::object();
+		for (int i = 0; i < (int)Stage::Count; i++) {
+			if (totals[i][0] || totals[i][1] || totals[i][2]) stageTotals[stageNames[i]] = stageJson(totals[i][0], totals[i][1], totals[i][2]);
+		}
+
+		nlohmann::json threads = nlohmann::json::array();
+		for (auto& thread : inst::threads::Layout()) {
+			threads.push_back({
+				{"name", thread.name},
+				{"role", thread.role},
+				{"core", thread.core},
+				{"core_mask", thread.coreMask},
+				{"priority", thread.priority},
+				{"applied", thread.applied}
+			});
+		}
+
+		u32 firmware = hosversionGet();
+		nlohmann::json report = {
+			{"version", inst::config::appVersion},
+			{"firmware", std::to_string(HOSVER_MAJOR(firmware)) + "." + std::to_string(HOSVER_MINOR(firmware)) + "." + std::to_string(HOSVER_MICRO(firmware))},
+			{"source", reportSource},
+			{"destination", reportDestination},
+			{"success", success},
+			{"error", error},
+			{"ms", ticksToMs(armGetSystemTick() - reportStartTick)},
+			{"stages", stageTotals},
+			{"ncas", ncas},
+			{"threads", threads}
+		};
+		records.clear();
+
+		std::ofstream file(inst::config::appDir + "/install_report.json");
+		file << std::setw(4) << report << std::endl;
+		if (!file) LOG_DEBUG("Failed to write install report\n");
+	}
+
+	NcaScope::NcaScope(const std::string& name, u64 size) {
+		std::lock_guard<std::mutex> lock(reportMutex);
+		if (!reportActive) return;
+		NcaRecord& record = records.emplace_back();
+		record.name = name;
+		record.size = size;
+		record.startTick = armGetSystemTick();
+		threadRecord = &record;
+		current.store(&record, std::memory_order_release);
+	}
+
+	NcaScope::~NcaScope() {
+		std::lock_guard<std::mutex> lock(reportMutex);
+		NcaRecord* record = threadRecord;
+		threadRecord = nullptr;
+		// The report may have ended, and its records gone, while the scope was open
+		if (record == nullptr || !reportActive) return;
+		NcaRecord* expected = record;
+		current.compare_exchange_strong(expected, nullptr);
+		record->endTick = armGetSystemTick();
+	}
+}
@@ -3,31 +3,73 @@
 #include <cstring>
 #include <sstream>
 #include <filesystem>
+#include <unordered_map>
 #include "util/theme.hpp"
 #include "util/config.hpp"
 
 namespace Theme {
 	json theme;
+	inst::util::StringTable themeTable("Json object: ", " does not exist!");
+	bool loaded = false;
+	std::unordered_map<std::string, std::string> assets;
+	std::unordered_map<std::string, pu::ui::Color> colours;
+
+	void ResolveAssets(const json& j, const std::string& prefix) {
+		for (auto& item : j.items()) {
+			std::string key = prefix.empty() ? item.key() : prefix + "." + item.key();
+			if (item.value().is_object()) ResolveAssets(item.value(), key);
+			else if (!item.value().is_string()) continue;
+			else if (key.rfind("colour.", 0) == 0) colours[key] = pu::ui::Color::FromHex(item.value().get<std::string>());
+			else {
+				std::string path = inst::config::appDir + item.value().get<std::string>();
+				if (std::filesystem::exists(path)) assets[key] = path;
+			}
+		}
+	}
 
 	void Load() {
+		loaded = false;
+		assets.clear();
+		colours.clear();
 		std::ifstream ifs2;
 		std::string ThemePath = inst::config::appDir + "/theme/theme.json";
 		if (std::filesystem::exists(ThemePath)) {
 			ifs2 = std::ifstream(ThemePath);
 			theme = json::parse(ifs2);
 			ifs2.close();
+			themeTable.Build(theme);
+			ResolveAssets(theme, "");
+			loaded = true;
 		}
 		else {
+			theme = json();
+			themeTable.Build(theme);
 			std::cout << "[FAILED TO LOAD Theme FILE]" << std::endl;
 			return;
 		}
 	}
 
-	std::string ThemeEntry(std::string key) {
-		json j = GetRelativeJson(theme, key);
-		if (j == nullptr) {
-			return "Json object: " + key + " does not exist!";
-		}
-		return j.get<std::string>();
+	bool Enabled() {
+		return loaded && inst::config::useTheme;
+	}
+
+	bool HasAsset(const std::string& key) {
+		return Enabled() && assets.count(key);
+	}
+
+	std::string Asset(const std::string& key, const std::string& fallback) {
+		auto it = assets.find(key);
+		if (!Enabled() || it == assets.end()) return fallback;
+		return it->second;
+	}
+
+	pu::ui::Color Colour(const std::string& key, const std::string& fallbackHex) {
+		auto it = colours.find(key);
+		if (!Enabled() || it == colours.end()) return pu::ui::Color::FromHex(fallbackHex);
+		return it->second;
+	}
+
+	const std::string& ThemeEntry(u64 hash, std::string_view key) {
+		return themeTable.Get(hash, key);
 	}
 }
\ No newline at end of file
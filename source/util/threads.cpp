@@ -0,0 +1,75 @@
+#include <map>
+#include <mutex>
+#include "util/threads.hpp"
+#include "util/error.hpp"
+
+namespace inst::threads {
+	namespace {
+		struct RoleLayout {
+			const char* name;
+			s32 core;
+			u32 coreMask;
+			u32 priority; // lower runs first, the main thread starts at 0x2C
+		};
+
+		const RoleLayout roleLayouts[(int)Role::Count] = {
+			{ "ui",         0, 0b001, 0x2C },
+			{ "receive",    1, 0b010, 0x2B },
+			{ "write",      2, 0b100, 0x2B },
+			{ "install",    1, 0b110, 0x2C },
+			{ "background", 2, 0b110, 0x30 },
+			{ "audio",      0, 0b111, 0x2D },
+		};
+
+		std::mutex layoutMutex;
+		// Keyed by name so a thread that is started for every NCA shows up once
+		std::map<std::string, ThreadInfo> layout;
+
+		u64 processInfo(u32 infoType) {
+			u64 value = 0;
+			if (R_FAILED(svcGetInfo(&value, infoType, CUR_PROCESS_HANDLE, 0))) return 0;
+			return value;
+		}
+	}
+
+	void Enter(const std::string& name, Role role) {
+		const RoleLayout& roleLayout = roleLayouts[(int)role];
+		ThreadInfo info;
+		info.name = name;
+		info.role = roleLayout.name;
+
+		bool applied = true;
+		u32 coreMask = roleLayout.coreMask & (u32)processInfo(InfoType_CoreMask);
+		if (coreMask) {
+			s32 core = roleLayout.core;
+			if (!(coreMask & (1 << core))) core = __builtin_ctz(coreMask);
+			if (R_SUCCEEDED(svcSetThreadCoreMask(CUR_THREAD_HANDLE, core, coreMask))) {
+				info.core = core;
+				info.coreMask = coreMask;
+			}
+			else applied = false;
+		}
+		else applied = false;
+
+		u32 priority = roleLayout.priority;
+		u64 priorityMask = processInfo(InfoType_PriorityMask);
+		if ((priorityMask >> priority) & 1) {
+			if (R_SUCCEEDED(svcSetThreadPriority(CUR_THREAD_HANDLE, priority))) info.priority = priority;
+			else applied = false;
+		}
+		else applied = false;
+
+		info.applied = applied;
+		if (!applied) LOG_DEBUG("Thread %s only partly moved to its %s layout\n", name.c_str(), roleLayout.name);
+
+		std::lock_guard<std::mutex> lock(layoutMutex);
+		layout[name] = info;
+	}
+
+	std::vector<ThreadInfo> Layout() {
+		std::lock_guard<std::mutex> lock(layoutMutex);
+		std::vector<ThreadInfo> threads;
+		for (auto& [name, info] : layout) threads.push_back(info);
+		return threads;
+	}
+}
@@ -1,12 +1,27 @@
 #include <minizip/unzip.h>
+#include <zlib.h>
 #include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
 #include <dirent.h>
+#include <filesystem>
+#include <functional>
+#include <mutex>
 #include <string>
 #include <cstring>
+#include <thread>
+#include <unordered_set>
+#include <vector>
 #include <switch.h>
 #include <sys/stat.h>
 #include <unistd.h>
 #include <stdio.h>
+#include "util/config.hpp"
+#include "util/curl.hpp"
+#include "util/error.hpp"
+#include "util/threads.hpp"
+#include "util/unzip.hpp"
 
 // https://github.com/AtlasNX/Kosmos-Updater/blob/master/source/FileManager.cpp
 
@@ -60,104 +75,579 @@ bool _makeDirectoryParents(std::string path)
 	return bSuccess;
 }
 
-int _extractFile(const char* path, unzFile unz, unz_file_info_s* fileInfo) {
-	//check to make sure filepath or fileInfo isnt null
-	if (path == NULL || fileInfo == NULL)
+// Decompression and SD card writes run on separate threads. The extracting thread fills buffers taken
+// from a small pool and queues them, the writer thread owns every open file and the directory cache.
+class ExtractWriter {
+public:
+	static const size_t bufferSize = 0x80000;
+
+	ExtractWriter(const std::string& destination) : destination(destination) {
+		for (int i = 0; i < bufferCount; i++) {
+			u8* buffer = (u8*)malloc(bufferSize);
+			if (buffer == NULL) break;
+			this->buffers.push_back(buffer);
+			this->freeBuffers.push_back(buffer);
+		}
+		this->failed = this->buffers.empty();
+		this->thread = std::thread(&ExtractWriter::run, this);
+	}
+
+	~ExtractWriter() {
+		this->Finish();
+		for (u8* buffer : this->buffers) free(buffer);
+	}
+
+	// Blocks until the writer thread hands a buffer back, NULL if none could be allocated
+	u8* AcquireBuffer() {
+		std::unique_lock<std::mutex> lock(this->mutex);
+		this->bufferReady.wait(lock, [this]() { return !this->freeBuffers.empty() || this->buffers.empty(); });
+		if (this->freeBuffers.empty()) return NULL;
+		u8* buffer = this->freeBuffers.back();
+		this->freeBuffers.pop_back();
+		return buffer;
+	}
+
+	void Open(const std::string& path) {
+		this->push({ JobType::Open, path, NULL, 0 });
+	}
+
+	// The buffer goes back to the pool once it has been written, size 0 just returns it
+	void Write(u8* buffer, size_t size) {
+		this->push({ JobType::Write, "", buffer, size });
+	}
+
+	void Close() {
+		this->push({ JobType::Close, "", NULL, 0 });
+	}
+
+	bool Failed() const {
+		return this->failed;
+	}
+
+	// Waits for the queued writes, then commits the destination device once for the whole archive
+	// instead of syncing every file
+	bool Finish() {
+		if (this->thread.joinable()) {
+			this->push({ JobType::Stop, "", NULL, 0 });
+			this->thread.join();
+			size_t pos = this->destination.find(':');
+			if (pos != std::string::npos) fsdevCommitDevice(this->destination.substr(0, pos).c_str());
+		}
+		return !this->failed;
+	}
+
+private:
+	enum class JobType {
+		Open,
+		Write,
+		Close,
+		Stop
+	};
+
+	struct Job {
+		JobType type;
+		std::string path;
+		u8* buffer;
+		size_t size;
+	};
+
+	static const int bufferCount = 4;
+
+	std::string destination;
+	std::vector<u8*> buffers;
+	std::vector<u8*> freeBuffers;
+	std::deque<Job> jobs;
+	std::mutex mutex;
+	std::condition_variable bufferReady;
+	std::condition_variable jobReady;
+	std::thread thread;
+	std::atomic<bool> failed = false;
+	// Only touched by the writer thread
+	std::unordered_set<std::string> createdDirs;
+
+	void push(Job job) {
+		{
+			std::lock_guard<std::mutex> lock(this->mutex);
+			this->jobs.push_back(std::move(job));
+		}
+		this->jobReady.notify_one();
+	}
+
+	void makeParents(const std::string& path) {
+		size_t pos = path.find_last_of('/');
+		if (pos == std::string::npos) return;
+		std::string dir = path.substr(0, pos);
+		if (this->createdDirs.count(dir)) return;
+		_makeDirectoryParents(dir);
+		// Every ancestor exists now as well
+		while (this->createdDirs.insert(dir).second) {
+			pos = dir.find_last_of('/');
+			if (pos == std::string::npos) break;
+			dir = dir.substr(0, pos);
+		}
+	}
+
+	void run() {
+		inst::threads::Enter("extract", inst::threads::Role::Background);
+		FILE* fp = NULL;
+		for (;;) {
+			Job job;
+			{
+				std::unique_lock<std::mutex> lock(this->mutex);
+				this->jobReady.wait(lock, [this]() { return !this->jobs.empty(); });
+				job = std::move(this->jobs.front());
+				this->jobs.pop_front();
+			}
+
+			switch (job.type) {
+			case JobType::Open:
+				this->makeParents(job.path);
+				fp = fopen(job.path.c_str(), "wb");
+				if (fp == NULL) this->failed = true;
+				// Buffers are already large, don't copy them through stdio as well
+				else setvbuf(fp, NULL, _IONBF, 0);
+				break;
+			case JobType::Write:
+				if (fp != NULL && !this->failed && fwrite(job.buffer, 1, job.size, fp) != job.size) this->failed = true;
+				{
+					std::lock_guard<std::mutex> lock(this->mutex);
+					this->freeBuffers.push_back(job.buffer);
+				}
+				this->bufferReady.notify_one();
+				break;
+			case JobType::Close:
+			case JobType::Stop:
+				if (fp != NULL) fclose(fp);
+				fp = NULL;
+				if (job.type == JobType::Stop) return;
+				break;
+			}
+		}
+	}
+};
+
+int _extractFile(const char* path, unzFile unz, ExtractWriter& writer) {
+	//check to make sure filepath isnt null
+	if (path == NULL)
 		return -1;
 
 	if (unzOpenCurrentFile(unz) != UNZ_OK)
 		return -2;
 
-	char folderPath[strlen(path) + 1];
-	strcpy(folderPath, path);
-	char* pos = strrchr(folderPath, '/');
-	if (pos != NULL) {
-		*pos = '\0';
-		_makeDirectoryParents(std::string(folderPath));
-	}
-
-	u32 blocksize = 0x8000;
-	u8* buffer = (u8*)malloc(blocksize);
-	if (buffer == NULL)
-		return -3;
-	u32 done = 0;
-	int writeBytes = 0;
-	FILE* fp = fopen(path, "w");
-	if (fp == NULL) {
-		free(buffer);
-		return -4;
-	}
-
-	while (done < fileInfo->uncompressed_size) {
-		if (done + blocksize > fileInfo->uncompressed_size) {
-			blocksize = fileInfo->uncompressed_size - done;
+	writer.Open(path);
+	int result = 0;
+	for (;;) {
+		u8* buffer = writer.AcquireBuffer();
+		if (buffer == NULL) {
+			result = -3;
+			break;
 		}
-		unzReadCurrentFile(unz, buffer, blocksize);
-		writeBytes = write(fileno(fp), buffer, blocksize);
-		if (writeBytes <= 0) {
+		// Fill the whole buffer so minizip's small reads don't turn into small SD card writes
+		size_t fill = 0;
+		int readBytes = 0;
+		while (fill < ExtractWriter::bufferSize && (readBytes = unzReadCurrentFile(unz, buffer + fill, ExtractWriter::bufferSize - fill)) > 0) fill += readBytes;
+		writer.Write(buffer, fill);
+		if (readBytes < 0) {
+			result = -4;
 			break;
 		}
-		done += writeBytes;
+		if (fill < ExtractWriter::bufferSize) break;
 	}
+	writer.Close();
 
-	fflush(fp);
-	fsync(fileno(fp));
-	fclose(fp);
-
-	free(buffer);
-	if (done != fileInfo->uncompressed_size)
+	if (unzCloseCurrentFile(unz) != UNZ_OK && result == 0)
+		result = -4;
+	if (writer.Failed())
 		return -4;
-
-	unzCloseCurrentFile(unz);
-	return 0;
+	return result;
 }
 
-namespace inst::zip {
-	bool extractFile(const std::string filename, const std::string destination) {
-		unzFile unz = unzOpen(filename.c_str());
+// Streaming extraction: walks the local file headers in the order the bytes arrive, the central directory
+// at the end of the archive is never needed. https://pkware.cachefly.net/webdocs/casestudies/APPNOTE.TXT
+class ZipStreamExtractor {
+public:
+	ZipStreamExtractor(const std::string& destination) : destination(destination), writer(destination) {
+		this->failed = this->writer.Failed();
+	}
 
-		int i = 0;
-		for (;;) {
-			int code;
-			if (i == 0) {
-				code = unzGoToFirstFile(unz);
+	~ZipStreamExtractor() {
+		if (this->inflating) inflateEnd(&this->stream);
+	}
+
+	// Returns false when the transfer should be aborted
+	bool Feed(const u8* data, size_t size) {
+		while (size > 0 && !this->failed && this->state != State::Done) {
+			switch (this->state) {
+			case State::Header:
+				if (!this->need(4, data, size)) return true;
+				if (this->read32(0) == centralHeaderMagic || this->read32(0) == endOfCentralMagic) {
+					this->state = State::Done;
+					break;
+				}
+				if (this->read32(0) != localHeaderMagic) return this->fail(false);
+				if (!this->need(localHeaderSize, data, size)) return true;
+				if (!this->need(localHeaderSize + this->read16(26) + this->read16(28), data, size)) return true;
+				if (!this->beginEntry()) return false;
+				break;
+			case State::Data:
+				if (!this->readData(data, size)) return false;
+				break;
+			case State::Descriptor: {
+				if (!this->need(4, data, size)) return true;
+				size_t base = (this->read32(0) == dataDescriptorMagic) ? 4 : 0;
+				if (!this->need(base + (this->zip64 ? 20 : 12), data, size)) return true;
+				this->expectedCrc = this->read32(base);
+				if (!this->endEntry()) return false;
+				break;
 			}
-			else {
-				code = unzGoToNextFile(unz);
+			case State::Done:
+				break;
 			}
-			i++;
+		}
+		return !this->failed;
+	}
 
-			if (code == UNZ_END_OF_LIST_OF_FILE) {
-				break;
+	// Waits for the last writes, true if the whole archive made it to the SD card
+	bool Finish() {
+		if (!this->writer.Finish()) this->failed = true;
+		return !this->failed && this->state == State::Done && this->entries > 0;
+	}
+
+	bool Failed() const {
+		return this->failed;
+	}
+
+	// Encrypted entries and stored entries without sizes in their local header can't be streamed
+	bool Unsupported() const {
+		return this->unsupported;
+	}
+
+private:
+	enum class State {
+		Header,
+		Data,
+		Descriptor,
+		Done
+	};
+
+	static const u32 localHeaderMagic = 0x04034b50;
+	static const u32 centralHeaderMagic = 0x02014b50;
+	static const u32 endOfCentralMagic = 0x06054b50;
+	static const u32 dataDescriptorMagic = 0x08074b50;
+	static const size_t localHeaderSize = 30;
+
+	std::string destination;
+	ExtractWriter writer;
+	State state = State::Header;
+	std::vector<u8> pending;
+	u8* buffer = NULL;
+	size_t fill = 0;
+	z_stream stream = {};
+	bool inflating = false;
+	bool failed = false;
+	bool unsupported = false;
+	u32 entries = 0;
+
+	// Current entry
+	std::string path;
+	bool hasFile = false;
+	u16 flags = 0;
+	u16 method = 0;
+	bool zip64 = false;
+	u32 expectedCrc = 0;
+	u32 crc = 0;
+	u64 compressedLeft = 0;
+	u64 uncompressedSize = 0;
+	u64 written = 0;
+
+	bool fail(bool isUnsupported) {
+		this->failed = true;
+		this->unsupported = isUnsupported;
+		return false;
+	}
+
+	// Collects header bytes across chunk boundaries until pending holds count bytes
+	bool need(size_t count, const u8*& data, size_t& size) {
+		if (this->pending.size() >= count) return true;
+		size_t take = std::min(count - this->pending.size(), size);
+		this->pending.insert(this->pending.end(), data, data + take);
+		data += take;
+		size -= take;
+		return this->pending.size() >= count;
+	}
+
+	u16 read16(size_t offset) const {
+		return this->pending[offset] | (this->pending[offset + 1] << 8);
+	}
+
+	u32 read32(size_t offset) const {
+		return this->read16(offset) | ((u32)this->read16(offset + 2) << 16);
+	}
+
+	u64 read64(size_t offset) const {
+		return this->read32(offset) | ((u64)this->read32(offset + 4) << 32);
+	}
+
+	bool beginEntry() {
+		this->flags = this->read16(6);
+		this->method = this->read16(8);
+		this->expectedCrc = this->read32(14);
+		this->compressedLeft = this->read32(18);
+		this->uncompressedSize = this->read32(22);
+		u16 nameLen = this->read16(26);
+		u16 extraLen = this->read16(28);
+		std::string name((const char*)this->pending.data() + localHeaderSize, nameLen);
+
+		// Zip64 extended information, the 64 bit sizes replace the saturated 32 bit ones
+		this->zip64 = false;
+		size_t extra = localHeaderSize + nameLen;
+		size_t extraEnd = extra + extraLen;
+		while (extra + 4 <= extraEnd) {
+			u16 id = this->read16(extra);
+			u16 len = this->read16(extra + 2);
+			if (extra + 4 + len > extraEnd) break;
+			if (id == 0x0001) {
+				size_t field = extra + 4;
+				this->zip64 = true;
+				if (this->uncompressedSize == 0xFFFFFFFF && field + 8 <= extra + 4 + len) {
+					this->uncompressedSize = this->read64(field);
+					field += 8;
+				}
+				if (this->compressedLeft == 0xFFFFFFFF && field + 8 <= extra + 4 + len) this->compressedLeft = this->read64(field);
 			}
-			else {
-				unz_file_pos pos;
-				unzGetFilePos(unz, &pos);
+			extra += 4 + len;
+		}
+		this->pending.clear();
+		this->entries++;
+
+		if (this->flags & 1) return this->fail(true);
+		if (this->method != 0 && this->method != 8) return this->fail(true);
+		if ((this->flags & 8) && this->method == 0) return this->fail(true);
+
+		this->path = this->destination + name;
+		this->crc = crc32(0, Z_NULL, 0);
+		this->written = 0;
+		this->hasFile = (this->path.back() != '/');
+		if (this->hasFile) this->writer.Open(this->path);
+
+		if (this->method == 8) {
+			this->stream = {};
+			if (inflateInit2(&this->stream, -MAX_WBITS) != Z_OK) return this->fail(false);
+			this->inflating = true;
+		}
+		this->state = State::Data;
+		if (this->method == 0 && this->compressedLeft == 0) return this->endEntry();
+		return true;
+	}
+
+	bool reserve() {
+		if (this->writer.Failed()) return this->fail(false);
+		if (this->buffer == NULL) {
+			this->buffer = this->writer.AcquireBuffer();
+			this->fill = 0;
+			if (this->buffer == NULL) return this->fail(false);
+		}
+		return true;
+	}
+
+	void flush() {
+		if (this->buffer == NULL) return;
+		this->writer.Write(this->buffer, this->hasFile ? this->fill : 0);
+		this->buffer = NULL;
+		this->fill = 0;
+	}
+
+	bool writeOut(const u8* data, size_t size) {
+		this->crc = crc32(this->crc, data, size);
+		this->written += size;
+		while (size > 0) {
+			if (!this->reserve()) return false;
+			size_t take = std::min(size, ExtractWriter::bufferSize - this->fill);
+			memcpy(this->buffer + this->fill, data, take);
+			this->fill += take;
+			data += take;
+			size -= take;
+			if (this->fill == ExtractWriter::bufferSize) this->flush();
+		}
+		return true;
+	}
+
+	bool readData(const u8*& data, size_t& size) {
+		bool sized = !(this->flags & 8);
+		size_t take = sized ? (size_t)std::min<u64>(this->compressedLeft, size) : size;
+
+		if (this->method == 0) {
+			if (!this->writeOut(data, take)) return false;
+			data += take;
+			size -= take;
+			this->compressedLeft -= take;
+			if (this->compressedLeft == 0) return this->endEntry();
+			return true;
+		}
+
+		this->stream.next_in = (Bytef*)data;
+		this->stream.avail_in = take;
+		int ret = Z_OK;
+		while (ret != Z_STREAM_END) {
+			// Inflate straight into the writer's buffer
+			if (!this->reserve()) return false;
+			size_t space = ExtractWriter::bufferSize - this->fill;
+			this->stream.next_out = this->buffer + this->fill;
+			this->stream.avail_out = space;
+			ret = inflate(&this->stream, Z_NO_FLUSH);
+			if (ret != Z_OK && ret != Z_STREAM_END && ret != Z_BUF_ERROR) return this->fail(false);
+			size_t produced = space - this->stream.avail_out;
+			this->crc = crc32(this->crc, this->buffer + this->fill, produced);
+			this->written += produced;
+			this->fill += produced;
+			if (this->fill == ExtractWriter::bufferSize) this->flush();
+			else if (ret != Z_STREAM_END) break;
+		}
+
+		size_t used = take - this->stream.avail_in;
+		data += used;
+		size -= used;
+		if (sized) this->compressedLeft -= used;
+
+		if (ret == Z_STREAM_END) {
+			inflateEnd(&this->stream);
+			this->inflating = false;
+			if (this->flags & 8) {
+				this->state = State::Descriptor;
+				return true;
 			}
+			// Skip whatever the deflater left between the end of the stream and the next header
+			size_t skip = (size_t)std::min<u64>(this->compressedLeft, size);
+			data += skip;
+			size -= skip;
+			this->compressedLeft -= skip;
+			if (this->compressedLeft == 0) return this->endEntry();
+			return true;
+		}
+		if (sized && this->compressedLeft == 0) return this->fail(false);
+		return true;
+	}
 
+	bool endEntry() {
+		this->pending.clear();
+		this->flush();
+		if (this->hasFile) this->writer.Close();
+		if (this->writer.Failed()) return this->fail(false);
+		if (this->crc != this->expectedCrc || (!(this->flags & 8) && this->written != this->uncompressedSize)) {
+			LOG_DEBUG("Corrupt zip entry %s\n", this->path.c_str());
+			return this->fail(false);
+		}
+		this->state = State::Header;
+		return true;
+	}
+};
+
+// Moves every staged file over its final path. Both live on the same device, so this is a rename per
+// file and never a copy.
+bool _commitStaged(const std::string& staging, const std::string& destination) {
+	std::error_code ec;
+	std::vector<std::string> files;
+	for (auto it = std::filesystem::recursive_directory_iterator(staging, ec); !ec && it != std::filesystem::recursive_directory_iterator(); it.increment(ec)) {
+		if (it->is_regular_file(ec)) files.push_back(it->path().string());
+	}
+	if (ec) return false;
+
+	for (auto& file : files) {
+		std::string target = destination + file.substr(staging.size());
+		_makeDirectoryParents(target.substr(0, target.find_last_of('/')));
+		// FS won't rename over an existing file
+		std::filesystem::remove(target, ec);
+		if (rename(file.c_str(), target.c_str()) != 0) {
+			LOG_DEBUG("Failed to move %s into place\n", target.c_str());
+			return false;
+		}
+	}
+	return true;
+}
+
+namespace inst::zip {
+	bool extractFile(const std::string filename, const std::string destination) {
+		unzFile unz = unzOpen(filename.c_str());
+		if (unz == NULL) return false;
+
+		ExtractWriter writer(destination);
+		bool success = true;
+		int code;
+		for (code = unzGoToFirstFile(unz); code == UNZ_OK; code = unzGoToNextFile(unz)) {
 			unz_file_info_s* fileInfo = _getFileInfo(unz);
 
 			std::string fileName = destination;
 			fileName += _getFullFileName(unz, fileInfo);
+			free(fileInfo);
 
-			if (fileName.back() != '/') {
-				int result = _extractFile(fileName.c_str(), unz, fileInfo);
-				if (result < 0) {
-					free(fileInfo);
-					unzClose(unz);
-					return false;
-				}
+			if (fileName.back() != '/' && _extractFile(fileName.c_str(), unz, writer) < 0) {
+				success = false;
+				break;
 			}
+		}
+		if (code != UNZ_OK && code != UNZ_END_OF_LIST_OF_FILE) success = false;
+		if (!writer.Finish()) success = false;
 
-			free(fileInfo);
+		unzClose(unz);
+		return success;
+	}
+
+	// Downloads and verifies the whole archive into staging, destination is not touched yet
+	static StreamResult streamToStaging(const std::string& url, const std::string& staging, long timeout, bool writeProgress) {
+		bool didDownload;
+		bool unsupported;
+		bool finished;
+		{
+			ZipStreamExtractor extractor(staging);
+			bool threw = false;
+			didDownload = inst::curl::downloadToCallback(url, [&](const void* data, size_t size) {
+				// Exceptions must not unwind through curl
+				try {
+					return extractor.Feed((const u8*)data, size);
+				}
+				catch (...) {
+					threw = true;
+					return false;
+				}
+			}, timeout, writeProgress);
+			finished = extractor.Finish();
+			if (threw || (extractor.Failed() && !extractor.Unsupported())) return StreamResult::ExtractFailed;
+			unsupported = extractor.Unsupported();
 		}
 
-		if (i <= 0) {
-			unzClose(unz);
-			return false;
+		if (unsupported) {
+			// Fall back to the old download-then-extract path, starting over from an empty staging directory
+			LOG_DEBUG("Zip can't be streamed, downloading it first\n");
+			std::error_code ec;
+			std::filesystem::remove_all(staging, ec);
+			std::string tempPath = inst::config::appDir + "/temp_stream.zip";
+			if (!inst::curl::downloadFile(url, tempPath.c_str(), timeout, writeProgress)) {
+				std::filesystem::remove(tempPath);
+				return StreamResult::DownloadFailed;
+			}
+			bool didExtract = extractFile(tempPath, staging);
+			std::filesystem::remove(tempPath);
+			return didExtract ? StreamResult::Ok : StreamResult::ExtractFailed;
 		}
 
-		unzClose(unz);
-		return true;
+		if (!didDownload) return StreamResult::DownloadFailed;
+		if (!finished) return StreamResult::ExtractFailed;
+		return StreamResult::Ok;
+	}
+
+	StreamResult extractFromUrl(const std::string url, const std::string destination, long timeout, bool writeProgress, std::function<void()> beforeCommit) {
+		std::string staging = inst::config::appDir + "/extract_staging/";
+		std::error_code ec;
+		std::filesystem::remove_all(staging, ec);
+		StreamResult result = streamToStaging(url, staging, timeout, writeProgress);
+
+		if (result == StreamResult::Ok) {
+			if (beforeCommit) beforeCommit();
+			if (!_commitStaged(staging, destination)) result = StreamResult::ExtractFailed;
+		}
+		std::filesystem::remove_all(staging, ec);
+		size_t pos = destination.find(':');
+		if (pos != std::string::npos) fsdevCommitDevice(destination.substr(0, pos).c_str());
+		return result;
 	}
 }
\ No newline at end of file
@@ -12,11 +12,14 @@
 #include "switch.h"
 #include "util/util.hpp"
 #include "nx/ipc/tin_ipc.h"
+#include "nx/ncm.hpp"
 #include "util/config.hpp"
 #include "util/curl.hpp"
 #include "ui/MainApplication.hpp"
 #include "util/usb_comms_tinleaf.h"
 #include "util/json.hpp"
+#include "util/placeholder_gc.hpp"
+#include "util/threads.hpp"
 #include "nx/usbhdd.h"
 
 // Include sdl2 headers
@@ -25,10 +28,15 @@
 Mix_Music* music = NULL;
 
 namespace inst::util {
+	namespace {
+		bool installServicesUp = false;
+	}
+
 	void initApp() {
 		if (!std::filesystem::exists("sdmc:/switch")) std::filesystem::create_directory("sdmc:/switch");
 		if (!std::filesystem::exists(inst::config::appDir)) std::filesystem::create_directory(inst::config::appDir);
 		inst::config::parseConfig();
+		inst::threads::Enter("ui", inst::threads::Role::Ui);
 
 		socketInitializeDefault();
 #ifdef __DEBUG__
@@ -37,15 +45,32 @@ namespace inst::util {
 		tinleaf_usbCommsInitialize();
 
 		nx::hdd::init();
+
+		// Reclaim space from installs that failed last time without holding up the UI
+		inst::placeholder_gc::StartBackgroundCollect();
 	}
 
 	void deinitApp() {
+		inst::placeholder_gc::WaitForBackgroundCollect();
+		if (installServicesUp) {
+			nx::ncm::CloseSessions();
+			ncmExit();
+			nsExit();
+			nsextExit();
+			esExit();
+			splCryptoExit();
+			splExit();
+		}
 		nx::hdd::exit();
 		socketExit();
 		tinleaf_usbCommsExit();
 	}
 
 	void initInstallServices() {
+		inst::placeholder_gc::WaitForBackgroundCollect();
+		// The services stay up until the app exits, only the NCM sessions are per install
+		if (installServicesUp) return;
+		installServicesUp = true;
 		ncmInitialize();
 		nsInitialize();
 		nsextInitialize();
@@ -55,12 +80,7 @@ namespace inst::util {
 	}
 
 	void deinitInstallServices() {
-		ncmExit();
-		nsExit();
-		nsextExit();
-		esExit();
-		splCryptoExit();
-		splExit();
+		nx::ncm::CloseSessions();
 	}
 
 	auto caseInsensitiveLess = [](auto& x, auto& y)->bool {
@@ -197,20 +217,6 @@ namespace inst::util {
 		}
 	}
 	
-	bool themeit(std::string dir) {
-		bool themepath;
-		std::string root = dir;
-		std::filesystem::path path = root;
-		bool texists = std::filesystem::exists(path);
-		if (texists == true) {
-			themepath = true;
-		}
-		else {
-			themepath = false;
-		}
-		return themepath;
-	}
-
 	std::string formatUrlString(std::string ourString) {
 		std::stringstream ourStream(ourString);
 		std::string segment;
@@ -355,6 +361,7 @@ namespace inst::util {
 	}
 
 	void playAudio(std::string audioPath) {
+		inst::threads::Enter("audio", inst::threads::Role::Audio);
 		//check to make sure we aren't trying to play a wav file...
 		std::string wav("wav");
 		std::size_t found = audioPath.find(wav);